@@ -0,0 +1,112 @@
+// email: yaacovkrawiec@gmail.com
+
+#ifndef ADJACENCYLISTS_H
+#define ADJACENCYLISTS_H
+
+#include <iostream>
+#include <cstddef>
+#include "Allocator.hpp"
+#include "Types.hpp"
+
+namespace graph {
+
+    // Represents one edge in the adjacency list
+    struct Edge {
+        VertexId destination;
+        Weight weight;
+    };
+
+    // Walks a contiguous run of Edge records (used by the algorithms to scan neighbors)
+    class EdgeIterator {
+    private:
+        const Edge* current;
+        const Edge* end;
+    public:
+        EdgeIterator(const Edge* begin, const Edge* end_) : current(begin), end(end_) {}
+        bool done() const { return current == end; }
+        void next() { ++current; }
+        VertexId destination() const { return current->destination; }
+        Weight weight() const { return current->weight; }
+    };
+
+    // Per-vertex edge arrays shared by Graph and DirectedGraph.
+    // adjacencyList[v] holds adjacencySizes[v] Edges in a block of adjacencyCapacities[v] entries
+    // taken from 'allocator'. A block can carry 'payloadBytes' more bytes per entry after its Edges
+    // (Graph keeps its twin indices there); they are copied and moved along with the entries.
+    class AdjacencyLists {
+    protected:
+        VertexId numVertices;         // number of vertices
+        VertexId vertexCapacity;      // allocated length of the three per-vertex arrays below
+        Edge** adjacencyList;         // adjacencyList[v] = dynamic array of Edges, followed by their payload
+        int* adjacencySizes;          // adjacencySizes[v] = current number of edges
+        int* adjacencyCapacities;     // adjacencyCapacities[v] = allocated capacity for adjacencyList[v]
+        BlockAllocator* allocator;    // owns the memory of every adjacencyList[v]
+        std::size_t payloadBytes;     // extra bytes per entry
+
+        // No vertices (the lists are added with growVertexArrays)
+        explicit AdjacencyLists(std::size_t entryPayloadBytes);
+
+        // 'numberOfVertices' empty lists (the object takes ownership of 'edgeAllocator')
+        AdjacencyLists(VertexId numberOfVertices, BlockAllocator* edgeAllocator, std::size_t entryPayloadBytes);
+
+        // Only the derived graphs are destroyed, copied and moved
+        ~AdjacencyLists();
+
+        // Copy constructor: every block is copied with its payload (no spare vertex capacity)
+        AdjacencyLists(const AdjacencyLists& other);
+        AdjacencyLists& operator=(const AdjacencyLists& other) = delete;
+
+        // Move constructor (the moved-from lists have 0 vertices)
+        AdjacencyLists(AdjacencyLists&& other) noexcept;
+
+        void swap(AdjacencyLists& other) noexcept;
+
+        // Bytes of a block with room for 'capacity' entries and their payload
+        std::size_t blockBytes(int capacity) const {
+            return static_cast<std::size_t>(capacity) * (sizeof(Edge) + payloadBytes);
+        }
+        unsigned char* payloadOf(VertexId vertex) const {
+            return reinterpret_cast<unsigned char*>(adjacencyList[vertex] + adjacencyCapacities[vertex]);
+        }
+
+        // Move the per-vertex arrays to a larger allocation (the edge blocks are not touched)
+        void growVertexArrays(VertexId newCapacity);
+
+        // Expand the adjacency array for a given vertex (when it's full)
+        void expandEdgeList(VertexId vertex);
+
+        // Move the adjacency array of 'vertex' into a new block of 'newCap' entries
+        // (entries keep their index, payload included)
+        void resizeEdgeList(VertexId vertex, int newCap);
+
+        bool isValidEdge(VertexId source, VertexId dest) const {
+            return isValidVertex(source, numVertices) && isValidVertex(dest, numVertices) && source != dest;
+        }
+
+        // addEdge checks: false (with a message) for a bad vertex or a loop, a warning for a negative weight
+        bool checkNewEdge(VertexId source, VertexId dest, Weight weight) const;
+
+        // Print every list as "Vertex v<separator>(dest, w=weight) ..."
+        void printLists(const char* title, const char* separator) const;
+
+    public:
+        // true if any edge weight is negative
+        bool hasNegativeWeight() const;
+
+        // Sum of all adjacency sizes
+        std::size_t getNumAdjEntries() const;
+
+        // Accessors
+        VertexId getNumVertices() const { return numVertices; }
+        Edge* getAdjList(VertexId vertex) const { return adjacencyList[vertex]; }
+        int getAdjSize(VertexId vertex) const { return adjacencySizes[vertex]; }
+
+        typedef EdgeIterator NeighborIterator;
+        NeighborIterator neighbors(VertexId vertex) const {
+            return NeighborIterator(adjacencyList[vertex], adjacencyList[vertex] + adjacencySizes[vertex]);
+        }
+    };
+
+} // namespace graph
+
+#endif
@@ -0,0 +1,284 @@
+// email: yaacovkrawiec@gmail.com
+
+#ifndef ALGORITHMRESULTS_H
+#define ALGORITHMRESULTS_H
+
+#include "Graph.hpp"
+#include "DirectedGraph.hpp"
+#include <cstddef>
+
+namespace graph {
+
+    // One undirected edge u-v of an edge list
+    struct WeightedEdge {
+        VertexId u;
+        VertexId v;
+        Weight w;
+    };
+
+    // Search tree of bfs / dfs as flat arrays: parent[v] and the weight of the edge parent[v] - v,
+    // and depth[v] (number of tree edges from the source; NO_VERTEX if v was not reached)
+    class BfsResult {
+    private:
+        VertexId numVertices;
+        VertexId source;
+        VertexId numReached;
+        VertexId* parent;
+        VertexId* depth;
+        Weight* parentWeight;
+
+    public:
+        // Only 'sourceVertex' is reached (depth 0)
+        BfsResult(VertexId numberOfVertices, VertexId sourceVertex);
+
+        // Takes over arrays filled elsewhere (MemoryPolicy arrays of 'numberOfVertices', as parallelBfs builds them)
+        BfsResult(VertexId numberOfVertices, VertexId sourceVertex, VertexId reachedCount,
+                  VertexId* parents, VertexId* depths, Weight* parentWeights);
+
+        // Destructor
+        ~BfsResult();
+
+        // Copy constructor / assignment operator
+        BfsResult(const BfsResult& other);
+        BfsResult& operator=(const BfsResult& other);
+
+        // Move constructor / move assignment (the moved-from result has 0 vertices)
+        BfsResult(BfsResult&& other) noexcept;
+        BfsResult& operator=(BfsResult&& other) noexcept;
+
+        void swap(BfsResult& other) noexcept;
+
+        // Record that 'vertex' was reached from 'from' over an edge of weight 'weight'
+        void reach(VertexId vertex, VertexId from, Weight weight) {
+            parent[vertex] = from;
+            depth[vertex] = depth[from] + 1;
+            parentWeight[vertex] = weight;
+            numReached++;
+        }
+
+        bool isReached(VertexId vertex) const { return depth[vertex] != NO_VERTEX; }
+
+        // The tree as a Graph (one addEdges call) / as a DirectedGraph of parent -> child edges
+        Graph toGraph() const;
+        DirectedGraph toDirectedGraph() const;
+
+        // Accessors
+        VertexId getNumVertices() const { return numVertices; }
+        VertexId getSource() const { return source; }
+        VertexId getNumReached() const { return numReached; }
+        VertexId getParent(VertexId vertex) const { return parent[vertex]; }
+        VertexId getDepth(VertexId vertex) const { return depth[vertex]; }
+        Weight getParentWeight(VertexId vertex) const { return parentWeight[vertex]; }
+        const VertexId* getParents() const { return parent; }
+        const VertexId* getDepths() const { return depth; }
+    };
+
+    // dfs fills the same arrays (depth is the depth in the DFS tree)
+    typedef BfsResult DfsResult;
+
+    // Shortest-path tree of dijkstra: dist[v] (infiniteDistance() if not reached), parent[v]
+    // and the weight of the edge parent[v] - v
+    class SsspResult {
+    private:
+        VertexId numVertices;
+        VertexId source;
+        Distance* dist;
+        VertexId* parent;
+        Weight* parentWeight;
+
+    public:
+        // Only 'sourceVertex' is reached (distance 0)
+        SsspResult(VertexId numberOfVertices, VertexId sourceVertex);
+
+        // Destructor
+        ~SsspResult();
+
+        // Copy constructor / assignment operator
+        SsspResult(const SsspResult& other);
+        SsspResult& operator=(const SsspResult& other);
+
+        // Move constructor / move assignment (the moved-from result has 0 vertices)
+        SsspResult(SsspResult&& other) noexcept;
+        SsspResult& operator=(SsspResult&& other) noexcept;
+
+        void swap(SsspResult& other) noexcept;
+
+        // Record a shorter path to 'vertex' whose last edge is from - vertex
+        void relax(VertexId vertex, Distance distance, VertexId from, Weight weight) {
+            dist[vertex] = distance;
+            parent[vertex] = from;
+            parentWeight[vertex] = weight;
+        }
+
+        bool isReached(VertexId vertex) const { return dist[vertex] != infiniteDistance(); }
+
+        // The tree as a Graph (one addEdges call) / as a DirectedGraph of parent -> child edges
+        Graph toGraph() const;
+        DirectedGraph toDirectedGraph() const;
+
+        // Accessors
+        VertexId getNumVertices() const { return numVertices; }
+        VertexId getSource() const { return source; }
+        Distance getDistance(VertexId vertex) const { return dist[vertex]; }
+        VertexId getParent(VertexId vertex) const { return parent[vertex]; }
+        Weight getParentWeight(VertexId vertex) const { return parentWeight[vertex]; }
+        const Distance* getDistances() const { return dist; }
+        const VertexId* getParents() const { return parent; }
+    };
+
+    // Minimum spanning tree (or forest) of prim / kruskal: its edges in the order they were
+    // chosen, and their total weight
+    class MstResult {
+    private:
+        VertexId numVertices;
+        WeightedEdge* edges;     // room for numVertices - 1 edges
+        std::size_t capacity;
+        std::size_t numEdges;
+        Distance totalWeight;
+
+    public:
+        explicit MstResult(VertexId numberOfVertices);
+
+        // Destructor
+        ~MstResult();
+
+        // Copy constructor / assignment operator
+        MstResult(const MstResult& other);
+        MstResult& operator=(const MstResult& other);
+
+        // Move constructor / move assignment (the moved-from result has 0 vertices)
+        MstResult(MstResult&& other) noexcept;
+        MstResult& operator=(MstResult&& other) noexcept;
+
+        void swap(MstResult& other) noexcept;
+
+        void addEdge(VertexId u, VertexId v, Weight w) {
+            edges[numEdges].u = u;
+            edges[numEdges].v = v;
+            edges[numEdges].w = w;
+            numEdges++;
+            totalWeight += w;
+        }
+
+        // true if the edges connect every vertex (false for a forest)
+        bool isSpanningTree() const { return numEdges + 1 >= static_cast<std::size_t>(numVertices); }
+
+        // The tree as a Graph (one addEdges call)
+        Graph toGraph() const;
+
+        // Accessors
+        VertexId getNumVertices() const { return numVertices; }
+        std::size_t getNumEdges() const { return numEdges; }
+        const WeightedEdge& getEdge(std::size_t index) const { return edges[index]; }
+        const WeightedEdge* getEdges() const { return edges; }
+        Distance getTotalWeight() const { return totalWeight; }
+    };
+
+    // Hop distances from a batch of sources (multiSourceBfs): getDepth(i, v) is the number of edges
+    // from the i-th source to v (NO_VERTEX if v was not reached); rows are stored source by source
+    class MultiSourceBfsResult {
+    private:
+        VertexId numVertices;
+        std::size_t numSources;
+        VertexId* sources;
+        VertexId* depth;         // numSources rows of numVertices
+        VertexId* numReached;
+        Distance* depthSum;      // sum of the depths of the reached vertices, per source
+
+    public:
+        // Only the sources themselves are reached (depth 0 in their own row)
+        MultiSourceBfsResult(VertexId numberOfVertices, const VertexId* sourceVertices, std::size_t sourceCount);
+
+        // Destructor
+        ~MultiSourceBfsResult();
+
+        // Copy constructor / assignment operator
+        MultiSourceBfsResult(const MultiSourceBfsResult& other);
+        MultiSourceBfsResult& operator=(const MultiSourceBfsResult& other);
+
+        // Move constructor / move assignment (the moved-from result has no sources)
+        MultiSourceBfsResult(MultiSourceBfsResult&& other) noexcept;
+        MultiSourceBfsResult& operator=(MultiSourceBfsResult&& other) noexcept;
+
+        void swap(MultiSourceBfsResult& other) noexcept;
+
+        // Record that the search from the index-th source reached 'vertex' after 'hops' edges
+        void reach(std::size_t index, VertexId vertex, VertexId hops) {
+            depth[index * numVertices + vertex] = hops;
+            numReached[index]++;
+            depthSum[index] += hops;
+        }
+
+        bool isReached(std::size_t index, VertexId vertex) const { return getDepth(index, vertex) != NO_VERTEX; }
+
+        // Accessors
+        VertexId getNumVertices() const { return numVertices; }
+        std::size_t getNumSources() const { return numSources; }
+        VertexId getSource(std::size_t index) const { return sources[index]; }
+        VertexId getDepth(std::size_t index, VertexId vertex) const { return depth[index * numVertices + vertex]; }
+        const VertexId* getDepths(std::size_t index) const { return depth + index * numVertices; }
+        VertexId getNumReached(std::size_t index) const { return numReached[index]; }
+        // Total hop distance to the reached vertices (closeness is (getNumReached - 1) / getDepthSum)
+        Distance getDepthSum(std::size_t index) const { return depthSum[index]; }
+    };
+
+    // Answer of a point-to-point query (bidirectionalBfs): the hop distance (NO_VERTEX if the target
+    // cannot be reached) and, when it was asked for, one shortest path from source to target
+    class HopPathResult {
+    private:
+        VertexId distance;
+        VertexId* path;          // distance + 1 vertices, or nullptr
+        std::size_t pathLength;
+
+    public:
+        // 'hops' edges apart; with 'withPath' room for the distance + 1 vertices of the path
+        explicit HopPathResult(VertexId hops = NO_VERTEX, bool withPath = false);
+
+        // Destructor
+        ~HopPathResult();
+
+        // Copy constructor / assignment operator
+        HopPathResult(const HopPathResult& other);
+        HopPathResult& operator=(const HopPathResult& other);
+
+        // Move constructor / move assignment (the moved-from result is not connected)
+        HopPathResult(HopPathResult&& other) noexcept;
+        HopPathResult& operator=(HopPathResult&& other) noexcept;
+
+        void swap(HopPathResult& other) noexcept;
+
+        void setPathVertex(std::size_t index, VertexId vertex) { path[index] = vertex; }
+
+        bool isConnected() const { return distance != NO_VERTEX; }
+        bool hasPath() const { return path != nullptr; }
+
+        // Accessors
+        VertexId getDistance() const { return distance; }
+        std::size_t getPathLength() const { return pathLength; }
+        VertexId getPathVertex(std::size_t index) const { return path[index]; }
+        const VertexId* getPath() const { return path; }
+    };
+
+    inline void swap(BfsResult& a, BfsResult& b) noexcept {
+        a.swap(b);
+    }
+
+    inline void swap(SsspResult& a, SsspResult& b) noexcept {
+        a.swap(b);
+    }
+
+    inline void swap(MstResult& a, MstResult& b) noexcept {
+        a.swap(b);
+    }
+
+    inline void swap(MultiSourceBfsResult& a, MultiSourceBfsResult& b) noexcept {
+        a.swap(b);
+    }
+
+    inline void swap(HopPathResult& a, HopPathResult& b) noexcept {
+        a.swap(b);
+    }
+
+} // namespace graph
+
+#endif
@@ -4,27 +4,185 @@
 #define ALGORITHMS_H
 
 #include "Graph.hpp"
+#include "CsrGraph.hpp"
+#include "SoaCsrGraph.hpp"
+#include "CompressedGraph.hpp"
+#include "DirectedGraph.hpp"
+#include "MappedGraph.hpp"
+#include "DeltaGraph.hpp"
+#include "DenseGraph.hpp"
+#include "ExternalGraph.hpp"
+#include "AlgorithmResults.hpp"
+#include "TraversalWorkspace.hpp"
 
 namespace graph {
 
+    // The graph types an overload family is declared for (the families are expanded from these
+    // lists here and in Algorithms.cpp). GRAPH_UNDIRECTED_TYPES take every algorithm;
+    // GRAPH_IN_MEMORY_TYPES add DirectedGraph for the searches that return flat arrays.
+    // ExternalGraph and the DirectedGraph tree forms are declared one by one.
+#define GRAPH_UNDIRECTED_TYPES(X) \
+    X(Graph) X(CsrGraph) X(SoaCsrGraph) X(CompressedGraph) X(MappedGraph) X(DeltaGraph) X(DenseGraph)
+#define GRAPH_IN_MEMORY_TYPES(X) GRAPH_UNDIRECTED_TYPES(X) X(DirectedGraph)
+
+#define GRAPH_DECLARE_BFS(G) \
+        static Graph bfs(const G& g, VertexId startVertex); \
+        static BfsResult bfsResult(const G& g, VertexId startVertex);
+#define GRAPH_DECLARE_BFS_IN_WORKSPACE(G) \
+        static VertexId bfs(const G& g, VertexId startVertex, TraversalWorkspace& workspace, VertexId target = NO_VERTEX);
+#define GRAPH_DECLARE_DIRECTION_OPTIMIZING_BFS(G) \
+        static BfsResult directionOptimizingBfs(const G& g, VertexId startVertex);
+#define GRAPH_DECLARE_PARALLEL_BFS(G) \
+        static BfsResult parallelBfs(const G& g, VertexId startVertex, bool deterministic = false, int numThreads = 0);
+#define GRAPH_DECLARE_MULTI_SOURCE_BFS(G) \
+        static MultiSourceBfsResult multiSourceBfs(const G& g, const VertexId* sources, std::size_t numSources);
+#define GRAPH_DECLARE_BIDIRECTIONAL_BFS(G) \
+        static HopPathResult bidirectionalBfs(const G& g, VertexId source, VertexId target, bool withPath = false); \
+        static HopPathResult bidirectionalBfs(const G& g, VertexId source, VertexId target, TraversalWorkspace& forward, \
+                                              TraversalWorkspace& backward, bool withPath = false);
+#define GRAPH_DECLARE_DFS(G) \
+        static Graph dfs(const G& g, VertexId startVertex); \
+        static DfsResult dfsResult(const G& g, VertexId startVertex);
+#define GRAPH_DECLARE_DFS_IN_WORKSPACE(G) \
+        static VertexId dfs(const G& g, VertexId startVertex, TraversalWorkspace& workspace, VertexId target = NO_VERTEX);
+#define GRAPH_DECLARE_DIJKSTRA(G) \
+        static Graph dijkstra(const G& g, VertexId startVertex); \
+        static SsspResult dijkstraResult(const G& g, VertexId startVertex);
+#define GRAPH_DECLARE_DIJKSTRA_IN_WORKSPACE(G) \
+        static VertexId dijkstra(const G& g, VertexId startVertex, TraversalWorkspace& workspace, VertexId target = NO_VERTEX);
+#define GRAPH_DECLARE_PRIM(G) \
+        static Graph prim(const G& g); \
+        static MstResult primResult(const G& g);
+#define GRAPH_DECLARE_KRUSKAL(G) \
+        static Graph kruskal(const G& g); \
+        static MstResult kruskalResult(const G& g);
+#define GRAPH_DECLARE_CONNECTED_COMPONENTS(G) \
+        static VertexId connectedComponents(const G& g, VertexId* component);
+
+    // Every algorithm accepts the mutable Graph and its read-only forms
+    // (CsrGraph / SoaCsrGraph snapshots, CompressedGraph, MappedGraph, DenseGraph) and the DeltaGraph
+    // overlay; the returned trees are regular Graphs.
+    // dijkstra and prim on a DenseGraph are the O(V^2) array scans; a Graph or CsrGraph that is
+    // dense enough and small enough (DenseGraph::shouldConvert) is converted per call and takes that
+    // path too. Larger dense graphs should be converted once by the caller and passed as a DenseGraph.
+    // bfs, dfs and dijkstra also accept a DirectedGraph (following out-edges) and return a directed tree.
+    // prim and kruskal are undirected-only: passing a DirectedGraph does not compile.
+    // An ExternalGraph (adjacency on disk) supports bfs, kruskal and connectedComponents, which
+    // stream the file sequentially; dfs, dijkstra and prim would read it at random and are deleted.
+    // Every algorithm also has a ...Result form returning flat arrays (BfsResult, SsspResult,
+    // MstResult) instead of a tree Graph; the tree forms are the same search followed by toGraph().
+    // bfs, dfs and dijkstra can also run in a caller's TraversalWorkspace: nothing is allocated or
+    // cleared per query, and with a 'target' the search stops as soon as the target is reached
+    // (bfs / dfs) or settled (dijkstra), so a local query only pays for the vertices it touches.
+    // directionOptimizingBfs and parallelBfs return the same depths as bfsResult, faster on large graphs;
+    // multiSourceBfs returns the depths from a whole batch of sources in one search, and
+    // bidirectionalBfs answers a single source - target hop query without exploring the whole graph.
     class Algorithms {
     public:
-        // Returns a BFS tree graph from 'startVertex'
-        static Graph bfs(const Graph& g, int startVertex);
+        // Returns a BFS tree graph from 'startVertex', or the parent / depth arrays of the same search
+        GRAPH_UNDIRECTED_TYPES(GRAPH_DECLARE_BFS)
+        GRAPH_DECLARE_BFS(ExternalGraph)
+        static DirectedGraph bfs(const DirectedGraph& g, VertexId startVertex);
+        static BfsResult bfsResult(const DirectedGraph& g, VertexId startVertex);
+
+        // Same search into 'workspace' (the tree is read from it); returns the number of reached vertices
+        GRAPH_IN_MEMORY_TYPES(GRAPH_DECLARE_BFS_IN_WORKSPACE)
+
+        // Direction-optimizing BFS (Beamer et al.): levels are expanded top-down from a queue while
+        // the frontier is small, and bottom-up (every unvisited vertex looks for a parent in a bitmap
+        // of the frontier) once the frontier's edges exceed the unexplored edges / BOTTOM_UP_ALPHA;
+        // it goes back to top-down when a shrinking frontier has fewer than n / TOP_DOWN_BETA vertices.
+        // Same depths as bfsResult; a parent may be another vertex of the previous level.
+        // A DirectedGraph is searched bottom-up through its in-edges.
+        static const int BOTTOM_UP_ALPHA = 15;
+        static const int TOP_DOWN_BETA = 18;
+        GRAPH_IN_MEMORY_TYPES(GRAPH_DECLARE_DIRECTION_OPTIMIZING_BFS)
+
+        // Level-synchronous BFS on 'numThreads' threads (0: one per core). Each level's frontier edges
+        // are cut into chunks of PARALLEL_BFS_CHUNK edges that the workers claim one at a time, so a
+        // hub's list is shared out instead of stalling one worker (Graph, CsrGraph, SoaCsrGraph,
+        // MappedGraph and DirectedGraph split lists; the other types hand out whole lists).
+        // A vertex is claimed with a compare-and-swap on its parent and goes to the claiming worker's
+        // own next-frontier buffer. Levels with fewer than PARALLEL_BFS_THRESHOLD edges run on the
+        // calling thread. Depths always equal bfsResult's; parents are any previous-level neighbor,
+        // or with 'deterministic' the smallest-id one, so the result is the same on every run.
+        static const std::size_t PARALLEL_BFS_CHUNK = 1024;
+        static const std::size_t PARALLEL_BFS_THRESHOLD = 1 << 16;
+        GRAPH_IN_MEMORY_TYPES(GRAPH_DECLARE_PARALLEL_BFS)
+
+        // Multi-source BFS (MS-BFS, Then et al.): hop distances from every one of 'sources'.
+        // MULTI_SOURCE_BATCH searches run together, each vertex holding one bit per search in its
+        // seen / frontier / next words, so one pass over a level's edges advances the whole batch;
+        // longer source lists are run batch after batch. It pays off when the searches' frontiers
+        // overlap (small-world graphs); on long paths and grids separate bfsResult calls are faster.
+        // The result holds numSources x n depths, so pass thousands of sources a slice at a time.
+        static const std::size_t MULTI_SOURCE_BATCH = 64;
+        GRAPH_IN_MEMORY_TYPES(GRAPH_DECLARE_MULTI_SOURCE_BFS)
 
-        // Returns a DFS tree graph from 'startVertex'
-        static Graph dfs(const Graph& g, int startVertex);
+        // Hop distance from 'source' to 'target' (and with 'withPath' one shortest path) by bidirectional
+        // BFS: a search from each end, always expanding the side whose frontier has fewer vertices,
+        // stopping as soon as the two meet. Only the two balls around the ends are explored, instead
+        // of the whole component. A DirectedGraph is searched backward from 'target' over its in-edges.
+        // The workspace form runs in two caller workspaces (which must differ) and allocates nothing;
+        // the parents of both searches stay readable in them until their next query.
+        GRAPH_IN_MEMORY_TYPES(GRAPH_DECLARE_BIDIRECTIONAL_BFS)
 
-        // Returns a shortest-path tree using Dijkstra (throws if negative edges)
-        static Graph dijkstra(const Graph& g, int startVertex);
+        // Returns a DFS tree graph from 'startVertex', or the parent / depth arrays of the same search
+        GRAPH_UNDIRECTED_TYPES(GRAPH_DECLARE_DFS)
+        static DirectedGraph dfs(const DirectedGraph& g, VertexId startVertex);
+        static DfsResult dfsResult(const DirectedGraph& g, VertexId startVertex);
+        static Graph dfs(const ExternalGraph& g, VertexId startVertex) = delete;
+        static DfsResult dfsResult(const ExternalGraph& g, VertexId startVertex) = delete;
 
-        // Returns MST using Prim
-        static Graph prim(const Graph& g);
+        // Same search into 'workspace'; returns the number of reached vertices
+        GRAPH_IN_MEMORY_TYPES(GRAPH_DECLARE_DFS_IN_WORKSPACE)
 
-        // Returns MST using Kruskal
-        static Graph kruskal(const Graph& g);
+        // Returns a shortest-path tree using Dijkstra, or the distance / parent arrays
+        // (throws if negative edges)
+        GRAPH_UNDIRECTED_TYPES(GRAPH_DECLARE_DIJKSTRA)
+        static DirectedGraph dijkstra(const DirectedGraph& g, VertexId startVertex);
+        static SsspResult dijkstraResult(const DirectedGraph& g, VertexId startVertex);
+        static Graph dijkstra(const ExternalGraph& g, VertexId startVertex) = delete;
+        static SsspResult dijkstraResult(const ExternalGraph& g, VertexId startVertex) = delete;
+
+        // Binary-heap Dijkstra into 'workspace'; throws when it meets a negative edge (the whole
+        // graph is not scanned first). Returns the number of reached vertices
+        GRAPH_IN_MEMORY_TYPES(GRAPH_DECLARE_DIJKSTRA_IN_WORKSPACE)
+
+        // Returns MST using Prim, or its edge list and total weight
+        GRAPH_UNDIRECTED_TYPES(GRAPH_DECLARE_PRIM)
+        static Graph prim(const DirectedGraph& g) = delete;
+        static MstResult primResult(const DirectedGraph& g) = delete;
+        static Graph prim(const ExternalGraph& g) = delete;
+        static MstResult primResult(const ExternalGraph& g) = delete;
+
+        // Returns MST using Kruskal, or the MST (or spanning forest) edge list and total weight
+        GRAPH_UNDIRECTED_TYPES(GRAPH_DECLARE_KRUSKAL)
+        GRAPH_DECLARE_KRUSKAL(ExternalGraph)
+        static Graph kruskal(const DirectedGraph& g) = delete;
+        static MstResult kruskalResult(const DirectedGraph& g) = delete;
+
+        // Labels every vertex with its connected component: component[v] (an array of
+        // getNumVertices() entries) gets 0..k-1, numbered by smallest vertex. Returns k.
+        GRAPH_UNDIRECTED_TYPES(GRAPH_DECLARE_CONNECTED_COMPONENTS)
+        GRAPH_DECLARE_CONNECTED_COMPONENTS(ExternalGraph)
+        static VertexId connectedComponents(const DirectedGraph& g, VertexId* component) = delete;
     };
 
+#undef GRAPH_DECLARE_BFS
+#undef GRAPH_DECLARE_BFS_IN_WORKSPACE
+#undef GRAPH_DECLARE_DIRECTION_OPTIMIZING_BFS
+#undef GRAPH_DECLARE_PARALLEL_BFS
+#undef GRAPH_DECLARE_MULTI_SOURCE_BFS
+#undef GRAPH_DECLARE_BIDIRECTIONAL_BFS
+#undef GRAPH_DECLARE_DFS
+#undef GRAPH_DECLARE_DFS_IN_WORKSPACE
+#undef GRAPH_DECLARE_DIJKSTRA
+#undef GRAPH_DECLARE_DIJKSTRA_IN_WORKSPACE
+#undef GRAPH_DECLARE_PRIM
+#undef GRAPH_DECLARE_KRUSKAL
+#undef GRAPH_DECLARE_CONNECTED_COMPONENTS
+
 } // namespace graph
 
 #endif
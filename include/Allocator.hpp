@@ -0,0 +1,91 @@
+// email: yaacovkrawiec@gmail.com
+
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+#include <cstddef>
+
+namespace graph {
+
+    // Pluggable source of memory for the per-vertex adjacency arrays of a Graph.
+    // Destroying an allocator releases every block it handed out, so the Graph
+    // does not have to give its arrays back one by one.
+    class BlockAllocator {
+    public:
+        virtual ~BlockAllocator() {}
+
+        // Returns a block of at least 'bytes' bytes (8-byte aligned)
+        virtual void* allocate(std::size_t bytes) = 0;
+
+        // Gives back a block obtained from allocate() with the same 'bytes'
+        virtual void deallocate(void* block, std::size_t bytes) = 0;
+
+        // A new, empty allocator of the same kind (used when a Graph is copied)
+        virtual BlockAllocator* clone() const = 0;
+    };
+
+    // Plain operator new / delete, one heap call per block.
+    // Live blocks are linked together so that the destructor can free them.
+    class HeapAllocator : public BlockAllocator {
+    private:
+        struct Header {
+            Header* prev;
+            Header* next;
+        };
+        Header* head;
+
+        HeapAllocator(const HeapAllocator&);
+        HeapAllocator& operator=(const HeapAllocator&);
+
+    public:
+        HeapAllocator();
+        ~HeapAllocator();
+        void* allocate(std::size_t bytes);
+        void deallocate(void* block, std::size_t bytes);
+        BlockAllocator* clone() const;
+    };
+
+    // Size-class slab allocator.
+    // Blocks are carved out of large chunks; a freed block goes on the free list of its
+    // size class and is handed out again by the next allocate() of that class.
+    // The destructor frees whole chunks, never individual blocks.
+    class SlabAllocator : public BlockAllocator {
+    private:
+        // Size classes are 16, 24, 32, 48, 64, 96, ... (powers of two and 1.5x powers of two)
+        static const int NUM_CLASSES = 128;
+
+        struct FreeBlock {
+            FreeBlock* next;
+        };
+        struct Chunk {
+            Chunk* next;
+            std::size_t size; // keeps the header 16 bytes long
+        };
+
+        std::size_t chunkSize;           // largest regular chunk, in bytes
+        std::size_t nextChunkSize;       // regular chunks start small and double up to chunkSize
+        FreeBlock* freeLists[NUM_CLASSES];
+        Chunk* chunks;                   // every chunk ever allocated
+        char* bumpCurrent;               // free space left in the newest regular chunk
+        char* bumpEnd;
+
+        static int sizeClass(std::size_t bytes);
+        static std::size_t classSize(int sizeClassIndex);
+        char* newChunk(std::size_t bytes);
+
+        SlabAllocator(const SlabAllocator&);
+        SlabAllocator& operator=(const SlabAllocator&);
+
+    public:
+        // Blocks bigger than a quarter of 'chunkBytes' get a dedicated chunk.
+        // Chunks come from MemoryPolicy, so the default (2 MB) chunks can be huge pages.
+        explicit SlabAllocator(std::size_t chunkBytes = 2 << 20);
+        ~SlabAllocator();
+        void* allocate(std::size_t bytes);
+        void deallocate(void* block, std::size_t bytes);
+        BlockAllocator* clone() const;
+    };
+
+} // namespace graph
+
+#endif
@@ -0,0 +1,202 @@
+// email: yaacovkrawiec@gmail.com
+
+#ifndef COMPRESSEDGRAPH_H
+#define COMPRESSEDGRAPH_H
+
+#include "Graph.hpp"
+#include "CsrGraph.hpp"
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+namespace graph {
+
+    // Reads one LEB128 varint (7 bits per byte, high bit = "more bytes follow")
+    inline unsigned int decodeVarint(const unsigned char*& p) {
+        unsigned int value = *p & 0x7F;
+        int shift = 7;
+        while(*p++ & 0x80) {
+            value |= static_cast<unsigned int>(*p & 0x7F) << shift;
+            shift += 7;
+        }
+        return value;
+    }
+
+    // Same for 64-bit values (up to 10 bytes)
+    inline unsigned long long decodeVarint64(const unsigned char*& p) {
+        unsigned long long value = *p & 0x7F;
+        int shift = 7;
+        while(*p++ & 0x80) {
+            value |= static_cast<unsigned long long>(*p & 0x7F) << shift;
+            shift += 7;
+        }
+        return value;
+    }
+
+    // Zigzag maps small negative values to small unsigned values: 0,-1,1,-2,... => 0,1,2,3,...
+    inline unsigned int zigzagEncode(int value) {
+        return (static_cast<unsigned int>(value) << 1) ^ static_cast<unsigned int>(value >> 31);
+    }
+    inline int zigzagDecode(unsigned int value) {
+        return static_cast<int>(value >> 1) ^ -static_cast<int>(value & 1);
+    }
+    inline unsigned long long zigzagEncode64(long long value) {
+        return (static_cast<unsigned long long>(value) << 1) ^ static_cast<unsigned long long>(value >> 63);
+    }
+    inline long long zigzagDecode64(unsigned long long value) {
+        return static_cast<long long>(value >> 1) ^ -static_cast<long long>(value & 1);
+    }
+
+    // Destination deltas of ids up to 32 bits use the 32-bit routines, wider ids the 64-bit ones
+    template <bool Wide = (sizeof(VertexId) > 4)>
+    struct VertexVarint {
+        typedef unsigned int Code;
+        static Code zigzag(long long delta) { return zigzagEncode(static_cast<int>(delta)); }
+        static int unzigzag(Code code) { return zigzagDecode(code); }
+        static Code decode(const unsigned char*& p) { return decodeVarint(p); }
+    };
+    template <>
+    struct VertexVarint<true> {
+        typedef unsigned long long Code;
+        static Code zigzag(long long delta) { return zigzagEncode64(delta); }
+        static long long unzigzag(Code code) { return zigzagDecode64(code); }
+        static Code decode(const unsigned char*& p) { return decodeVarint64(p); }
+    };
+
+    // How a Weight is stored in a compressed block:
+    // integral weights as a zigzag varint, floating point weights as their raw bytes.
+    template <typename T, bool Integral = std::is_integral<T>::value>
+    struct WeightCodec {
+        static const int MAX_BYTES = 10;
+        static int encode(T w, unsigned char* out) {
+            unsigned long long value = zigzagEncode64(static_cast<long long>(w));
+            int n = 0;
+            while(value >= 0x80) {
+                out[n++] = static_cast<unsigned char>(value | 0x80);
+                value >>= 7;
+            }
+            out[n++] = static_cast<unsigned char>(value);
+            return n;
+        }
+        static T decode(const unsigned char*& p) {
+            return static_cast<T>(zigzagDecode64(decodeVarint64(p)));
+        }
+    };
+    template <typename T>
+    struct WeightCodec<T, false> {
+        static const int MAX_BYTES = sizeof(T);
+        static int encode(T w, unsigned char* out) {
+            std::memcpy(out, &w, sizeof(T));
+            return sizeof(T);
+        }
+        static T decode(const unsigned char*& p) {
+            T w;
+            std::memcpy(&w, p, sizeof(T));
+            p += sizeof(T);
+            return w;
+        }
+    };
+
+    // Decodes the neighbors of one vertex on the fly
+    class CompressedEdgeIterator {
+    private:
+        const unsigned char* p;
+        int remaining;
+        VertexId dest;
+        Weight w;
+
+    public:
+        CompressedEdgeIterator(const unsigned char* block, int degree, VertexId vertex)
+            : p(block), remaining(degree), dest(vertex), w(0) {
+            if(remaining > 0) {
+                // The first destination is stored relative to the vertex itself (may be negative)
+                dest += VertexVarint<>::unzigzag(VertexVarint<>::decode(p));
+                w = WeightCodec<Weight>::decode(p);
+            }
+        }
+        bool done() const { return remaining == 0; }
+        void next() {
+            if(--remaining > 0) {
+                dest += static_cast<VertexId>(VertexVarint<>::decode(p));
+                w = WeightCodec<Weight>::decode(p);
+            }
+        }
+        VertexId destination() const { return dest; }
+        Weight weight() const { return w; }
+    };
+
+    // Read-only compressed adjacency.
+    // Each vertex owns one byte block: varint(degree), then for every neighbor (sorted by destination)
+    // varint(destination - previous destination) and the weight (see WeightCodec); the first
+    // destination is stored as zigzag(destination - vertex).
+    // Neighbors in the same block usually have close IDs, so most edges take 2-3 bytes instead of 8.
+    // Floating point weights are not compressed: each one keeps its sizeof(Weight) raw bytes, so with
+    // float / double weights only the destinations shrink.
+    // Block offsets are 32-bit, relative to a 64-bit base shared by a group of 4096 vertices.
+    class CompressedGraph {
+    private:
+        static const int GROUP_BITS = 12;
+
+        VertexId numVertices;
+        std::size_t* groupOffsets;   // byte offset of each group of vertices
+        unsigned int* localOffsets;  // byte offset of each vertex block inside its group
+        unsigned char* data;
+        std::size_t dataBytes;
+        std::size_t numAdjEntries;
+        bool negativeWeights;
+
+        std::size_t numGroups() const { return static_cast<std::size_t>(numVertices >> GROUP_BITS) + 1; }
+        const unsigned char* block(VertexId vertex) const {
+            return data + groupOffsets[vertex >> GROUP_BITS] + localOffsets[vertex];
+        }
+
+        template <typename G>
+        void build(const G& g);
+
+    public:
+        explicit CompressedGraph(const Graph& g);
+        explicit CompressedGraph(const CsrGraph& g);
+
+        // Destructor
+        ~CompressedGraph();
+
+        // Copy constructor / assignment operator
+        CompressedGraph(const CompressedGraph& other);
+        CompressedGraph& operator=(const CompressedGraph& other);
+
+        // Move constructor / move assignment (the moved-from graph has 0 vertices)
+        CompressedGraph(CompressedGraph&& other) noexcept;
+        CompressedGraph& operator=(CompressedGraph&& other) noexcept;
+
+        void swap(CompressedGraph& other) noexcept;
+
+        // Print adjacency list (same format as Graph::printGraph, neighbors come out sorted)
+        void printGraph() const;
+
+        // Bytes used by the offsets and the encoded blocks
+        std::size_t getMemoryBytes() const;
+
+        // Accessors
+        VertexId getNumVertices() const { return numVertices; }
+        int getAdjSize(VertexId vertex) const {
+            const unsigned char* p = block(vertex);
+            return static_cast<int>(decodeVarint(p));
+        }
+        std::size_t getNumAdjEntries() const { return numAdjEntries; }
+        bool hasNegativeWeight() const { return negativeWeights; }
+
+        typedef CompressedEdgeIterator NeighborIterator;
+        NeighborIterator neighbors(VertexId vertex) const {
+            const unsigned char* p = block(vertex);
+            int degree = static_cast<int>(decodeVarint(p));
+            return NeighborIterator(p, degree, vertex);
+        }
+    };
+
+    inline void swap(CompressedGraph& a, CompressedGraph& b) noexcept {
+        a.swap(b);
+    }
+
+} // namespace graph
+
+#endif
@@ -0,0 +1,70 @@
+// email: yaacovkrawiec@gmail.com
+
+#ifndef CSRGRAPH_H
+#define CSRGRAPH_H
+
+#include "Graph.hpp"
+#include <cstddef>
+
+namespace graph {
+
+    // Immutable compressed-sparse-row snapshot of a Graph.
+    // All adjacency arrays are packed one after the other into a single 'edges' array,
+    // and the neighbors of v are edges[offsets[v]] .. edges[offsets[v+1] - 1].
+    class CsrGraph {
+    private:
+        VertexId numVertices;
+        std::size_t* offsets; // numVertices + 1 entries (nullptr once moved from)
+        Edge* edges;          // offsets[numVertices] entries
+
+        // Give both arrays back to MemoryPolicy
+        void release();
+
+    public:
+        // Build a snapshot of 'g' (same as g.freeze())
+        explicit CsrGraph(const Graph& g);
+
+        // Adopt prebuilt arrays from MemoryPolicy::allocateArray (numberOfVertices + 1 offsets)
+        CsrGraph(VertexId numberOfVertices, std::size_t* offsetArray, Edge* edgeArray);
+
+        // Destructor
+        ~CsrGraph();
+
+        // Copy constructor
+        CsrGraph(const CsrGraph& other);
+
+        // Assignment operator
+        CsrGraph& operator=(const CsrGraph& other);
+
+        // Move constructor / move assignment (the moved-from snapshot has 0 vertices)
+        CsrGraph(CsrGraph&& other) noexcept;
+        CsrGraph& operator=(CsrGraph&& other) noexcept;
+
+        // Exchange the contents of two snapshots in O(1)
+        void swap(CsrGraph& other) noexcept;
+
+        // Print adjacency list (same format as Graph::printGraph)
+        void printGraph() const;
+
+        // true if any edge weight is negative
+        bool hasNegativeWeight() const;
+
+        // Accessors (same shape as Graph so the algorithms can run on both)
+        VertexId getNumVertices() const { return numVertices; }
+        const Edge* getAdjList(VertexId vertex) const { return edges + offsets[vertex]; }
+        int getAdjSize(VertexId vertex) const { return static_cast<int>(offsets[vertex + 1] - offsets[vertex]); }
+        std::size_t getNumAdjEntries() const { return offsets != nullptr ? offsets[numVertices] : 0; }
+
+        typedef EdgeIterator NeighborIterator;
+        NeighborIterator neighbors(VertexId vertex) const {
+            return NeighborIterator(edges + offsets[vertex], edges + offsets[vertex + 1]);
+        }
+    };
+
+    inline void swap(CsrGraph& a, CsrGraph& b) noexcept {
+        a.swap(b);
+    }
+
+} // namespace graph
+
+#endif
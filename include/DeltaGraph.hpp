@@ -0,0 +1,226 @@
+// email: yaacovkrawiec@gmail.com
+
+#ifndef DELTAGRAPH_H
+#define DELTAGRAPH_H
+
+#include "Graph.hpp"
+#include "CsrGraph.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <thread>
+
+namespace graph {
+
+    // One layer of changes over the layers below it: inserted edges, plus tombstones that hide
+    // edges of the lower layers (sorted per vertex for binary search). An inserted edge is visible
+    // even if the same layer also holds a tombstone for it (removed from below, then added again).
+    // The vertices a layer touches are listed, so clear() costs O(entries) instead of O(n).
+    class DeltaLayer {
+    private:
+        Graph inserts;
+        VertexId** tombstones;
+        int* tombstoneSizes;
+        int* tombstoneCapacities;
+        std::size_t numInsertEntries;   // both directions, like Graph::getNumAdjEntries
+        std::size_t numTombstoneEntries;
+        VertexId* touched;              // vertices with inserts or tombstones, numTouched of them
+        VertexId numTouched;
+        bool* isTouched;
+
+        void touch(VertexId vertex) {
+            if(!isTouched[vertex]) {
+                isTouched[vertex] = true;
+                touched[numTouched++] = vertex;
+            }
+        }
+        void addTombstoneEntry(VertexId vertex, VertexId dest);
+
+        DeltaLayer(const DeltaLayer&);
+        DeltaLayer& operator=(const DeltaLayer&);
+
+    public:
+        explicit DeltaLayer(VertexId numberOfVertices);
+        ~DeltaLayer();
+
+        void insert(VertexId source, VertexId dest, Weight weight);
+        // Remove an inserted edge; false if this layer did not insert it
+        bool eraseInsert(VertexId source, VertexId dest);
+        // Inserted edge source-dest (its weight goes to 'weight')
+        bool findInsert(VertexId source, VertexId dest, Weight& weight) const;
+
+        void addTombstone(VertexId source, VertexId dest);
+
+        // Drop every insert and tombstone; the arrays are kept for the next use of the layer
+        void clear();
+        bool isTombstoned(VertexId source, VertexId dest) const {
+            return tombstoneSizes[source] > 0
+                && std::binary_search(tombstones[source], tombstones[source] + tombstoneSizes[source], dest);
+        }
+
+        // Number of directed entries (inserts + tombstones) held by the layer
+        std::size_t size() const { return numInsertEntries + numTombstoneEntries; }
+        const Graph& getInserts() const { return inserts; }
+    };
+
+    // Merged view of one vertex: base entries not hidden by a tombstone, then the sealed
+    // layer's inserts not hidden by the active layer, then the active layer's inserts
+    class DeltaEdgeIterator {
+    private:
+        VertexId vertex;
+        const DeltaLayer* sealed;  // nullptr when no compaction is running
+        const DeltaLayer* active;
+        int stage;                 // 0 = base, 1 = sealed inserts, 2 = active inserts
+        const Edge* current;
+        const Edge* end;
+
+        bool hidden() const {
+            if(stage == 0 && sealed != nullptr && sealed->isTombstoned(vertex, current->destination)) {
+                return true;
+            }
+            return stage < 2 && active->isTombstoned(vertex, current->destination);
+        }
+        // Move to the next visible entry (or to the end of stage 2)
+        void settle() {
+            for(;;) {
+                if(current == end) {
+                    if(stage == 2) {
+                        return;
+                    }
+                    stage++;
+                    if(stage == 1 && sealed == nullptr) {
+                        stage++;
+                    }
+                    const Graph& g = (stage == 1) ? sealed->getInserts() : active->getInserts();
+                    current = g.getAdjList(vertex);
+                    end = current + g.getAdjSize(vertex);
+                    continue;
+                }
+                if(!hidden()) {
+                    return;
+                }
+                ++current;
+            }
+        }
+
+    public:
+        DeltaEdgeIterator(VertexId v, const Edge* baseBegin, const Edge* baseEnd,
+                          const DeltaLayer* sealedLayer, const DeltaLayer* activeLayer)
+            : vertex(v), sealed(sealedLayer), active(activeLayer), stage(0), current(baseBegin), end(baseEnd)
+        {
+            settle();
+        }
+        bool done() const { return current == end; }
+        void next() { ++current; settle(); }
+        VertexId destination() const { return current->destination; }
+        Weight weight() const { return current->weight; }
+    };
+
+    // Mutable graph with the read speed of a packed layout (LSM style):
+    //   base   - immutable CSR with sorted neighbor lists
+    //   sealed - layer being folded into a new base by a background thread
+    //   active - layer that receives every addEdge / removeEdge
+    // Once the active layer holds compactionThreshold entries it is sealed and merged with the base
+    // on another thread; reads and writes go on meanwhile (they only read the base and the sealed
+    // layer). Sealing is O(1): a spare layer, allocated up front and cleared after each compaction,
+    // becomes the active one. The finished base is swapped in by the next addEdge / removeEdge /
+    // waitForCompaction call, so iterators stay valid until the next mutation, as with Graph.
+    // If the merge throws (e.g. std::bad_alloc), the sealed layer stays in place and the exception
+    // is rethrown by that call; a later waitForCompaction() or compact() retries the merge.
+    // Like Graph, one DeltaGraph must not be used from several threads at once.
+    class DeltaGraph {
+    private:
+        VertexId numVertices;
+        CsrGraph* base;
+        DeltaLayer* sealed;
+        DeltaLayer* active;
+        int* degrees;                  // visible degree of every vertex
+        std::size_t numAdjEntries;
+        std::size_t compactionThreshold;
+
+        DeltaLayer* spare;             // empty layer that becomes the next active one
+
+        std::thread compactor;
+        CsrGraph* compacted;           // new base, written by the compactor
+        std::exception_ptr compactionError; // what the compactor threw instead (e.g. std::bad_alloc)
+        std::atomic<bool> compactionDone;
+
+        // New base: the visible entries of 'below' and of 'layer' (may be nullptr), sorted per vertex
+        template <typename G>
+        static CsrGraph* mergeLayers(const G& below, const DeltaLayer* layer);
+
+        bool visibleBelowActive(VertexId source, VertexId dest) const;
+        void startCompaction();
+        void installIfDone();
+        void joinCompactor() noexcept;
+
+    public:
+        static const std::size_t DEFAULT_COMPACTION_THRESHOLD = 1 << 16;
+
+        // Start from a copy of 'g'
+        explicit DeltaGraph(const Graph& g, std::size_t compactionEntries = DEFAULT_COMPACTION_THRESHOLD);
+
+        // Destructor (waits for a running compaction)
+        ~DeltaGraph();
+
+        // Not copyable: freeze a snapshot or build a new DeltaGraph instead
+        DeltaGraph(const DeltaGraph& other) = delete;
+        DeltaGraph& operator=(const DeltaGraph& other) = delete;
+
+        // Move constructor / move assignment (wait for the compactor first; the moved-from graph has 0 vertices)
+        DeltaGraph(DeltaGraph&& other) noexcept;
+        DeltaGraph& operator=(DeltaGraph&& other) noexcept;
+
+        void swap(DeltaGraph& other) noexcept;
+
+        // Add an undirected edge; an existing edge gets the new weight
+        void addEdge(VertexId source, VertexId dest, Weight weight = 1);
+
+        // Remove an undirected edge (throws if it doesn't exist)
+        void removeEdge(VertexId source, VertexId dest);
+
+        bool hasEdge(VertexId source, VertexId dest) const;
+
+        // Fold all changes into the base now (blocks until done)
+        void compact();
+
+        // Wait for a running background compaction and install its result
+        // (rethrows what the merge threw; the graph is unchanged then)
+        void waitForCompaction();
+        bool isCompacting() const { return sealed != nullptr; }
+
+        // Entries in the delta layers (sealed + active)
+        std::size_t getDeltaSize() const {
+            return (active != nullptr ? active->size() : 0) + (sealed != nullptr ? sealed->size() : 0);
+        }
+        std::size_t getCompactionThreshold() const { return compactionThreshold; }
+
+        // Current contents as a plain Graph
+        Graph toGraph() const;
+
+        // Print adjacency list (same format as Graph::printGraph)
+        void printGraph() const;
+
+        // true if any visible edge weight is negative
+        bool hasNegativeWeight() const;
+
+        // Accessors
+        VertexId getNumVertices() const { return numVertices; }
+        int getAdjSize(VertexId vertex) const { return degrees[vertex]; }
+        std::size_t getNumAdjEntries() const { return numAdjEntries; }
+
+        typedef DeltaEdgeIterator NeighborIterator;
+        NeighborIterator neighbors(VertexId vertex) const {
+            const Edge* list = base->getAdjList(vertex);
+            return NeighborIterator(vertex, list, list + base->getAdjSize(vertex), sealed, active);
+        }
+    };
+
+    inline void swap(DeltaGraph& a, DeltaGraph& b) noexcept {
+        a.swap(b);
+    }
+
+} // namespace graph
+
+#endif
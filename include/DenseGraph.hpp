@@ -0,0 +1,138 @@
+// email: yaacovkrawiec@gmail.com
+
+#ifndef DENSEGRAPH_H
+#define DENSEGRAPH_H
+
+#include "Graph.hpp"
+#include "CsrGraph.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace graph {
+
+    // Walks the set bits of one adjacency row; the weight of neighbor d is row[d]
+    class BitRowIterator {
+    private:
+        const std::uint64_t* words;
+        std::size_t numWords;
+        std::size_t wordIndex;
+        std::uint64_t pending;   // bits of words[wordIndex] not visited yet
+        const Weight* row;
+        VertexId current;
+
+        void settle() {
+            while(pending == 0 && ++wordIndex < numWords) {
+                pending = words[wordIndex];
+            }
+            if(pending != 0) {
+                current = static_cast<VertexId>(wordIndex * 64 + __builtin_ctzll(pending));
+            }
+        }
+
+    public:
+        BitRowIterator(const std::uint64_t* rowWords, std::size_t wordCount, const Weight* weightRow)
+            : words(rowWords), numWords(wordCount), wordIndex(0), pending(wordCount > 0 ? rowWords[0] : 0),
+              row(weightRow), current(0)
+        {
+            settle();
+        }
+        bool done() const { return pending == 0; }
+        void next() { pending &= pending - 1; settle(); }
+        VertexId destination() const { return current; }
+        Weight weight() const { return row[current]; }
+    };
+
+    // Immutable adjacency-matrix snapshot for dense graphs: one bitset row per vertex plus an
+    // n x n weight matrix (row-major), about n^2 * (sizeof(Weight) + 1/8) bytes whatever the density.
+    // That is more than the Edge arrays at DENSITY_PERCENT (for int weights: 4.1 n^2 bytes against
+    // 3.6 n^2 for a Graph and 2.4 n^2 for a CsrGraph); what it buys is time: edge lookups are O(1),
+    // and Dijkstra / Prim switch to the O(V^2) scan with a vectorized argmin instead of a priority queue.
+    // Repeated edges keep the lightest weight.
+    class DenseGraph {
+    private:
+        VertexId numVertices;
+        std::size_t wordsPerRow;     // 64-bit words per bitset row
+        std::uint64_t* bits;         // numVertices * wordsPerRow
+        Weight* weights;             // numVertices * numVertices (0 where there is no edge)
+        int* degrees;
+        std::size_t numAdjEntries;
+
+        template <typename G>
+        void build(const G& g);
+
+        // Give the arrays back to MemoryPolicy
+        void release();
+
+        std::size_t matrixSize() const { return static_cast<std::size_t>(numVertices) * numVertices; }
+
+    public:
+        // Algorithms::dijkstra / prim use this form on their own from this density on ...
+        static const int DENSITY_PERCENT = 30;
+        // ... for graphs of at least this many vertices (below it the matrix does not pay off)
+        static const VertexId MIN_VERTICES = 64;
+
+        // ... and only while the matrix they build on every call stays this small. Above it, build
+        // a DenseGraph once and pass it instead (or keep using the sparse form).
+        static const std::size_t AUTO_CONVERT_BYTES = std::size_t(64) << 20;
+
+        // true if a graph of this size is dense enough for the matrix form
+        static bool isDenseEnough(VertexId numberOfVertices, std::size_t adjEntries);
+
+        // Bytes of the matrix form of a graph with this many vertices
+        static std::size_t matrixBytes(VertexId numberOfVertices);
+
+        // true if dijkstra / prim convert a Graph / CsrGraph of this size on the fly
+        // (dense enough, and the matrix fits in AUTO_CONVERT_BYTES)
+        static bool shouldConvert(VertexId numberOfVertices, std::size_t adjEntries);
+
+        explicit DenseGraph(const Graph& g);
+        explicit DenseGraph(const CsrGraph& g);
+
+        // Destructor
+        ~DenseGraph();
+
+        // Copy constructor / assignment operator
+        DenseGraph(const DenseGraph& other);
+        DenseGraph& operator=(const DenseGraph& other);
+
+        // Move constructor / move assignment (the moved-from snapshot has 0 vertices)
+        DenseGraph(DenseGraph&& other) noexcept;
+        DenseGraph& operator=(DenseGraph&& other) noexcept;
+
+        void swap(DenseGraph& other) noexcept;
+
+        // O(1) edge lookups
+        bool hasEdge(VertexId source, VertexId dest) const {
+            return isValidVertex(source, numVertices) && isValidVertex(dest, numVertices)
+                && ((getBitRow(source)[dest / 64] >> (dest % 64)) & 1) != 0;
+        }
+        // Weight of the edge source-dest (throws if it doesn't exist)
+        Weight edgeWeight(VertexId source, VertexId dest) const;
+
+        // Print adjacency list (same format as Graph::printGraph)
+        void printGraph() const;
+
+        // true if any edge weight is negative
+        bool hasNegativeWeight() const;
+
+        // Accessors
+        VertexId getNumVertices() const { return numVertices; }
+        int getAdjSize(VertexId vertex) const { return degrees[vertex]; }
+        std::size_t getNumAdjEntries() const { return numAdjEntries; }
+        std::size_t getWordsPerRow() const { return wordsPerRow; }
+        const std::uint64_t* getBitRow(VertexId vertex) const { return bits + static_cast<std::size_t>(vertex) * wordsPerRow; }
+        const Weight* getWeightRow(VertexId vertex) const { return weights + static_cast<std::size_t>(vertex) * numVertices; }
+
+        typedef BitRowIterator NeighborIterator;
+        NeighborIterator neighbors(VertexId vertex) const {
+            return NeighborIterator(getBitRow(vertex), wordsPerRow, getWeightRow(vertex));
+        }
+    };
+
+    inline void swap(DenseGraph& a, DenseGraph& b) noexcept {
+        a.swap(b);
+    }
+
+} // namespace graph
+
+#endif
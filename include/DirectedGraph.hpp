@@ -0,0 +1,90 @@
+// email: yaacovkrawiec@gmail.com
+
+#ifndef DIRECTEDGRAPH_H
+#define DIRECTEDGRAPH_H
+
+#include "AdjacencyLists.hpp"
+#include <cstddef>
+
+namespace graph {
+
+    // Directed graph: addEdge(u, v) only stores u -> v, so each edge costs one Edge instead of two.
+    // Out-edges live in the same per-vertex lists as Graph (AdjacencyLists); in-edges are available
+    // through a transpose index that is built on the first inNeighbors() call and dropped by every mutation.
+    // Being a separate type, it cannot be passed to the undirected-only algorithms (prim, kruskal).
+    class DirectedGraph : private AdjacencyLists {
+    private:
+        // Transpose index (CSR): in-edges of v are inEdges[inOffsets[v]] .. inEdges[inOffsets[v+1] - 1],
+        // where 'destination' holds the source vertex. nullptr until first needed.
+        mutable std::size_t* inOffsets;
+        mutable Edge* inEdges;
+
+        void buildInIndex() const;
+        void dropInIndex();
+
+    public:
+        // Constructor (adjacency arrays come from a SlabAllocator)
+        DirectedGraph(VertexId numberOfVertices);
+
+        // Constructor with a custom allocator (the graph takes ownership of it)
+        DirectedGraph(VertexId numberOfVertices, BlockAllocator* edgeAllocator);
+
+        // Destructor
+        ~DirectedGraph();
+
+        // Copy constructor / assignment operator (the transpose index is rebuilt on demand)
+        DirectedGraph(const DirectedGraph& other);
+        DirectedGraph& operator=(const DirectedGraph& other);
+
+        // Move constructor / move assignment (the moved-from graph has 0 vertices)
+        DirectedGraph(DirectedGraph&& other) noexcept;
+        DirectedGraph& operator=(DirectedGraph&& other) noexcept;
+
+        void swap(DirectedGraph& other) noexcept;
+
+        // Add a directed edge source -> dest (default weight = 1)
+        void addEdge(VertexId source, VertexId dest, Weight weight = 1);
+
+        // Remove the directed edge source -> dest (throw exception if it doesn't exist)
+        void removeEdge(VertexId source, VertexId dest);
+
+        // Print the out-edge lists
+        void printGraph() const;
+
+        // true if any edge weight is negative
+        using AdjacencyLists::hasNegativeWeight;
+
+        // Number of directed edges
+        using AdjacencyLists::getNumAdjEntries;
+
+        // Accessors (out-edges)
+        using AdjacencyLists::getNumVertices;
+        using AdjacencyLists::getAdjList;
+        using AdjacencyLists::getAdjSize;
+
+        using AdjacencyLists::NeighborIterator;
+        using AdjacencyLists::neighbors;
+
+        // In-edges (destination() is the source vertex). Builds the transpose index if needed,
+        // so the first call after a mutation costs O(V + E) and is not thread-safe.
+        NeighborIterator inNeighbors(VertexId vertex) const {
+            if(inOffsets == nullptr) {
+                buildInIndex();
+            }
+            return NeighborIterator(inEdges + inOffsets[vertex], inEdges + inOffsets[vertex + 1]);
+        }
+        int getInDegree(VertexId vertex) const {
+            if(inOffsets == nullptr) {
+                buildInIndex();
+            }
+            return static_cast<int>(inOffsets[vertex + 1] - inOffsets[vertex]);
+        }
+    };
+
+    inline void swap(DirectedGraph& a, DirectedGraph& b) noexcept {
+        a.swap(b);
+    }
+
+} // namespace graph
+
+#endif
@@ -0,0 +1,121 @@
+// email: yaacovkrawiec@gmail.com
+
+#ifndef EXTERNALGRAPH_H
+#define EXTERNALGRAPH_H
+
+#include "Graph.hpp"
+#include "MappedGraph.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace graph {
+
+    class ExternalGraph;
+
+    // Sequential reader of adjacency lists: open(v), then walk the entries. Meant for increasing v:
+    // entries come from a block buffer refilled with one large pread per array, and a gap between
+    // two opened vertices larger than the buffer is skipped, not read. Every refill asks the
+    // kernel to start reading the next block (POSIX_FADV_WILLNEED), so the disk works while
+    // the current block is processed.
+    class ExternalScanner {
+    private:
+        const ExternalGraph* g;
+        bool withWeights;
+        std::size_t capacity;        // entries per buffer
+        VertexId* destBuffer;
+        Weight* weightBuffer;        // nullptr when weights are not read
+        std::uint64_t bufferStart;   // entry index of destBuffer[0]
+        std::uint64_t bufferEnd;
+        std::uint64_t position;      // current entry
+        std::uint64_t end;           // end of the opened list
+
+        void refill(std::uint64_t entry);
+
+        ExternalScanner(const ExternalScanner&);
+        ExternalScanner& operator=(const ExternalScanner&);
+
+    public:
+        explicit ExternalScanner(const ExternalGraph& graph, bool readWeights = true);
+        ~ExternalScanner();
+
+        // Start on the list of 'vertex' (a lower vertex than the previous one reads its block again)
+        void open(VertexId vertex);
+        bool done() const { return position == end; }
+        void next() {
+            ++position;
+            if(position < end && position == bufferEnd) {
+                refill(position);
+            }
+        }
+        VertexId destination() const { return destBuffer[position - bufferStart]; }
+        Weight weight() const { return weightBuffer[position - bufferStart]; }
+    };
+
+    // Semi-external graph for graphs larger than RAM: only the offsets (O(V)) are loaded,
+    // the adjacency arrays stay in the file and are streamed through ExternalScanner.
+    // The file format is MappedGraph's (write it with MappedGraph::write).
+    // Algorithms::bfs (one sequential pass per level), connectedComponents (one pass) and
+    // kruskal (external merge sort of the edge list) run over it; dfs, dijkstra and prim need random
+    // access and are not offered.
+    class ExternalGraph {
+    private:
+        VertexId numVertices;
+        std::size_t numAdjEntries;
+        std::uint64_t* offsets;       // numVertices + 1, in memory
+        int fd;
+        std::uint64_t destinationsPos;
+        std::uint64_t weightsPos;
+        bool negativeWeights;
+        std::size_t bufferBytes;
+        std::size_t sortBytes;
+
+        void close();
+
+        friend class ExternalScanner;
+
+    public:
+        static const std::size_t DEFAULT_BUFFER_BYTES = std::size_t(4) << 20;
+        static const std::size_t DEFAULT_SORT_BYTES = std::size_t(256) << 20;
+
+        // kruskal's merge gives every run reader at least this much of the sort budget ...
+        static const std::size_t MIN_MERGE_READ_BYTES = std::size_t(1) << 20;
+        // ... and merges at most this many runs at once (more runs take several passes)
+        static const std::size_t MAX_MERGE_FAN_IN = 64;
+
+        // Open 'path' and load its offsets (throws if the file cannot be read or is not a graph file).
+        // 'bufferBytes' sizes every read buffer of the scans; 'sortBytes' is the memory budget of
+        // kruskal's external sort (the length of its sorted runs and the buffers of its merge).
+        explicit ExternalGraph(const char* path, std::size_t bufferBytes = DEFAULT_BUFFER_BYTES,
+                               std::size_t sortBytes = DEFAULT_SORT_BYTES);
+
+        // Destructor (closes the file)
+        ~ExternalGraph();
+
+        // Not copyable: open the file again instead
+        ExternalGraph(const ExternalGraph& other) = delete;
+        ExternalGraph& operator=(const ExternalGraph& other) = delete;
+
+        // Move constructor / move assignment (the moved-from graph has 0 vertices)
+        ExternalGraph(ExternalGraph&& other) noexcept;
+        ExternalGraph& operator=(ExternalGraph&& other) noexcept;
+
+        void swap(ExternalGraph& other) noexcept;
+
+        // Stored in the file header, so no scan is needed
+        bool hasNegativeWeight() const { return negativeWeights; }
+
+        // Accessors
+        VertexId getNumVertices() const { return numVertices; }
+        int getAdjSize(VertexId vertex) const { return static_cast<int>(offsets[vertex + 1] - offsets[vertex]); }
+        std::size_t getNumAdjEntries() const { return numAdjEntries; }
+        std::size_t getBufferBytes() const { return bufferBytes; }
+        std::size_t getSortBytes() const { return sortBytes; }
+    };
+
+    inline void swap(ExternalGraph& a, ExternalGraph& b) noexcept {
+        a.swap(b);
+    }
+
+} // namespace graph
+
+#endif
@@ -5,28 +5,69 @@
 
 #include <iostream>
 #include <cstdlib>  // for exit, etc.
+#include <cstddef>
+#include "AdjacencyLists.hpp"
 
 namespace graph {
 
-    // Represents one edge in the adjacency list
-    struct Edge {
-        int destination;
-        int weight;
-    };
+    class CsrGraph;
 
-    class Graph {
+    // Undirected graph: every edge is stored in both lists, and each entry knows the index of its
+    // reverse entry (its twin) so removals are O(1). The list storage comes from AdjacencyLists.
+    class Graph : private AdjacencyLists {
     private:
-        int numVertices;         // number of vertices
-        Edge** adjacencyList;    // adjacencyList[v] = dynamic array of Edges
-        int* adjacencySizes;     // adjacencySizes[v] = current number of edges
-        int* adjacencyCapacities;// adjacencyCapacities[v] = allocated capacity for adjacencyList[v]
+        bool sortedAdjacency;    // every list kept in increasing order of destination
+
+        // addEdges() helper: writes edges [firstEdge, endEdge) into their precomputed slots
+        void fillEdges(const VertexId* src, const VertexId* dst, const Weight* weights,
+                       const int* srcSlot, const int* dstSlot, std::size_t firstEdge, std::size_t endEdge);
+
+        // Remove adjacencyList[vertex][index] only (swap with the last entry, or shift when sorted)
+        void removeEntry(VertexId vertex, int index);
+
+        // Reserve the index of a new entry to 'dest' in the list of 'vertex' (room must exist):
+        // the end of the list, or its sorted position with the later entries shifted right
+        int openEntry(VertexId vertex, VertexId dest);
+
+        // Index of an entry to 'dest' in the list of 'vertex', -1 if none
+        // (binary search when sorted, linear scan otherwise)
+        int findEntry(VertexId vertex, VertexId dest) const;
+
+        // Sort every list by destination and rebuild the twin indices
+        void sortAllLists();
+
+        // Moves the entry now at adjacencyList[vertex][index]: tell its twin where it went
+        void relinkTwin(VertexId vertex, int index) {
+            VertexId partner = adjacencyList[vertex][index].destination;
+            twinsOf(partner)[ twinsOf(vertex)[index] ] = index;
+        }
 
-        // Expand the adjacency array for a given vertex (when it's full)
-        void expandEdgeList(int vertex);
+        // The payload of a block holds one twin index per entry:
+        // twinsOf(v)[i] is the index of the reverse entry of adjacencyList[v][i]
+        // inside adjacencyList[ adjacencyList[v][i].destination ].
+        // An int, like the list sizes: parallel edges can make a degree exceed a narrow VertexId.
+        int* twinsOf(VertexId vertex) const {
+            return reinterpret_cast<int*>(payloadOf(vertex));
+        }
+
+        // countCommonNeighbors() gallops once one list is this many times longer than the other
+        static const int GALLOP_RATIO = 16;
+
+        // addEdges() fills on several threads from this many edges on
+        static const std::size_t PARALLEL_FILL_THRESHOLD = 1 << 16;
 
     public:
-        // Constructor
-        Graph(int numberOfVertices);
+        // Empty graph with no vertices (grow it with addVertex / reserveVertices)
+        Graph();
+
+        // Constructor (adjacency arrays come from a SlabAllocator)
+        Graph(VertexId numberOfVertices);
+
+        // Constructor with a custom allocator (the Graph takes ownership of it)
+        Graph(VertexId numberOfVertices, BlockAllocator* edgeAllocator);
+
+        // Constructor from an edge list (see addEdges)
+        Graph(VertexId numberOfVertices, const VertexId* src, const VertexId* dst, const Weight* weights, std::size_t numEdges);
 
         // Destructor
         ~Graph();
@@ -37,21 +78,82 @@ namespace graph {
         // Assignment operator (if needed)
         Graph& operator=(const Graph& other);
 
+        // Move constructor / move assignment: steal the arrays, no copying.
+        // The moved-from graph is left with 0 vertices.
+        Graph(Graph&& other) noexcept;
+        Graph& operator=(Graph&& other) noexcept;
+
+        // Exchange the contents of two graphs in O(1)
+        void swap(Graph& other) noexcept;
+
+        // Add an isolated vertex and return its id (= the old number of vertices).
+        // The per-vertex arrays grow geometrically, so this is amortized O(1); existing adjacency
+        // arrays stay where they are, only the arrays of pointers / sizes are copied.
+        VertexId addVertex();
+
+        // Make room for 'count' vertices in total, so the next addVertex calls do not reallocate
+        void reserveVertices(VertexId count);
+
         // Add an undirected edge (default weight = 1)
-        void addEdge(int source, int dest, int weight = 1);
+        void addEdge(VertexId source, VertexId dest, Weight weight = 1);
+
+        // Add 'numEdges' undirected edges src[i]-dst[i] with weight weights[i] (weights may be nullptr => 1).
+        // Degrees are counted first so every adjacency array grows at most once.
+        // Invalid edges and loops are skipped with a single summary message.
+        void addEdges(const VertexId* src, const VertexId* dst, const Weight* weights, std::size_t numEdges);
+
+        // Remove an undirected edge (throw exception if it doesn't exist).
+        // Searches the shorter of the two lists; the other entry is found through its twin index.
+        // Removal swaps the last entry into the hole, so the order of a list can change.
+        void removeEdge(VertexId source, VertexId dest);
+
+        // Remove the undirected edge stored at getAdjList(vertex)[index] in O(1) (O(degree) when sorted)
+        void removeEdgeAt(VertexId vertex, int index);
+
+        // Keep every adjacency list sorted by destination from now on (false: back to append order).
+        // Turning it on sorts the current lists once (O(m log d)); then addEdge inserts at the
+        // sorted position and removals shift instead of swapping, both O(degree).
+        void setSortedAdjacency(bool sorted);
+        bool hasSortedAdjacency() const { return sortedAdjacency; }
 
-        // Remove an undirected edge (throw exception if it doesn't exist)
-        void removeEdge(int source, int dest);
+        // Edge lookup in the shorter of the two lists: O(log d) when sorted, O(d) otherwise
+        bool hasEdge(VertexId source, VertexId dest) const;
+
+        // Weight of the edge source-dest (throws if it doesn't exist)
+        Weight edgeWeight(VertexId source, VertexId dest) const;
+
+        // Number of common neighbors of 'u' and 'v' by merging their sorted lists; when one list is
+        // much longer (a hub) it is galloped through instead of scanned. Needs sorted adjacency.
+        std::size_t countCommonNeighbors(VertexId u, VertexId v) const;
 
         // Print adjacency list
         void printGraph() const;
 
+        // Pack all adjacency arrays into an immutable CSR snapshot (call again after mutations)
+        CsrGraph freeze() const;
+
+        // true if any edge weight is negative
+        using AdjacencyLists::hasNegativeWeight;
+
+        // Sum of all adjacency sizes (= 2 * number of undirected edges)
+        using AdjacencyLists::getNumAdjEntries;
+
         // Accessors
-        int getNumVertices() const { return numVertices; }
-        Edge* getAdjList(int vertex) const { return adjacencyList[vertex]; }
-        int getAdjSize(int vertex) const { return adjacencySizes[vertex]; }
+        using AdjacencyLists::getNumVertices;
+        using AdjacencyLists::getAdjList;
+        using AdjacencyLists::getAdjSize;
+        VertexId getVertexCapacity() const { return vertexCapacity; }
+        // Index of the reverse entry of getAdjList(vertex)[index] in its destination's list
+        int getTwinIndex(VertexId vertex, int index) const { return twinsOf(vertex)[index]; }
+
+        using AdjacencyLists::NeighborIterator;
+        using AdjacencyLists::neighbors;
     };
 
+    inline void swap(Graph& a, Graph& b) noexcept {
+        a.swap(b);
+    }
+
 } // namespace graph
 
 #endif
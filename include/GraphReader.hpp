@@ -0,0 +1,39 @@
+// email: yaacovkrawiec@gmail.com
+
+#ifndef GRAPHREADER_H
+#define GRAPHREADER_H
+
+#include "Graph.hpp"
+#include <cstddef>
+
+namespace graph {
+
+    // Loads text graph files straight into the bulk builder (Graph(n, src, dst, weights, m)).
+    // The file is memory-mapped, cut into chunks at line boundaries, and the chunks are parsed
+    // on several threads with a hand-written number parser (no iostreams).
+    //   EDGE_LIST      "u v [w]" per line, 0-based ids, '#' / '%' comments (SNAP); n = largest id + 1
+    //   MATRIX_MARKET  coordinate format: banner, "rows cols entries" line, then "i j [value]", 1-based
+    //   DIMACS         shortest-path .gr: "p sp n m", then "a u v w" lines, 1-based, 'c' comments
+    // Missing weights are 1; extra columns are ignored.
+    class GraphReader {
+    public:
+        enum Format { EDGE_LIST, MATRIX_MARKET, DIMACS };
+
+        // Format from the file extension: .mtx => MATRIX_MARKET, .gr => DIMACS, anything else => EDGE_LIST
+        static Format formatOf(const char* path);
+
+        // Graph is undirected and simple, so u-v and v-u (and repeated lines) are merged into one edge
+        // keeping the smallest weight. Pass removeDuplicates = false for files known to list every
+        // edge once; this skips a parallel sort of all edges.
+        // Throws if the file cannot be read or a line is malformed (the line number is printed to std::cerr).
+        static Graph read(const char* path);
+        static Graph read(const char* path, Format format, bool removeDuplicates = true);
+
+    private:
+        // Files smaller than this are parsed on one thread
+        static const std::size_t PARALLEL_PARSE_THRESHOLD = 1 << 20;
+    };
+
+} // namespace graph
+
+#endif
@@ -0,0 +1,102 @@
+// email: yaacovkrawiec@gmail.com
+
+#ifndef MAPPEDGRAPH_H
+#define MAPPEDGRAPH_H
+
+#include "Graph.hpp"
+#include "CsrGraph.hpp"
+#include "SoaCsrGraph.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace graph {
+
+    // Where the arrays of a graph file start (byte positions), as read from its header
+    struct GraphFileLayout {
+        std::uint64_t numVertices;
+        std::uint64_t numAdjEntries;
+        std::uint64_t offsetsPos;
+        std::uint64_t destinationsPos;
+        std::uint64_t weightsPos;
+        bool negativeWeights;
+    };
+
+    // Read-only graph backed by a memory-mapped binary CSR file.
+    // File layout (native byte order, every array starts on a 16-byte boundary):
+    //   header  - magic "GRPHCSR1", id / weight type sizes, numVertices, numAdjEntries, array positions
+    //   offsets - numVertices + 1 uint64 values
+    //   destinations - numAdjEntries VertexIds
+    //   weights - numAdjEntries Weights
+    // Opening a file only maps it: nothing is parsed or copied, pages are read on first touch,
+    // and every process that maps the same file shares one copy in the page cache.
+    // The file must be written by a build with the same VertexId / Weight types (checked on load).
+    class MappedGraph {
+    private:
+        VertexId numVertices;
+        std::size_t numAdjEntries;
+        const std::uint64_t* offsets;
+        const VertexId* destinations;
+        const Weight* weights;
+        bool negativeWeights;
+
+        void* mapping;
+        std::size_t mappingBytes;
+
+        void unmap();
+
+        template <typename G>
+        static void writeFile(const G& g, const char* path);
+
+    public:
+        // Map 'path' (throws if the file cannot be opened or is not a valid graph file)
+        explicit MappedGraph(const char* path);
+
+        // Destructor (unmaps the file)
+        ~MappedGraph();
+
+        // Not copyable: map the file again instead (the pages are shared anyway)
+        MappedGraph(const MappedGraph& other) = delete;
+        MappedGraph& operator=(const MappedGraph& other) = delete;
+
+        // Move constructor / move assignment (the moved-from graph has 0 vertices)
+        MappedGraph(MappedGraph&& other) noexcept;
+        MappedGraph& operator=(MappedGraph&& other) noexcept;
+
+        void swap(MappedGraph& other) noexcept;
+
+        // Write 'g' in the format above (throws if the file cannot be written)
+        static void write(const Graph& g, const char* path);
+        static void write(const CsrGraph& g, const char* path);
+        static void write(const SoaCsrGraph& g, const char* path);
+
+        // Reads and checks the header of the open file 'fd' against this build and the file size.
+        // Returns an error message, or nullptr and fills 'layout'. The arrays themselves are not read.
+        static const char* readLayout(int fd, GraphFileLayout& layout);
+
+        // Print adjacency list (same format as Graph::printGraph)
+        void printGraph() const;
+
+        // Stored in the header, so no scan is needed
+        bool hasNegativeWeight() const { return negativeWeights; }
+
+        // Accessors
+        VertexId getNumVertices() const { return numVertices; }
+        int getAdjSize(VertexId vertex) const { return static_cast<int>(offsets[vertex + 1] - offsets[vertex]); }
+        std::size_t getNumAdjEntries() const { return numAdjEntries; }
+        const VertexId* getDestinations(VertexId vertex) const { return destinations + offsets[vertex]; }
+        const Weight* getWeights(VertexId vertex) const { return weights + offsets[vertex]; }
+
+        typedef SoaEdgeIterator NeighborIterator;
+        NeighborIterator neighbors(VertexId vertex) const {
+            return NeighborIterator(destinations + offsets[vertex], destinations + offsets[vertex + 1],
+                                    weights + offsets[vertex]);
+        }
+    };
+
+    inline void swap(MappedGraph& a, MappedGraph& b) noexcept {
+        a.swap(b);
+    }
+
+} // namespace graph
+
+#endif
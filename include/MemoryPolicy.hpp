@@ -0,0 +1,64 @@
+// email: yaacovkrawiec@gmail.com
+
+#ifndef MEMORYPOLICY_H
+#define MEMORYPOLICY_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+namespace graph {
+
+    // Process-wide policy for the large arrays: CSR / SoA / compressed snapshots, the slab chunks
+    // holding Graph adjacency arrays, and the work arrays of the algorithms (dist, parent, visited).
+    // Arrays of HUGE_PAGE_BYTES or more are mapped with mmap (whole 2 MB pages, 2 MB aligned);
+    // smaller ones come from operator new as before. The policy applies to arrays allocated after set().
+    //   Pages:     DEFAULT_PAGES - whatever the kernel does (THP "always" / "madvise" / "never")
+    //              SMALL_PAGES - madvise(MADV_NOHUGEPAGE)
+    //              TRANSPARENT_HUGE_PAGES - madvise(MADV_HUGEPAGE)
+    //              HUGETLB_PAGES - MAP_HUGETLB from the reserved pool (vm.nr_hugepages);
+    //                              falls back to transparent huge pages when the pool is empty
+    //   Placement: FIRST_TOUCH - node of the thread that writes a page first (kernel default)
+    //              INTERLEAVED - pages round-robin over all NUMA nodes (mbind MPOL_INTERLEAVE)
+    //              PARTITIONED - the array is cut into one contiguous part per node (MPOL_PREFERRED)
+    // NUMA placement uses the mbind system call directly (no libnuma) and is skipped on one node.
+    class MemoryPolicy {
+    public:
+        enum Pages { DEFAULT_PAGES, SMALL_PAGES, TRANSPARENT_HUGE_PAGES, HUGETLB_PAGES };
+        enum Placement { FIRST_TOUCH, INTERLEAVED, PARTITIONED };
+
+        static const std::size_t HUGE_PAGE_BYTES = std::size_t(2) << 20;
+
+        static void set(Pages pages, Placement placement);
+        static Pages getPages();
+        static Placement getPlacement();
+
+        // Online NUMA nodes (from /sys/devices/system/node/online; 1 if unknown)
+        static int getNumNodes();
+
+        // How many HUGETLB_PAGES allocations found no reserved pages and used THP instead
+        static unsigned long getHugeTlbFallbacks();
+
+        // Raw memory under the current policy (throws std::bad_alloc).
+        // release() must get the same 'bytes'; it does not depend on the policy in effect.
+        static void* allocate(std::size_t bytes);
+        static void release(void* block, std::size_t bytes);
+
+        // Uninitialized arrays of trivial types (replacement for new T[count] / delete[])
+        template <typename T>
+        static T* allocateArray(std::size_t count) {
+            static_assert(std::is_trivial<T>::value, "MemoryPolicy arrays hold trivial types only");
+            if(count > static_cast<std::size_t>(-1) / sizeof(T)) {
+                throw std::bad_alloc();
+            }
+            return static_cast<T*>(allocate(count * sizeof(T)));
+        }
+        template <typename T>
+        static void releaseArray(T* array, std::size_t count) {
+            release(array, count * sizeof(T));
+        }
+    };
+
+} // namespace graph
+
+#endif
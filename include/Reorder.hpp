@@ -0,0 +1,78 @@
+// email: yaacovkrawiec@gmail.com
+
+#ifndef REORDER_H
+#define REORDER_H
+
+#include "Graph.hpp"
+#include <cstddef>
+
+namespace graph {
+
+    // A graph relabeled for locality together with both directions of the permutation:
+    //   getNewId(v) - id of original vertex v in getGraph()
+    //   getOldId(v) - original id of vertex v of getGraph()
+    class Reordering {
+    private:
+        Graph graph;
+        VertexId* newIds;
+        VertexId* oldIds;
+
+    public:
+        // Takes ownership of both arrays (length = number of vertices)
+        Reordering(Graph&& relabeled, VertexId* newIdArray, VertexId* oldIdArray);
+
+        // Destructor
+        ~Reordering();
+
+        // Copy constructor / assignment
+        Reordering(const Reordering& other);
+        Reordering& operator=(const Reordering& other);
+
+        // Move constructor / move assignment (the moved-from reordering has 0 vertices)
+        Reordering(Reordering&& other) noexcept;
+        Reordering& operator=(Reordering&& other) noexcept;
+
+        void swap(Reordering& other) noexcept;
+
+        // Relabel a graph over the new ids (e.g. a BFS tree of getGraph()) back to the original ids
+        Graph toOriginalIds(const Graph& result) const;
+
+        // Accessors
+        const Graph& getGraph() const { return graph; }
+        Graph& getGraph() { return graph; }
+        VertexId getNumVertices() const { return graph.getNumVertices(); }
+        VertexId getNewId(VertexId oldId) const { return newIds[oldId]; }
+        VertexId getOldId(VertexId newId) const { return oldIds[newId]; }
+        const VertexId* getNewIds() const { return newIds; }
+        const VertexId* getOldIds() const { return oldIds; }
+    };
+
+    inline void swap(Reordering& a, Reordering& b) noexcept {
+        a.swap(b);
+    }
+
+    // Vertex orderings that put vertices used together at nearby ids, so a traversal touches
+    // fewer cache lines / pages. Edges and weights are unchanged, only the ids move.
+    //   DEGREE_DESC - highest degree first (hubs share the first cache lines)
+    //   BFS_ORDER   - order in which BFS from vertex 0 (then each unreached vertex) visits them
+    //   RCM         - Reverse Cuthill-McKee: BFS from a peripheral vertex, neighbors by increasing
+    //                 degree, reversed; keeps neighbor ids close (small bandwidth)
+    //   GORDER      - greedy Gorder: the next id goes to the vertex with the most neighbors and
+    //                 common neighbors among the last GORDER_WINDOW placed vertices
+    class Reorder {
+    public:
+        enum Strategy { DEGREE_DESC, BFS_ORDER, RCM, GORDER };
+
+        static const int GORDER_WINDOW = 5;
+
+        // Relabeled copy of 'g' plus the permutation
+        static Reordering reorder(const Graph& g, Strategy strategy);
+
+        // Copy of 'g' where vertex v becomes newId[v], with sorted adjacency (see Graph::setSortedAdjacency).
+        // Throws if newId is not a permutation of 0..n-1.
+        static Graph relabel(const Graph& g, const VertexId* newId);
+    };
+
+} // namespace graph
+
+#endif
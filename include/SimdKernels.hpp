@@ -0,0 +1,32 @@
+// email: yaacovkrawiec@gmail.com
+
+#ifndef SIMDKERNELS_H
+#define SIMDKERNELS_H
+
+#include <cstddef>
+
+namespace graph {
+namespace simd {
+
+    // Small vectorized scans over contiguous arrays.
+    // On x86 the AVX2 version is picked at runtime when the CPU has it (SSE2 otherwise);
+    // other targets use the plain loops.
+
+    // true if any of values[0..count-1] is < 0
+    bool anyNegative(const int* values, std::size_t count);
+
+    // Smallest and largest of values[0..count-1] (count must be > 0)
+    void minMax(const int* values, std::size_t count, int& minOut, int& maxOut);
+
+    // values[0] + ... + values[count-1], accumulated in 64 bits
+    long long sum(const int* values, std::size_t count);
+
+    // Index of the smallest of values[0..count-1] (the first one on ties; count must be > 0).
+    // The distance arrays of the O(V^2) Dijkstra / Prim: AVX-512 or AVX2 when the CPU has them.
+    std::size_t argmin(const long long* values, std::size_t count);
+    std::size_t argmin(const double* values, std::size_t count);
+
+} // namespace simd
+} // namespace graph
+
+#endif
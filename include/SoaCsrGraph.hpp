@@ -0,0 +1,90 @@
+// email: yaacovkrawiec@gmail.com
+
+#ifndef SOACSRGRAPH_H
+#define SOACSRGRAPH_H
+
+#include "Graph.hpp"
+#include "CsrGraph.hpp"
+#include <cstddef>
+
+namespace graph {
+
+    // Walks the neighbors of one vertex in a structure-of-arrays layout.
+    // Weights live in their own array and are only read when weight() is called.
+    class SoaEdgeIterator {
+    private:
+        const VertexId* dest;
+        const VertexId* destEnd;
+        const Weight* w;
+    public:
+        SoaEdgeIterator(const VertexId* destBegin, const VertexId* destEnd_, const Weight* weightBegin)
+            : dest(destBegin), destEnd(destEnd_), w(weightBegin) {}
+        bool done() const { return dest == destEnd; }
+        void next() { ++dest; ++w; }
+        VertexId destination() const { return *dest; }
+        Weight weight() const { return *w; }
+    };
+
+    // Immutable CSR snapshot with separate destination and weight arrays.
+    // Traversals that only follow edges (BFS/DFS) never load the weights,
+    // and whole-graph weight scans run over one contiguous array (vectorized for int weights, see SimdKernels.hpp).
+    class SoaCsrGraph {
+    private:
+        VertexId numVertices;
+        std::size_t* offsets; // numVertices + 1 entries (nullptr once moved from)
+        VertexId* destinations; // offsets[numVertices] entries
+        Weight* weights;      // offsets[numVertices] entries
+
+        template <typename G>
+        void build(const G& g);
+
+        // Give the arrays back to MemoryPolicy
+        void release();
+
+    public:
+        explicit SoaCsrGraph(const Graph& g);
+        explicit SoaCsrGraph(const CsrGraph& g);
+
+        // Destructor
+        ~SoaCsrGraph();
+
+        // Copy constructor / assignment operator
+        SoaCsrGraph(const SoaCsrGraph& other);
+        SoaCsrGraph& operator=(const SoaCsrGraph& other);
+
+        // Move constructor / move assignment (the moved-from snapshot has 0 vertices)
+        SoaCsrGraph(SoaCsrGraph&& other) noexcept;
+        SoaCsrGraph& operator=(SoaCsrGraph&& other) noexcept;
+
+        void swap(SoaCsrGraph& other) noexcept;
+
+        // Print adjacency list (same format as Graph::printGraph)
+        void printGraph() const;
+
+        // true if any edge weight is negative
+        bool hasNegativeWeight() const;
+
+        // Smallest / largest edge weight. Returns false if there are no edges.
+        bool weightRange(Weight& minWeight, Weight& maxWeight) const;
+
+        // Accessors
+        VertexId getNumVertices() const { return numVertices; }
+        int getAdjSize(VertexId vertex) const { return static_cast<int>(offsets[vertex + 1] - offsets[vertex]); }
+        std::size_t getNumAdjEntries() const { return offsets != nullptr ? offsets[numVertices] : 0; }
+        const VertexId* getDestinations(VertexId vertex) const { return destinations + offsets[vertex]; }
+        const Weight* getWeights(VertexId vertex) const { return weights + offsets[vertex]; }
+
+        typedef SoaEdgeIterator NeighborIterator;
+        NeighborIterator neighbors(VertexId vertex) const {
+            return NeighborIterator(destinations + offsets[vertex], destinations + offsets[vertex + 1],
+                                    weights + offsets[vertex]);
+        }
+    };
+
+    inline void swap(SoaCsrGraph& a, SoaCsrGraph& b) noexcept {
+        a.swap(b);
+    }
+
+} // namespace graph
+
+#endif
@@ -0,0 +1,123 @@
+// email: yaacovkrawiec@gmail.com
+
+#ifndef TRAVERSALWORKSPACE_H
+#define TRAVERSALWORKSPACE_H
+
+#include "Types.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace graph {
+
+    // Per-thread scratch space for many small bfs / dfs / dijkstra queries. The arrays are kept
+    // between queries and only grow; a vertex belongs to the current query when its stamp equals
+    // the query's epoch, so starting a query is O(1) instead of clearing O(n) visited flags.
+    // A query therefore costs O(reached vertices + their edges). Its answer stays readable
+    // until the next query on the same workspace.
+    class TraversalWorkspace {
+    public:
+        struct HeapEntry {
+            Distance dist;
+            VertexId vertex;
+        };
+
+    private:
+        VertexId capacity;           // vertices the arrays can hold
+        std::uint32_t* stamps;       // stamps[v] == epoch: v was reached by the current query
+        std::uint32_t epoch;
+        VertexId* parent;
+        VertexId* depth;
+        Distance* dist;
+        Weight* parentWeight;
+        bool* settled;               // dijkstra: dist[v] is final
+        VertexId* order;             // reached vertices, in the order they were reached
+        VertexId numReached;
+        VertexId source;
+        HeapEntry* heap;             // dijkstra's binary heap (stale entries are skipped on pop)
+        std::size_t heapCapacity;
+        std::size_t heapSize;
+
+        void release();
+        void grow(VertexId numberOfVertices);
+        void growHeap();
+
+        void stamp(VertexId vertex) {
+            stamps[vertex] = epoch;
+            settled[vertex] = false;
+            order[numReached++] = vertex;
+        }
+
+    public:
+        // Arrays for 'numberOfVertices' up front (they grow on demand anyway)
+        explicit TraversalWorkspace(VertexId numberOfVertices = 0);
+
+        // Destructor
+        ~TraversalWorkspace();
+
+        // Not copyable: every thread keeps its own
+        TraversalWorkspace(const TraversalWorkspace& other) = delete;
+        TraversalWorkspace& operator=(const TraversalWorkspace& other) = delete;
+
+        // Move constructor / move assignment (the moved-from workspace is empty)
+        TraversalWorkspace(TraversalWorkspace&& other) noexcept;
+        TraversalWorkspace& operator=(TraversalWorkspace&& other) noexcept;
+
+        void swap(TraversalWorkspace& other) noexcept;
+
+        // ----- Used by Algorithms
+
+        // New query on a graph of 'numberOfVertices': forgets the previous one in O(1)
+        // (O(n) only when the arrays grow, or once every 2^32 queries when the epoch wraps)
+        void begin(VertexId numberOfVertices, VertexId sourceVertex);
+
+        // bfs / dfs: 'vertex' reached from 'from' over an edge of weight 'weight'
+        void reach(VertexId vertex, VertexId from, Weight weight) {
+            stamp(vertex);
+            parent[vertex] = from;
+            depth[vertex] = depth[from] + 1;
+            dist[vertex] = extendPath(dist[from], weight);
+            parentWeight[vertex] = weight;
+        }
+
+        // dijkstra: a shorter path to 'vertex' whose last edge is from - vertex
+        void relax(VertexId vertex, Distance distance, VertexId from, Weight weight) {
+            if(stamps[vertex] != epoch) {
+                stamp(vertex);
+            }
+            dist[vertex] = distance;
+            parent[vertex] = from;
+            depth[vertex] = depth[from] + 1;
+            parentWeight[vertex] = weight;
+        }
+        void settle(VertexId vertex) { settled[vertex] = true; }
+        bool isSettled(VertexId vertex) const { return stamps[vertex] == epoch && settled[vertex]; }
+
+        void pushHeap(VertexId vertex, Distance distance);
+        HeapEntry popHeap();
+        bool isHeapEmpty() const { return heapSize == 0; }
+
+        // ----- Answer of the last query
+
+        bool isReached(VertexId vertex) const { return stamps[vertex] == epoch; }
+
+        // NO_VERTEX / infiniteDistance() for vertices the query did not reach.
+        // After bfs / dfs the distance is the weight of the tree path.
+        VertexId getParent(VertexId vertex) const { return isReached(vertex) ? parent[vertex] : NO_VERTEX; }
+        VertexId getDepth(VertexId vertex) const { return isReached(vertex) ? depth[vertex] : NO_VERTEX; }
+        Distance getDistance(VertexId vertex) const { return isReached(vertex) ? dist[vertex] : infiniteDistance(); }
+        Weight getParentWeight(VertexId vertex) const { return isReached(vertex) ? parentWeight[vertex] : Weight(); }
+
+        // The reached vertices in the order they were reached (BFS order for bfs)
+        const VertexId* getReached() const { return order; }
+        VertexId getNumReached() const { return numReached; }
+        VertexId getSource() const { return source; }
+        VertexId getCapacity() const { return capacity; }
+    };
+
+    inline void swap(TraversalWorkspace& a, TraversalWorkspace& b) noexcept {
+        a.swap(b);
+    }
+
+} // namespace graph
+
+#endif
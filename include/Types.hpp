@@ -0,0 +1,88 @@
+// email: yaacovkrawiec@gmail.com
+
+#ifndef TYPES_H
+#define TYPES_H
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+// Edge weight type of the whole library, chosen at build time
+// (e.g. make WEIGHT_TYPE=uint16_t, or -DGRAPH_WEIGHT_TYPE=double).
+#ifndef GRAPH_WEIGHT_TYPE
+#define GRAPH_WEIGHT_TYPE int
+#endif
+
+// Vertex id type, also chosen at build time: uint16_t packs small graphs tighter,
+// int64_t / uint64_t allow more than 2^31 vertices (e.g. make VERTEX_TYPE=uint32_t).
+#ifndef GRAPH_VERTEX_TYPE
+#define GRAPH_VERTEX_TYPE int
+#endif
+
+namespace graph {
+
+    typedef GRAPH_WEIGHT_TYPE Weight;
+    typedef GRAPH_VERTEX_TYPE VertexId;
+
+    // Sums of weights (path lengths) use a wider type so long paths do not overflow:
+    // 64-bit integers for integral weights, double for floating point weights.
+#ifdef GRAPH_DISTANCE_TYPE
+    typedef GRAPH_DISTANCE_TYPE Distance;
+#else
+    typedef std::conditional<std::is_floating_point<Weight>::value, double, long long>::type Distance;
+#endif
+
+    // Distance of a vertex that has not been reached (infinity for floating point distances,
+    // so that a path of length max() is still shorter)
+    inline Distance infiniteDistance() {
+        return std::numeric_limits<Distance>::has_infinity ? std::numeric_limits<Distance>::infinity()
+                                                            : std::numeric_limits<Distance>::max();
+    }
+
+    static_assert(std::is_arithmetic<Weight>::value, "GRAPH_WEIGHT_TYPE must be an arithmetic type");
+    static_assert(!std::is_integral<Weight>::value
+                  || std::numeric_limits<Distance>::digits >= std::numeric_limits<Weight>::digits,
+                  "Distance must hold every Weight value");
+    static_assert(std::is_integral<VertexId>::value, "GRAPH_VERTEX_TYPE must be an integer type");
+
+    // Length of a path of length 'd' extended by an edge of weight 'w'. Integer lengths saturate at
+    // infiniteDistance() instead of overflowing (Distance may be no wider than Weight, e.g. int64_t),
+    // so a path that long counts as unreachable.
+    inline Distance extendPath(Distance d, Weight w) {
+        if(!std::numeric_limits<Distance>::has_infinity && d > Distance(0) && w > Weight(0)
+           && static_cast<Distance>(w) > infiniteDistance() - d) {
+            return infiniteDistance();
+        }
+        return d + static_cast<Distance>(w);
+    }
+
+    // 'w < 0' without "comparison is always false" warnings for unsigned weight types
+    template <typename T, bool Signed = std::numeric_limits<T>::is_signed>
+    struct NegativeCheck {
+        static bool test(T value) { return value < T(0); }
+    };
+    template <typename T>
+    struct NegativeCheck<T, false> {
+        static bool test(T) { return false; }
+    };
+
+    inline bool isNegativeWeight(Weight w) {
+        return NegativeCheck<Weight>::test(w);
+    }
+
+    // "No vertex" (e.g. the parent of a tree root): -1, or the largest value for unsigned ids
+    const VertexId NO_VERTEX = static_cast<VertexId>(-1);
+
+    // 0 <= v < numVertices, without the 'v >= 0' warning for unsigned ids
+    inline bool isValidVertex(VertexId v, VertexId numVertices) {
+        return !NegativeCheck<VertexId>::test(v) && v < numVertices;
+    }
+
+    // Promotes 8-bit weights so that they print as numbers instead of characters
+    inline decltype(+Weight()) printableWeight(Weight w) {
+        return +w;
+    }
+
+} // namespace graph
+
+#endif
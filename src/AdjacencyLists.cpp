@@ -0,0 +1,212 @@
+// email: yaacovkrawiec@gmail.com
+
+#include "../include/AdjacencyLists.hpp"
+#include "../include/SimdKernels.hpp"
+#include <cstdlib>
+#include <cstring>
+
+namespace graph {
+
+    AdjacencyLists::AdjacencyLists(std::size_t entryPayloadBytes)
+        : numVertices(0), vertexCapacity(0), adjacencyList(nullptr), adjacencySizes(nullptr),
+          adjacencyCapacities(nullptr), allocator(new SlabAllocator()), payloadBytes(entryPayloadBytes)
+    {
+    }
+
+    AdjacencyLists::AdjacencyLists(VertexId numberOfVertices, BlockAllocator* edgeAllocator, std::size_t entryPayloadBytes)
+        : numVertices(numberOfVertices), vertexCapacity(numberOfVertices), allocator(edgeAllocator),
+          payloadBytes(entryPayloadBytes)
+    {
+        if(NegativeCheck<VertexId>::test(numVertices)) {
+            std::cerr << "Number of vertices must not be negative.\n";
+            std::exit(1);
+        }
+
+        // No vertices: the arrays stay null, as in the default constructor
+        if(numVertices == 0) {
+            adjacencyList = nullptr;
+            adjacencySizes = nullptr;
+            adjacencyCapacities = nullptr;
+            return;
+        }
+
+        // Allocate arrays
+        adjacencyList = new Edge*[numVertices];
+        adjacencySizes = new int[numVertices];
+        adjacencyCapacities = new int[numVertices];
+
+        // Initialize
+        for(VertexId i = 0; i < numVertices; i++) {
+            adjacencyList[i] = nullptr;
+            adjacencySizes[i] = 0;
+            adjacencyCapacities[i] = 0;
+        }
+    }
+
+    AdjacencyLists::~AdjacencyLists() {
+        // The allocator frees every adjacency sub-array at once
+        delete allocator;
+        delete[] adjacencyList;
+
+        // Free arrays
+        delete[] adjacencySizes;
+        delete[] adjacencyCapacities;
+    }
+
+    // Copy constructor (the copy has no spare vertex capacity)
+    AdjacencyLists::AdjacencyLists(const AdjacencyLists& other)
+        : numVertices(other.numVertices), vertexCapacity(other.numVertices),
+          allocator(other.allocator != nullptr ? other.allocator->clone() : new SlabAllocator()),
+          payloadBytes(other.payloadBytes)
+    {
+        adjacencyList = new Edge*[numVertices];
+        adjacencySizes = new int[numVertices];
+        adjacencyCapacities = new int[numVertices];
+
+        for(VertexId i = 0; i < numVertices; i++) {
+            adjacencySizes[i] = other.adjacencySizes[i];
+            adjacencyCapacities[i] = other.adjacencyCapacities[i];
+
+            adjacencyList[i] = static_cast<Edge*>(allocator->allocate(blockBytes(adjacencyCapacities[i])));
+            for(int j = 0; j < adjacencySizes[i]; j++) {
+                adjacencyList[i][j] = other.adjacencyList[i][j];
+            }
+            if(adjacencySizes[i] > 0) {
+                std::memcpy(payloadOf(i), other.payloadOf(i), adjacencySizes[i] * payloadBytes);
+            }
+        }
+    }
+
+    // Move constructor
+    AdjacencyLists::AdjacencyLists(AdjacencyLists&& other) noexcept
+        : numVertices(other.numVertices), vertexCapacity(other.vertexCapacity), adjacencyList(other.adjacencyList),
+          adjacencySizes(other.adjacencySizes), adjacencyCapacities(other.adjacencyCapacities),
+          allocator(other.allocator), payloadBytes(other.payloadBytes)
+    {
+        other.numVertices = 0;
+        other.vertexCapacity = 0;
+        other.adjacencyList = nullptr;
+        other.adjacencySizes = nullptr;
+        other.adjacencyCapacities = nullptr;
+        other.allocator = nullptr;
+    }
+
+    void AdjacencyLists::swap(AdjacencyLists& other) noexcept {
+        VertexId tmpVertices = numVertices;
+        numVertices = other.numVertices;
+        other.numVertices = tmpVertices;
+
+        VertexId tmpCapacity = vertexCapacity;
+        vertexCapacity = other.vertexCapacity;
+        other.vertexCapacity = tmpCapacity;
+
+        Edge** tmpList = adjacencyList;
+        adjacencyList = other.adjacencyList;
+        other.adjacencyList = tmpList;
+
+        int* tmpSizes = adjacencySizes;
+        adjacencySizes = other.adjacencySizes;
+        other.adjacencySizes = tmpSizes;
+
+        int* tmpCaps = adjacencyCapacities;
+        adjacencyCapacities = other.adjacencyCapacities;
+        other.adjacencyCapacities = tmpCaps;
+
+        BlockAllocator* tmpAllocator = allocator;
+        allocator = other.allocator;
+        other.allocator = tmpAllocator;
+
+        std::size_t tmpPayload = payloadBytes;
+        payloadBytes = other.payloadBytes;
+        other.payloadBytes = tmpPayload;
+    }
+
+    void AdjacencyLists::growVertexArrays(VertexId newCapacity) {
+        Edge** newList = new Edge*[newCapacity];
+        int* newSizes = new int[newCapacity];
+        int* newCaps = new int[newCapacity];
+        for(VertexId v = 0; v < numVertices; v++) {
+            newList[v] = adjacencyList[v];
+            newSizes[v] = adjacencySizes[v];
+            newCaps[v] = adjacencyCapacities[v];
+        }
+        for(VertexId v = numVertices; v < newCapacity; v++) {
+            newList[v] = nullptr;
+            newSizes[v] = 0;
+            newCaps[v] = 0;
+        }
+        delete[] adjacencyList;
+        delete[] adjacencySizes;
+        delete[] adjacencyCapacities;
+        adjacencyList = newList;
+        adjacencySizes = newSizes;
+        adjacencyCapacities = newCaps;
+        vertexCapacity = newCapacity;
+    }
+
+    void AdjacencyLists::expandEdgeList(VertexId vertex) {
+        int oldCap = adjacencyCapacities[vertex];
+        resizeEdgeList(vertex, (oldCap == 0) ? 2 : oldCap * 2);
+    }
+
+    void AdjacencyLists::resizeEdgeList(VertexId vertex, int newCap) {
+        int oldCap = adjacencyCapacities[vertex];
+        int size = adjacencySizes[vertex];
+        Edge* newArray = static_cast<Edge*>(allocator->allocate(blockBytes(newCap)));
+        for(int i = 0; i < size; i++) {
+            newArray[i] = adjacencyList[vertex][i];
+        }
+        if(size > 0) {
+            std::memcpy(newArray + newCap, payloadOf(vertex), size * payloadBytes);
+        }
+
+        // The old block goes back to the allocator's free list for reuse
+        allocator->deallocate(adjacencyList[vertex], blockBytes(oldCap));
+        adjacencyList[vertex] = newArray;
+        adjacencyCapacities[vertex] = newCap;
+    }
+
+    bool AdjacencyLists::checkNewEdge(VertexId source, VertexId dest, Weight weight) const {
+        if(!isValidVertex(source, numVertices) || !isValidVertex(dest, numVertices)) {
+            std::cerr << "Invalid vertex.\n";
+            return false;
+        }
+        if(source == dest) {
+            std::cerr << "Simple graph: no loops allowed.\n";
+            return false;
+        }
+        // For Dijkstra (or BFS/DFS), if negative is not allowed, we might just warn or throw
+        if(isNegativeWeight(weight)) {
+            std::cerr << "Warning: negative edge weight. Dijkstra may fail if used.\n";
+        }
+        return true;
+    }
+
+    void AdjacencyLists::printLists(const char* title, const char* separator) const {
+        std::cout << title << "\n";
+        for(VertexId v = 0; v < numVertices; v++) {
+            std::cout << "Vertex " << v << separator;
+            for(int i = 0; i < adjacencySizes[v]; i++) {
+                std::cout << "(" << adjacencyList[v][i].destination
+                          << ", w=" << printableWeight(adjacencyList[v][i].weight) << ") ";
+            }
+            std::cout << "\n";
+        }
+    }
+
+    bool AdjacencyLists::hasNegativeWeight() const {
+        for(VertexId v = 0; v < numVertices; v++) {
+            for(int i = 0; i < adjacencySizes[v]; i++) {
+                if(isNegativeWeight(adjacencyList[v][i].weight)) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    std::size_t AdjacencyLists::getNumAdjEntries() const {
+        return static_cast<std::size_t>(simd::sum(adjacencySizes, numVertices));
+    }
+
+} // namespace graph
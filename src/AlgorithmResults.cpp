@@ -0,0 +1,422 @@
+// email: yaacovkrawiec@gmail.com
+
+#include "../include/AlgorithmResults.hpp"
+#include "../include/MemoryPolicy.hpp"
+#include <utility>
+
+namespace graph {
+
+    template <typename T>
+    static T* copyArray(const T* source, std::size_t count) {
+        T* copy = MemoryPolicy::allocateArray<T>(count);
+        for(std::size_t i = 0; i < count; i++) {
+            copy[i] = source[i];
+        }
+        return copy;
+    }
+
+    // Tree edges parent[v] - v of every vertex that has a parent, built with one addEdges call
+    static Graph treeGraph(VertexId n, const VertexId* parent, const Weight* parentWeight) {
+        std::size_t count = 0;
+        for(VertexId v = 0; v < n; v++) {
+            if(parent[v] != NO_VERTEX) {
+                count++;
+            }
+        }
+        VertexId* src = MemoryPolicy::allocateArray<VertexId>(count);
+        VertexId* dst = MemoryPolicy::allocateArray<VertexId>(count);
+        Weight* weights = MemoryPolicy::allocateArray<Weight>(count);
+        std::size_t e = 0;
+        for(VertexId v = 0; v < n; v++) {
+            if(parent[v] != NO_VERTEX) {
+                src[e] = parent[v];
+                dst[e] = v;
+                weights[e] = parentWeight[v];
+                e++;
+            }
+        }
+        Graph tree(n, src, dst, weights, count);
+        MemoryPolicy::releaseArray(src, count);
+        MemoryPolicy::releaseArray(dst, count);
+        MemoryPolicy::releaseArray(weights, count);
+        return tree;
+    }
+
+    static DirectedGraph directedTreeGraph(VertexId n, const VertexId* parent, const Weight* parentWeight) {
+        DirectedGraph tree(n);
+        for(VertexId v = 0; v < n; v++) {
+            if(parent[v] != NO_VERTEX) {
+                tree.addEdge(parent[v], v, parentWeight[v]);
+            }
+        }
+        return tree;
+    }
+
+    // ----- BfsResult
+
+    BfsResult::BfsResult(VertexId numberOfVertices, VertexId sourceVertex)
+        : numVertices(numberOfVertices), source(sourceVertex), numReached(0)
+    {
+        parent = MemoryPolicy::allocateArray<VertexId>(numVertices);
+        depth = MemoryPolicy::allocateArray<VertexId>(numVertices);
+        parentWeight = MemoryPolicy::allocateArray<Weight>(numVertices);
+        for(VertexId v = 0; v < numVertices; v++) {
+            parent[v] = NO_VERTEX;
+            depth[v] = NO_VERTEX;
+            parentWeight[v] = Weight();
+        }
+        if(isValidVertex(source, numVertices)) {
+            depth[source] = 0;
+            numReached = 1;
+        }
+    }
+
+    BfsResult::BfsResult(VertexId numberOfVertices, VertexId sourceVertex, VertexId reachedCount,
+                         VertexId* parents, VertexId* depths, Weight* parentWeights)
+        : numVertices(numberOfVertices), source(sourceVertex), numReached(reachedCount),
+          parent(parents), depth(depths), parentWeight(parentWeights)
+    {
+    }
+
+    BfsResult::~BfsResult() {
+        MemoryPolicy::releaseArray(parent, numVertices);
+        MemoryPolicy::releaseArray(depth, numVertices);
+        MemoryPolicy::releaseArray(parentWeight, numVertices);
+    }
+
+    // Copy constructor
+    BfsResult::BfsResult(const BfsResult& other)
+        : numVertices(other.numVertices), source(other.source), numReached(other.numReached),
+          parent(nullptr), depth(nullptr), parentWeight(nullptr)
+    {
+        parent = copyArray(other.parent, numVertices);
+        depth = copyArray(other.depth, numVertices);
+        parentWeight = copyArray(other.parentWeight, numVertices);
+    }
+
+    // operator= (copy-and-swap)
+    BfsResult& BfsResult::operator=(const BfsResult& other) {
+        if(this != &other) {
+            BfsResult copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    // Move constructor
+    BfsResult::BfsResult(BfsResult&& other) noexcept
+        : numVertices(other.numVertices), source(other.source), numReached(other.numReached),
+          parent(other.parent), depth(other.depth), parentWeight(other.parentWeight)
+    {
+        other.numVertices = 0;
+        other.numReached = 0;
+        other.parent = nullptr;
+        other.depth = nullptr;
+        other.parentWeight = nullptr;
+    }
+
+    // Move assignment
+    BfsResult& BfsResult::operator=(BfsResult&& other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    void BfsResult::swap(BfsResult& other) noexcept {
+        std::swap(numVertices, other.numVertices);
+        std::swap(source, other.source);
+        std::swap(numReached, other.numReached);
+        std::swap(parent, other.parent);
+        std::swap(depth, other.depth);
+        std::swap(parentWeight, other.parentWeight);
+    }
+
+    Graph BfsResult::toGraph() const {
+        return treeGraph(numVertices, parent, parentWeight);
+    }
+
+    DirectedGraph BfsResult::toDirectedGraph() const {
+        return directedTreeGraph(numVertices, parent, parentWeight);
+    }
+
+    // ----- SsspResult
+
+    SsspResult::SsspResult(VertexId numberOfVertices, VertexId sourceVertex)
+        : numVertices(numberOfVertices), source(sourceVertex)
+    {
+        dist = MemoryPolicy::allocateArray<Distance>(numVertices);
+        parent = MemoryPolicy::allocateArray<VertexId>(numVertices);
+        parentWeight = MemoryPolicy::allocateArray<Weight>(numVertices);
+        for(VertexId v = 0; v < numVertices; v++) {
+            dist[v] = infiniteDistance();
+            parent[v] = NO_VERTEX;
+            parentWeight[v] = Weight();
+        }
+        if(isValidVertex(source, numVertices)) {
+            dist[source] = 0;
+        }
+    }
+
+    SsspResult::~SsspResult() {
+        MemoryPolicy::releaseArray(dist, numVertices);
+        MemoryPolicy::releaseArray(parent, numVertices);
+        MemoryPolicy::releaseArray(parentWeight, numVertices);
+    }
+
+    // Copy constructor
+    SsspResult::SsspResult(const SsspResult& other)
+        : numVertices(other.numVertices), source(other.source), dist(nullptr), parent(nullptr), parentWeight(nullptr)
+    {
+        dist = copyArray(other.dist, numVertices);
+        parent = copyArray(other.parent, numVertices);
+        parentWeight = copyArray(other.parentWeight, numVertices);
+    }
+
+    // operator= (copy-and-swap)
+    SsspResult& SsspResult::operator=(const SsspResult& other) {
+        if(this != &other) {
+            SsspResult copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    // Move constructor
+    SsspResult::SsspResult(SsspResult&& other) noexcept
+        : numVertices(other.numVertices), source(other.source), dist(other.dist), parent(other.parent),
+          parentWeight(other.parentWeight)
+    {
+        other.numVertices = 0;
+        other.dist = nullptr;
+        other.parent = nullptr;
+        other.parentWeight = nullptr;
+    }
+
+    // Move assignment
+    SsspResult& SsspResult::operator=(SsspResult&& other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    void SsspResult::swap(SsspResult& other) noexcept {
+        std::swap(numVertices, other.numVertices);
+        std::swap(source, other.source);
+        std::swap(dist, other.dist);
+        std::swap(parent, other.parent);
+        std::swap(parentWeight, other.parentWeight);
+    }
+
+    Graph SsspResult::toGraph() const {
+        return treeGraph(numVertices, parent, parentWeight);
+    }
+
+    DirectedGraph SsspResult::toDirectedGraph() const {
+        return directedTreeGraph(numVertices, parent, parentWeight);
+    }
+
+    // ----- MstResult
+
+    MstResult::MstResult(VertexId numberOfVertices)
+        : numVertices(numberOfVertices), numEdges(0), totalWeight(0)
+    {
+        capacity = numVertices > 1 ? static_cast<std::size_t>(numVertices) - 1 : 0;
+        edges = MemoryPolicy::allocateArray<WeightedEdge>(capacity);
+    }
+
+    MstResult::~MstResult() {
+        MemoryPolicy::releaseArray(edges, capacity);
+    }
+
+    // Copy constructor
+    MstResult::MstResult(const MstResult& other)
+        : numVertices(other.numVertices), edges(nullptr), capacity(other.capacity), numEdges(other.numEdges),
+          totalWeight(other.totalWeight)
+    {
+        edges = MemoryPolicy::allocateArray<WeightedEdge>(capacity);
+        for(std::size_t i = 0; i < numEdges; i++) {
+            edges[i] = other.edges[i];
+        }
+    }
+
+    // operator= (copy-and-swap)
+    MstResult& MstResult::operator=(const MstResult& other) {
+        if(this != &other) {
+            MstResult copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    // Move constructor
+    MstResult::MstResult(MstResult&& other) noexcept
+        : numVertices(other.numVertices), edges(other.edges), capacity(other.capacity), numEdges(other.numEdges),
+          totalWeight(other.totalWeight)
+    {
+        other.numVertices = 0;
+        other.edges = nullptr;
+        other.capacity = 0;
+        other.numEdges = 0;
+        other.totalWeight = 0;
+    }
+
+    // Move assignment
+    MstResult& MstResult::operator=(MstResult&& other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    void MstResult::swap(MstResult& other) noexcept {
+        std::swap(numVertices, other.numVertices);
+        std::swap(edges, other.edges);
+        std::swap(capacity, other.capacity);
+        std::swap(numEdges, other.numEdges);
+        std::swap(totalWeight, other.totalWeight);
+    }
+
+    Graph MstResult::toGraph() const {
+        VertexId* src = MemoryPolicy::allocateArray<VertexId>(numEdges);
+        VertexId* dst = MemoryPolicy::allocateArray<VertexId>(numEdges);
+        Weight* weights = MemoryPolicy::allocateArray<Weight>(numEdges);
+        for(std::size_t i = 0; i < numEdges; i++) {
+            src[i] = edges[i].u;
+            dst[i] = edges[i].v;
+            weights[i] = edges[i].w;
+        }
+        Graph tree(numVertices, src, dst, weights, numEdges);
+        MemoryPolicy::releaseArray(src, numEdges);
+        MemoryPolicy::releaseArray(dst, numEdges);
+        MemoryPolicy::releaseArray(weights, numEdges);
+        return tree;
+    }
+
+    // ----- MultiSourceBfsResult
+
+    MultiSourceBfsResult::MultiSourceBfsResult(VertexId numberOfVertices, const VertexId* sourceVertices, std::size_t sourceCount)
+        : numVertices(numberOfVertices), numSources(sourceCount)
+    {
+        std::size_t cells = numSources * static_cast<std::size_t>(numVertices);
+        sources = copyArray(sourceVertices, numSources);
+        depth = MemoryPolicy::allocateArray<VertexId>(cells);
+        numReached = MemoryPolicy::allocateArray<VertexId>(numSources);
+        depthSum = MemoryPolicy::allocateArray<Distance>(numSources);
+        for(std::size_t i = 0; i < cells; i++) {
+            depth[i] = NO_VERTEX;
+        }
+        for(std::size_t i = 0; i < numSources; i++) {
+            numReached[i] = 0;
+            depthSum[i] = 0;
+            if(isValidVertex(sources[i], numVertices)) {
+                reach(i, sources[i], 0);
+            }
+        }
+    }
+
+    MultiSourceBfsResult::~MultiSourceBfsResult() {
+        MemoryPolicy::releaseArray(sources, numSources);
+        MemoryPolicy::releaseArray(depth, numSources * static_cast<std::size_t>(numVertices));
+        MemoryPolicy::releaseArray(numReached, numSources);
+        MemoryPolicy::releaseArray(depthSum, numSources);
+    }
+
+    // Copy constructor
+    MultiSourceBfsResult::MultiSourceBfsResult(const MultiSourceBfsResult& other)
+        : numVertices(other.numVertices), numSources(other.numSources), sources(nullptr), depth(nullptr),
+          numReached(nullptr), depthSum(nullptr)
+    {
+        sources = copyArray(other.sources, numSources);
+        depth = copyArray(other.depth, numSources * static_cast<std::size_t>(numVertices));
+        numReached = copyArray(other.numReached, numSources);
+        depthSum = copyArray(other.depthSum, numSources);
+    }
+
+    // operator= (copy-and-swap)
+    MultiSourceBfsResult& MultiSourceBfsResult::operator=(const MultiSourceBfsResult& other) {
+        if(this != &other) {
+            MultiSourceBfsResult copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    // Move constructor
+    MultiSourceBfsResult::MultiSourceBfsResult(MultiSourceBfsResult&& other) noexcept
+        : numVertices(other.numVertices), numSources(other.numSources), sources(other.sources), depth(other.depth),
+          numReached(other.numReached), depthSum(other.depthSum)
+    {
+        other.numVertices = 0;
+        other.numSources = 0;
+        other.sources = nullptr;
+        other.depth = nullptr;
+        other.numReached = nullptr;
+        other.depthSum = nullptr;
+    }
+
+    // Move assignment
+    MultiSourceBfsResult& MultiSourceBfsResult::operator=(MultiSourceBfsResult&& other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    void MultiSourceBfsResult::swap(MultiSourceBfsResult& other) noexcept {
+        std::swap(numVertices, other.numVertices);
+        std::swap(numSources, other.numSources);
+        std::swap(sources, other.sources);
+        std::swap(depth, other.depth);
+        std::swap(numReached, other.numReached);
+        std::swap(depthSum, other.depthSum);
+    }
+
+    // ----- HopPathResult
+
+    HopPathResult::HopPathResult(VertexId hops, bool withPath)
+        : distance(hops), path(nullptr), pathLength(0)
+    {
+        if(withPath && hops != NO_VERTEX) {
+            pathLength = static_cast<std::size_t>(hops) + 1;
+            path = MemoryPolicy::allocateArray<VertexId>(pathLength);
+        }
+    }
+
+    HopPathResult::~HopPathResult() {
+        MemoryPolicy::releaseArray(path, pathLength);
+    }
+
+    // Copy constructor
+    HopPathResult::HopPathResult(const HopPathResult& other)
+        : distance(other.distance), path(nullptr), pathLength(other.pathLength)
+    {
+        if(other.path != nullptr) {
+            path = copyArray(other.path, pathLength);
+        }
+    }
+
+    // operator= (copy-and-swap)
+    HopPathResult& HopPathResult::operator=(const HopPathResult& other) {
+        if(this != &other) {
+            HopPathResult copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    // Move constructor
+    HopPathResult::HopPathResult(HopPathResult&& other) noexcept
+        : distance(other.distance), path(other.path), pathLength(other.pathLength)
+    {
+        other.distance = NO_VERTEX;
+        other.path = nullptr;
+        other.pathLength = 0;
+    }
+
+    // Move assignment
+    HopPathResult& HopPathResult::operator=(HopPathResult&& other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    void HopPathResult::swap(HopPathResult& other) noexcept {
+        std::swap(distance, other.distance);
+        std::swap(path, other.path);
+        std::swap(pathLength, other.pathLength);
+    }
+
+} // namespace graph
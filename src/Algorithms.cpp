@@ -1,135 +1,866 @@
 // email: yaacovkrawiec@gmail.com
 
 #include "../include/Algorithms.hpp"
-#include <limits> // For numeric_limits<int>::max()
+#include "../include/CsrGraph.hpp"
+#include "../include/SoaCsrGraph.hpp"
+#include "../include/CompressedGraph.hpp"
+#include "../include/DirectedGraph.hpp"
+#include "../include/MappedGraph.hpp"
+#include "../include/DeltaGraph.hpp"
+#include "../include/DenseGraph.hpp"
+#include "../include/ExternalGraph.hpp"
+#include "../include/AlgorithmResults.hpp"
+#include "../include/TraversalWorkspace.hpp"
+#include "../include/SimdKernels.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <unistd.h>
+#include "../include/MemoryPolicy.hpp"
 
 namespace graph {
 
     //A simple array-based queue for BFS
     class ArrayQueue {
     private:
-        int* data;
-        int front;
-        int rear;
+        VertexId* data;
+        std::size_t capacity;
+        std::size_t front;
+        std::size_t rear;
     
     public:
-        // We keep the constructor parameter 'cap' because we use it in new int[cap]
-        ArrayQueue(int cap) : front(0), rear(0) {
-            data = new int[cap];
+        // We keep the constructor parameter 'cap' because we use it to allocate 'data'
+        ArrayQueue(std::size_t cap) : capacity(cap), front(0), rear(0) {
+            data = MemoryPolicy::allocateArray<VertexId>(cap);
         }
         ~ArrayQueue() {
-            delete[] data;
+            MemoryPolicy::releaseArray(data, capacity);
         }
         bool isEmpty() const {
             return (front == rear);
         }
-        void enqueue(int val) {
+        void enqueue(VertexId val) {
             data[rear++] = val;
         }
-        int dequeue() {
+        VertexId dequeue() {
             return data[front++];
         }
     };
 
-    // BFS
-    Graph Algorithms::bfs(const Graph& g, int startVertex) {
-        int n = g.getNumVertices();
-        Graph bfsTree(n);
-
-        bool* visited = new bool[n];
-        for(int i = 0; i < n; i++) {
-            visited[i] = false;
+    // Every search throws on a start vertex outside the graph (the workspace forms through TraversalWorkspace::begin)
+    static void checkStartVertex(VertexId startVertex, VertexId numVertices) {
+        if(!isValidVertex(startVertex, numVertices)) {
+            throw "Invalid start vertex.";
         }
+    }
+
+    // BFS (G is any graph type with getNumVertices() and neighbors(v))
+    template <typename G>
+    static BfsResult bfsImpl(const G& g, VertexId startVertex) {
+        checkStartVertex(startVertex, g.getNumVertices());
+        BfsResult result(g.getNumVertices(), startVertex);
 
-        ArrayQueue queue(n*2); // We pass n*2 as capacity
-        visited[startVertex] = true;
+        ArrayQueue queue(g.getNumVertices()); // every vertex is enqueued at most once
         queue.enqueue(startVertex);
 
         while(!queue.isEmpty()) {
-            int u = queue.dequeue();
+            VertexId u = queue.dequeue();
             // Explore adjacency
-            int adjSize = g.getAdjSize(u);
-            Edge* edges = g.getAdjList(u);
-
-            for(int i = 0; i < adjSize; i++) {
-                int v = edges[i].destination;
-                if(!visited[v]) {
-                    visited[v] = true;
-                    // Add edge to BFS tree
-                    bfsTree.addEdge(u, v, edges[i].weight);
+            for(typename G::NeighborIterator it = g.neighbors(u); !it.done(); it.next()) {
+                VertexId v = it.destination();
+                if(!result.isReached(v)) {
+                    result.reach(v, u, it.weight());
                     queue.enqueue(v);
                 }
             }
         }
+        return result;
+    }
+
+    // Level-synchronous BFS: every level is one pass over the file in vertex order, reading only
+    // the lists of the frontier (the blocks between them are skipped). Memory: the result and two flags per vertex.
+    // Same levels as bfsImpl; a vertex's parent is the lowest-numbered frontier vertex next to it.
+    static BfsResult externalBfs(const ExternalGraph& g, VertexId startVertex) {
+        VertexId n = g.getNumVertices();
+        checkStartVertex(startVertex, n);
+        BfsResult result(n, startVertex);
+
+        bool* frontier = MemoryPolicy::allocateArray<bool>(n);
+        bool* nextFrontier = MemoryPolicy::allocateArray<bool>(n);
+        for(VertexId i = 0; i < n; i++) {
+            frontier[i] = false;
+            nextFrontier[i] = false;
+        }
+        frontier[startVertex] = true;
+
+        ExternalScanner scanner(g);
+        bool more = true;
+        while(more) {
+            more = false;
+            for(VertexId u = 0; u < n; u++) {
+                if(!frontier[u]) {
+                    continue;
+                }
+                frontier[u] = false;
+                for(scanner.open(u); !scanner.done(); scanner.next()) {
+                    VertexId v = scanner.destination();
+                    if(!result.isReached(v)) {
+                        result.reach(v, u, scanner.weight());
+                        nextFrontier[v] = true;
+                        more = true;
+                    }
+                }
+            }
+            bool* tmp = frontier; // all false again
+            frontier = nextFrontier;
+            nextFrontier = tmp;
+        }
+
+        MemoryPolicy::releaseArray(frontier, n);
+        MemoryPolicy::releaseArray(nextFrontier, n);
+        return result;
+    }
+
+    // The search behind bfs / bfsResult: an ExternalGraph streams its file level by level
+    template <typename G>
+    static BfsResult bfsOf(const G& g, VertexId startVertex) {
+        return bfsImpl(g, startVertex);
+    }
+
+    static BfsResult bfsOf(const ExternalGraph& g, VertexId startVertex) {
+        return externalBfs(g, startVertex);
+    }
+
+    // Each family below is defined once and expanded for every graph type of its list (Algorithms.hpp)
+#define GRAPH_DEFINE_BFS(G) \
+    Graph Algorithms::bfs(const G& g, VertexId startVertex) { \
+        return bfsOf(g, startVertex).toGraph(); \
+    } \
+    BfsResult Algorithms::bfsResult(const G& g, VertexId startVertex) { \
+        return bfsOf(g, startVertex); \
+    }
+    GRAPH_UNDIRECTED_TYPES(GRAPH_DEFINE_BFS)
+    GRAPH_DEFINE_BFS(ExternalGraph)
+#undef GRAPH_DEFINE_BFS
+
+    DirectedGraph Algorithms::bfs(const DirectedGraph& g, VertexId startVertex) {
+        return bfsImpl(g, startVertex).toDirectedGraph();
+    }
+
+    BfsResult Algorithms::bfsResult(const DirectedGraph& g, VertexId startVertex) {
+        return bfsImpl(g, startVertex);
+    }
+
+    // BFS in a workspace: its list of reached vertices doubles as the queue
+    template <typename G>
+    static VertexId bfsInWorkspace(const G& g, VertexId startVertex, TraversalWorkspace& workspace, VertexId target) {
+        workspace.begin(g.getNumVertices(), startVertex);
+        if(startVertex == target) {
+            return 1;
+        }
+        const VertexId* queue = workspace.getReached();
+        for(VertexId head = 0; head < workspace.getNumReached(); head++) {
+            VertexId u = queue[head];
+            for(typename G::NeighborIterator it = g.neighbors(u); !it.done(); it.next()) {
+                VertexId v = it.destination();
+                if(!workspace.isReached(v)) {
+                    workspace.reach(v, u, it.weight());
+                    if(v == target) {
+                        return workspace.getNumReached();
+                    }
+                }
+            }
+        }
+        return workspace.getNumReached();
+    }
+
+#define GRAPH_DEFINE_BFS_IN_WORKSPACE(G) \
+    VertexId Algorithms::bfs(const G& g, VertexId startVertex, TraversalWorkspace& workspace, VertexId target) { \
+        return bfsInWorkspace(g, startVertex, workspace, target); \
+    }
+    GRAPH_IN_MEMORY_TYPES(GRAPH_DEFINE_BFS_IN_WORKSPACE)
+#undef GRAPH_DEFINE_BFS_IN_WORKSPACE
+
+    // ----- Direction-optimizing BFS
+
+    // Edges a bottom-up step looks through for a parent: the neighbors of an undirected graph,
+    // the in-edges of a directed one
+    template <typename G>
+    struct IncomingEdges {
+        static typename G::NeighborIterator of(const G& g, VertexId vertex) { return g.neighbors(vertex); }
+    };
+    template <>
+    struct IncomingEdges<DirectedGraph> {
+        static DirectedGraph::NeighborIterator of(const DirectedGraph& g, VertexId vertex) { return g.inNeighbors(vertex); }
+    };
+
+    inline bool testBit(const std::uint64_t* bits, VertexId v) {
+        return ((bits[v / 64] >> (v % 64)) & 1) != 0;
+    }
+
+    // The frontier is always kept as a list; while going bottom-up it is also a bitmap
+    template <typename G>
+    static BfsResult directionOptimizingImpl(const G& g, VertexId startVertex) {
+        VertexId n = g.getNumVertices();
+        checkStartVertex(startVertex, n);
+        BfsResult result(n, startVertex);
+
+        std::size_t words = (static_cast<std::size_t>(n) + 63) / 64;
+        VertexId* frontier = MemoryPolicy::allocateArray<VertexId>(n);
+        VertexId* next = MemoryPolicy::allocateArray<VertexId>(n);
+        std::uint64_t* frontierBits = MemoryPolicy::allocateArray<std::uint64_t>(words);
+        std::uint64_t* nextBits = MemoryPolicy::allocateArray<std::uint64_t>(words);
+
+        frontier[0] = startVertex;
+        VertexId frontierSize = 1;
+        VertexId previousSize = 0;
+        std::size_t frontierEdges = static_cast<std::size_t>(g.getAdjSize(startVertex));
+        std::size_t unexploredEdges = g.getNumAdjEntries() - frontierEdges;
+        bool bottomUp = false;
+
+        while(frontierSize > 0) {
+            if(!bottomUp && frontierEdges > unexploredEdges / Algorithms::BOTTOM_UP_ALPHA) {
+                bottomUp = true;
+                for(std::size_t i = 0; i < words; i++) {
+                    frontierBits[i] = 0;
+                }
+                for(VertexId i = 0; i < frontierSize; i++) {
+                    frontierBits[frontier[i] / 64] |= std::uint64_t(1) << (frontier[i] % 64);
+                }
+            } else if(bottomUp && frontierSize < previousSize && frontierSize < n / Algorithms::TOP_DOWN_BETA) {
+                bottomUp = false;
+            }
+
+            VertexId nextSize = 0;
+            std::size_t nextEdges = 0;
+            if(bottomUp) {
+                for(std::size_t i = 0; i < words; i++) {
+                    nextBits[i] = 0;
+                }
+                for(VertexId v = 0; v < n; v++) {
+                    if(result.isReached(v)) {
+                        continue;
+                    }
+                    // The first frontier vertex found is the parent; the rest of the list is skipped
+                    for(typename G::NeighborIterator it = IncomingEdges<G>::of(g, v); !it.done(); it.next()) {
+                        if(testBit(frontierBits, it.destination())) {
+                            result.reach(v, it.destination(), it.weight());
+                            nextBits[v / 64] |= std::uint64_t(1) << (v % 64);
+                            next[nextSize++] = v;
+                            nextEdges += static_cast<std::size_t>(g.getAdjSize(v));
+                            break;
+                        }
+                    }
+                }
+                std::uint64_t* tmpBits = frontierBits;
+                frontierBits = nextBits;
+                nextBits = tmpBits;
+            } else {
+                for(VertexId i = 0; i < frontierSize; i++) {
+                    VertexId u = frontier[i];
+                    for(typename G::NeighborIterator it = g.neighbors(u); !it.done(); it.next()) {
+                        VertexId v = it.destination();
+                        if(!result.isReached(v)) {
+                            result.reach(v, u, it.weight());
+                            next[nextSize++] = v;
+                            nextEdges += static_cast<std::size_t>(g.getAdjSize(v));
+                        }
+                    }
+                }
+            }
+
+            VertexId* tmp = frontier;
+            frontier = next;
+            next = tmp;
+            previousSize = frontierSize;
+            frontierSize = nextSize;
+            frontierEdges = nextEdges;
+            unexploredEdges -= nextEdges;
+        }
+
+        MemoryPolicy::releaseArray(frontier, n);
+        MemoryPolicy::releaseArray(next, n);
+        MemoryPolicy::releaseArray(frontierBits, words);
+        MemoryPolicy::releaseArray(nextBits, words);
+        return result;
+    }
+
+#define GRAPH_DEFINE_DIRECTION_OPTIMIZING_BFS(G) \
+    BfsResult Algorithms::directionOptimizingBfs(const G& g, VertexId startVertex) { \
+        return directionOptimizingImpl(g, startVertex); \
+    }
+    GRAPH_IN_MEMORY_TYPES(GRAPH_DEFINE_DIRECTION_OPTIMIZING_BFS)
+#undef GRAPH_DEFINE_DIRECTION_OPTIMIZING_BFS
+
+    // ----- Parallel BFS
+
+    // Entries [from, to) of a vertex's list. Lists stored in an array can be cut anywhere, so the
+    // workers share a hub's edges; the other types only hand out whole lists.
+    template <typename G>
+    struct ListSlice {
+        static const bool splittable = false;
+        static typename G::NeighborIterator of(const G& g, VertexId vertex, std::size_t, std::size_t) {
+            return g.neighbors(vertex);
+        }
+    };
+    template <typename G>
+    struct EdgeArraySlice {
+        static const bool splittable = true;
+        static EdgeIterator of(const G& g, VertexId vertex, std::size_t from, std::size_t to) {
+            const Edge* list = g.getAdjList(vertex);
+            return EdgeIterator(list + from, list + to);
+        }
+    };
+    template <typename G>
+    struct SoaArraySlice {
+        static const bool splittable = true;
+        static SoaEdgeIterator of(const G& g, VertexId vertex, std::size_t from, std::size_t to) {
+            const VertexId* destinations = g.getDestinations(vertex);
+            return SoaEdgeIterator(destinations + from, destinations + to, g.getWeights(vertex) + from);
+        }
+    };
+    template <> struct ListSlice<Graph> : EdgeArraySlice<Graph> {};
+    template <> struct ListSlice<CsrGraph> : EdgeArraySlice<CsrGraph> {};
+    template <> struct ListSlice<DirectedGraph> : EdgeArraySlice<DirectedGraph> {};
+    template <> struct ListSlice<SoaCsrGraph> : SoaArraySlice<SoaCsrGraph> {};
+    template <> struct ListSlice<MappedGraph> : SoaArraySlice<MappedGraph> {};
+
+    // A worker's next-frontier vertices (grows by doubling, kept from level to level)
+    class FrontierBuffer {
+    private:
+        VertexId* data;
+        std::size_t capacity;
+        std::size_t size;
+
+    public:
+        FrontierBuffer() : data(nullptr), capacity(0), size(0) {}
+        ~FrontierBuffer() {
+            delete[] data;
+        }
+        FrontierBuffer(const FrontierBuffer& other) = delete;
+        FrontierBuffer& operator=(const FrontierBuffer& other) = delete;
+
+        void push(VertexId vertex) {
+            if(size == capacity) {
+                std::size_t newCapacity = capacity < 256 ? 256 : capacity * 2;
+                VertexId* newData = new VertexId[newCapacity];
+                for(std::size_t i = 0; i < size; i++) {
+                    newData[i] = data[i];
+                }
+                delete[] data;
+                data = newData;
+                capacity = newCapacity;
+            }
+            data[size++] = vertex;
+        }
+        void clear() { size = 0; }
+        const VertexId* getData() const { return data; }
+        std::size_t getSize() const { return size; }
+    };
+
+    // Shared by the workers of one level. parent and depth are only touched through atomic builtins
+    // while the level runs; the joins at its end publish them to the next level.
+    template <typename G>
+    struct ParallelBfsLevel {
+        const G* g;
+        bool deterministic;
+        VertexId* parent;
+        VertexId* depth;
+        Weight* parentWeight;
+        const VertexId* frontier;
+        const std::size_t* prefix;   // prefix[i]: edges of frontier[0..i)
+        VertexId frontierSize;
+        VertexId level;              // depth of the frontier vertices
+        std::size_t numChunks;
+        std::atomic<std::size_t> nextChunk;
+        FrontierBuffer* buffers;     // one per worker
+    };
+
+    template <typename G>
+    static void parallelVisit(ParallelBfsLevel<G>& state, FrontierBuffer& out, VertexId u, VertexId v, Weight w) {
+        VertexId d = __atomic_load_n(&state.depth[v], __ATOMIC_RELAXED);
+        if(d != NO_VERTEX && (!state.deterministic || d <= state.level)) {
+            return;
+        }
+        VertexId current = NO_VERTEX;
+        if(__atomic_compare_exchange_n(&state.parent[v], &current, u, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            // First claim: v joins this worker's next frontier
+            __atomic_store_n(&state.depth[v], state.level + 1, __ATOMIC_RELAXED);
+            state.parentWeight[v] = w;
+            out.push(v);
+            return;
+        }
+        if(state.deterministic) {
+            // Claimed on this level already: keep the smallest parent id
+            while(u < current &&
+                  !__atomic_compare_exchange_n(&state.parent[v], &current, u, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            }
+        }
+    }
+
+    template <typename G>
+    static void parallelBfsWorker(ParallelBfsLevel<G>* state, int worker) {
+        FrontierBuffer& out = state->buffers[worker];
+        const std::size_t* prefix = state->prefix;
+        VertexId size = state->frontierSize;
+        std::size_t totalEdges = prefix[size];
+        std::size_t chunkEdges = Algorithms::PARALLEL_BFS_CHUNK;
+
+        for(;;) {
+            std::size_t chunk = state->nextChunk.fetch_add(1);
+            if(chunk >= state->numChunks) {
+                break;
+            }
+            std::size_t lo = chunk * chunkEdges;
+            std::size_t hi = (totalEdges - lo < chunkEdges) ? totalEdges : lo + chunkEdges;
+
+            if(ListSlice<G>::splittable) {
+                // Every list overlapping [lo, hi), clipped to it
+                VertexId i = static_cast<VertexId>(std::upper_bound(prefix, prefix + size + 1, lo) - prefix - 1);
+                for(; i < size && prefix[i] < hi; i++) {
+                    std::size_t from = (lo > prefix[i] ? lo : prefix[i]) - prefix[i];
+                    std::size_t to = (hi < prefix[i + 1] ? hi : prefix[i + 1]) - prefix[i];
+                    VertexId u = state->frontier[i];
+                    for(typename G::NeighborIterator it = ListSlice<G>::of(*state->g, u, from, to); !it.done(); it.next()) {
+                        parallelVisit(*state, out, u, it.destination(), it.weight());
+                    }
+                }
+            } else {
+                // Every list starting in [lo, hi), whole
+                VertexId i = static_cast<VertexId>(std::lower_bound(prefix, prefix + size, lo) - prefix);
+                for(; i < size && prefix[i] < hi; i++) {
+                    VertexId u = state->frontier[i];
+                    for(typename G::NeighborIterator it = state->g->neighbors(u); !it.done(); it.next()) {
+                        parallelVisit(*state, out, u, it.destination(), it.weight());
+                    }
+                }
+            }
+        }
+    }
+
+    // Deterministic parents are only known once their level is over: take each one's edge weight
+    // from the first matching entry of the child's incoming list
+    template <typename G>
+    static void fillParentWeights(const G* g, const VertexId* reached, std::size_t first, std::size_t end,
+                                  const VertexId* parent, Weight* parentWeight) {
+        for(std::size_t i = first; i < end; i++) {
+            VertexId v = reached[i];
+            for(typename G::NeighborIterator it = IncomingEdges<G>::of(*g, v); !it.done(); it.next()) {
+                if(it.destination() == parent[v]) {
+                    parentWeight[v] = it.weight();
+                    break;
+                }
+            }
+        }
+    }
+
+    template <typename G>
+    static BfsResult parallelBfsImpl(const G& g, VertexId startVertex, bool deterministic, int numThreads) {
+        VertexId n = g.getNumVertices();
+        checkStartVertex(startVertex, n);
+        if(numThreads <= 0) {
+            numThreads = static_cast<int>(std::thread::hardware_concurrency());
+            if(numThreads < 1) {
+                numThreads = 1;
+            }
+        }
+        if(numThreads == 1 && !deterministic) {
+            // Nothing to share: the plain queue skips the atomics
+            return bfsImpl(g, startVertex);
+        }
+
+        VertexId* parent = MemoryPolicy::allocateArray<VertexId>(n);
+        VertexId* depth = MemoryPolicy::allocateArray<VertexId>(n);
+        Weight* parentWeight = MemoryPolicy::allocateArray<Weight>(n);
+        for(VertexId v = 0; v < n; v++) {
+            parent[v] = NO_VERTEX;
+            depth[v] = NO_VERTEX;
+            parentWeight[v] = Weight();
+        }
+        depth[startVertex] = 0;
+
+        // Every level is appended to 'reached', so the frontier is always its last level
+        VertexId* reached = MemoryPolicy::allocateArray<VertexId>(n);
+        std::size_t* prefix = MemoryPolicy::allocateArray<std::size_t>(static_cast<std::size_t>(n) + 1);
+        FrontierBuffer* buffers = new FrontierBuffer[numThreads];
+        std::thread* workers = new std::thread[numThreads];
+        reached[0] = startVertex;
+        std::size_t head = 0;
+        std::size_t tail = 1;
+
+        ParallelBfsLevel<G> state;
+        state.g = &g;
+        state.deterministic = deterministic;
+        state.parent = parent;
+        state.depth = depth;
+        state.parentWeight = parentWeight;
+        state.prefix = prefix;
+        state.buffers = buffers;
+        state.level = 0;
+        std::size_t chunkEdges = Algorithms::PARALLEL_BFS_CHUNK;
+
+        while(head < tail) {
+            state.frontier = reached + head;
+            state.frontierSize = static_cast<VertexId>(tail - head);
+            prefix[0] = 0;
+            for(VertexId i = 0; i < state.frontierSize; i++) {
+                prefix[i + 1] = prefix[i] + static_cast<std::size_t>(g.getAdjSize(state.frontier[i]));
+            }
+            std::size_t totalEdges = prefix[state.frontierSize];
+            state.numChunks = (totalEdges + chunkEdges - 1) / chunkEdges;
+            state.nextChunk = 0;
+
+            int levelThreads = 1;
+            if(totalEdges >= Algorithms::PARALLEL_BFS_THRESHOLD) {
+                levelThreads = state.numChunks < static_cast<std::size_t>(numThreads) ? static_cast<int>(state.numChunks) : numThreads;
+            }
+            for(int t = 0; t < levelThreads; t++) {
+                buffers[t].clear();
+            }
+            // The calling thread is worker 0
+            for(int t = 1; t < levelThreads; t++) {
+                workers[t] = std::thread(parallelBfsWorker<G>, &state, t);
+            }
+            parallelBfsWorker(&state, 0);
+            for(int t = 1; t < levelThreads; t++) {
+                workers[t].join();
+            }
+
+            head = tail;
+            for(int t = 0; t < levelThreads; t++) {
+                const VertexId* data = buffers[t].getData();
+                for(std::size_t i = 0; i < buffers[t].getSize(); i++) {
+                    reached[tail++] = data[i];
+                }
+            }
+            state.level++;
+        }
+
+        if(deterministic && tail > 1) {
+            // Build a DirectedGraph's in-edge index before the threads read it
+            IncomingEdges<G>::of(g, startVertex);
+            int fillThreads = g.getNumAdjEntries() >= Algorithms::PARALLEL_BFS_THRESHOLD ? numThreads : 1;
+            std::size_t count = tail - 1;
+            std::size_t perThread = count / fillThreads + 1;
+            for(int t = fillThreads - 1; t >= 0; t--) {
+                std::size_t first = 1 + (perThread * t < count ? perThread * t : count);
+                std::size_t end = 1 + (perThread * (t + 1) < count ? perThread * (t + 1) : count);
+                if(t == 0) {
+                    fillParentWeights(&g, reached, first, end, parent, parentWeight);
+                } else {
+                    workers[t] = std::thread(fillParentWeights<G>, &g, reached, first, end, parent, parentWeight);
+                }
+            }
+            for(int t = 1; t < fillThreads; t++) {
+                workers[t].join();
+            }
+        }
+
+        delete[] workers;
+        delete[] buffers;
+        MemoryPolicy::releaseArray(prefix, static_cast<std::size_t>(n) + 1);
+        MemoryPolicy::releaseArray(reached, n);
+        return BfsResult(n, startVertex, static_cast<VertexId>(tail), parent, depth, parentWeight);
+    }
 
-        delete[] visited;
-        return bfsTree;
+#define GRAPH_DEFINE_PARALLEL_BFS(G) \
+    BfsResult Algorithms::parallelBfs(const G& g, VertexId startVertex, bool deterministic, int numThreads) { \
+        return parallelBfsImpl(g, startVertex, deterministic, numThreads); \
     }
+    GRAPH_IN_MEMORY_TYPES(GRAPH_DEFINE_PARALLEL_BFS)
+#undef GRAPH_DEFINE_PARALLEL_BFS
+
+    // ----- Multi-source BFS
+
+    // One batch of up to 64 searches. Bit i of seen[v] says the i-th search of the batch has reached v,
+    // of visit[v] that v is on its frontier, of next[v] that v joins its next frontier. Only vertices
+    // with a non-zero mask are kept in the lists, so a level costs its frontier's edges however many
+    // searches share it.
+    template <typename G>
+    static void multiSourceBatch(const G& g, const VertexId* sources, std::size_t count,
+                                 std::size_t firstIndex, MultiSourceBfsResult& result) {
+        VertexId n = g.getNumVertices();
+        std::uint64_t* seen = MemoryPolicy::allocateArray<std::uint64_t>(n);
+        std::uint64_t* visit = MemoryPolicy::allocateArray<std::uint64_t>(n);
+        std::uint64_t* next = MemoryPolicy::allocateArray<std::uint64_t>(n);
+        VertexId* frontier = MemoryPolicy::allocateArray<VertexId>(n);
+        VertexId* touched = MemoryPolicy::allocateArray<VertexId>(n);
+        for(VertexId v = 0; v < n; v++) {
+            seen[v] = 0;
+            visit[v] = 0;
+            next[v] = 0;
+        }
+
+        VertexId frontierSize = 0;
+        for(std::size_t i = 0; i < count; i++) {
+            if(visit[sources[i]] == 0) {
+                frontier[frontierSize++] = sources[i];
+            }
+            visit[sources[i]] |= std::uint64_t(1) << i;
+            seen[sources[i]] |= std::uint64_t(1) << i;
+        }
+
+        VertexId level = 0;
+        while(frontierSize > 0) {
+            level++;
+            VertexId touchedSize = 0;
+            for(VertexId f = 0; f < frontierSize; f++) {
+                VertexId u = frontier[f];
+                std::uint64_t mask = visit[u];
+                for(typename G::NeighborIterator it = g.neighbors(u); !it.done(); it.next()) {
+                    VertexId v = it.destination();
+                    std::uint64_t bits = mask & ~seen[v];
+                    if(bits != 0) {
+                        if(next[v] == 0) {
+                            touched[touchedSize++] = v;
+                        }
+                        next[v] |= bits;
+                    }
+                }
+                // The old frontier's masks are the only non-zero words of visit, which becomes next
+                visit[u] = 0;
+            }
+            for(VertexId t = 0; t < touchedSize; t++) {
+                VertexId v = touched[t];
+                std::uint64_t bits = next[v];
+                seen[v] |= bits;
+                while(bits != 0) {
+                    result.reach(firstIndex + static_cast<std::size_t>(__builtin_ctzll(bits)), v, level);
+                    bits &= bits - 1;
+                }
+            }
+
+            std::uint64_t* tmpMasks = visit;
+            visit = next;
+            next = tmpMasks;
+            VertexId* tmp = frontier;
+            frontier = touched;
+            touched = tmp;
+            frontierSize = touchedSize;
+        }
+
+        MemoryPolicy::releaseArray(seen, n);
+        MemoryPolicy::releaseArray(visit, n);
+        MemoryPolicy::releaseArray(next, n);
+        MemoryPolicy::releaseArray(frontier, n);
+        MemoryPolicy::releaseArray(touched, n);
+    }
+
+    template <typename G>
+    static MultiSourceBfsResult multiSourceImpl(const G& g, const VertexId* sources, std::size_t numSources) {
+        VertexId n = g.getNumVertices();
+        for(std::size_t i = 0; i < numSources; i++) {
+            checkStartVertex(sources[i], n);
+        }
+        MultiSourceBfsResult result(n, sources, numSources);
+        std::size_t batch = Algorithms::MULTI_SOURCE_BATCH;
+        for(std::size_t first = 0; first < numSources; first += batch) {
+            std::size_t count = numSources - first < batch ? numSources - first : batch;
+            multiSourceBatch(g, sources + first, count, first, result);
+        }
+        return result;
+    }
+
+#define GRAPH_DEFINE_MULTI_SOURCE_BFS(G) \
+    MultiSourceBfsResult Algorithms::multiSourceBfs(const G& g, const VertexId* sources, std::size_t numSources) { \
+        return multiSourceImpl(g, sources, numSources); \
+    }
+    GRAPH_IN_MEMORY_TYPES(GRAPH_DEFINE_MULTI_SOURCE_BFS)
+#undef GRAPH_DEFINE_MULTI_SOURCE_BFS
+
+    // ----- Bidirectional BFS
+
+    // Expands the whole current level of 'side' (its vertices past 'levelStart' in reach order).
+    // Returns the first vertex the other side has reached too, or NO_VERTEX.
+    template <typename G, bool Backward>
+    static VertexId expandLevel(const G& g, TraversalWorkspace& side, const TraversalWorkspace& other,
+                                VertexId& levelStart) {
+        VertexId levelEnd = side.getNumReached();
+        const VertexId* queue = side.getReached();
+        for(VertexId i = levelStart; i < levelEnd; i++) {
+            VertexId u = queue[i];
+            typename G::NeighborIterator it = Backward ? IncomingEdges<G>::of(g, u) : g.neighbors(u);
+            for(; !it.done(); it.next()) {
+                VertexId v = it.destination();
+                if(!side.isReached(v)) {
+                    side.reach(v, u, it.weight());
+                    if(other.isReached(v)) {
+                        return v;
+                    }
+                }
+            }
+        }
+        levelStart = levelEnd;
+        return NO_VERTEX;
+    }
+
+    // Once the levels of both sides have been expanded fully and the sides first share a vertex,
+    // every shared vertex is on a shortest path, so the first one found is the meeting point
+    template <typename G>
+    static HopPathResult bidirectionalImpl(const G& g, VertexId source, VertexId target, TraversalWorkspace& forward,
+                                           TraversalWorkspace& backward, bool withPath) {
+        if(&forward == &backward) {
+            throw "The two workspaces must differ.";
+        }
+        VertexId n = g.getNumVertices();
+        forward.begin(n, source);
+        backward.begin(n, target);
+
+        VertexId meeting = source == target ? source : NO_VERTEX;
+        VertexId forwardStart = 0;
+        VertexId backwardStart = 0;
+        while(meeting == NO_VERTEX && forwardStart < forward.getNumReached() && backwardStart < backward.getNumReached()) {
+            if(forward.getNumReached() - forwardStart <= backward.getNumReached() - backwardStart) {
+                meeting = expandLevel<G, false>(g, forward, backward, forwardStart);
+            } else {
+                meeting = expandLevel<G, true>(g, backward, forward, backwardStart);
+            }
+        }
+        if(meeting == NO_VERTEX) {
+            return HopPathResult();
+        }
+
+        VertexId toMeeting = forward.getDepth(meeting);
+        HopPathResult result(toMeeting + backward.getDepth(meeting), withPath);
+        if(withPath) {
+            // source ... meeting from the forward parents, meeting ... target from the backward ones
+            VertexId v = meeting;
+            for(VertexId i = toMeeting + 1; i > 0; i--) {
+                result.setPathVertex(i - 1, v);
+                v = forward.getParent(v);
+            }
+            v = backward.getParent(meeting);
+            for(std::size_t i = static_cast<std::size_t>(toMeeting) + 1; i < result.getPathLength(); i++) {
+                result.setPathVertex(i, v);
+                v = backward.getParent(v);
+            }
+        }
+        return result;
+    }
+
+    template <typename G>
+    static HopPathResult bidirectionalImpl(const G& g, VertexId source, VertexId target, bool withPath) {
+        TraversalWorkspace forward(g.getNumVertices());
+        TraversalWorkspace backward(g.getNumVertices());
+        return bidirectionalImpl(g, source, target, forward, backward, withPath);
+    }
+
+#define GRAPH_DEFINE_BIDIRECTIONAL_BFS(G) \
+    HopPathResult Algorithms::bidirectionalBfs(const G& g, VertexId source, VertexId target, bool withPath) { \
+        return bidirectionalImpl(g, source, target, withPath); \
+    } \
+    HopPathResult Algorithms::bidirectionalBfs(const G& g, VertexId source, VertexId target, TraversalWorkspace& forward, \
+                                               TraversalWorkspace& backward, bool withPath) { \
+        return bidirectionalImpl(g, source, target, forward, backward, withPath); \
+    }
+    GRAPH_IN_MEMORY_TYPES(GRAPH_DEFINE_BIDIRECTIONAL_BFS)
+#undef GRAPH_DEFINE_BIDIRECTIONAL_BFS
 
     // ----- DFS (recursive)
-    static void dfsVisit(const Graph& g, Graph& dfsTree, int u, bool* visited) {
-        visited[u] = true;
-
-        int adjSize = g.getAdjSize(u);
-        Edge* edges = g.getAdjList(u);
-        for(int i = 0; i < adjSize; i++) {
-            int v = edges[i].destination;
-            if(!visited[v]) {
+    template <typename G>
+    static void dfsVisit(const G& g, DfsResult& result, VertexId u) {
+        for(typename G::NeighborIterator it = g.neighbors(u); !it.done(); it.next()) {
+            VertexId v = it.destination();
+            if(!result.isReached(v)) {
                 // Add edge in DFS tree
-                dfsTree.addEdge(u, v, edges[i].weight);
-                dfsVisit(g, dfsTree, v, visited);
+                result.reach(v, u, it.weight());
+                dfsVisit(g, result, v);
             }
         }
     }
 
-    Graph Algorithms::dfs(const Graph& g, int startVertex) {
-        int n = g.getNumVertices();
-        Graph dfsTree(n);
+    template <typename G>
+    static DfsResult dfsImpl(const G& g, VertexId startVertex) {
+        checkStartVertex(startVertex, g.getNumVertices());
+        DfsResult result(g.getNumVertices(), startVertex);
+        dfsVisit(g, result, startVertex);
+        return result;
+    }
 
-        bool* visited = new bool[n];
-        for(int i = 0; i < n; i++) {
-            visited[i] = false;
+#define GRAPH_DEFINE_DFS(G) \
+    Graph Algorithms::dfs(const G& g, VertexId startVertex) { \
+        return dfsImpl(g, startVertex).toGraph(); \
+    } \
+    DfsResult Algorithms::dfsResult(const G& g, VertexId startVertex) { \
+        return dfsImpl(g, startVertex); \
+    }
+    GRAPH_UNDIRECTED_TYPES(GRAPH_DEFINE_DFS)
+#undef GRAPH_DEFINE_DFS
+
+    DirectedGraph Algorithms::dfs(const DirectedGraph& g, VertexId startVertex) {
+        return dfsImpl(g, startVertex).toDirectedGraph();
+    }
+
+    DfsResult Algorithms::dfsResult(const DirectedGraph& g, VertexId startVertex) {
+        return dfsImpl(g, startVertex);
+    }
+
+    // true once 'target' is reached (the search stops there)
+    template <typename G>
+    static bool dfsVisit(const G& g, TraversalWorkspace& workspace, VertexId u, VertexId target) {
+        for(typename G::NeighborIterator it = g.neighbors(u); !it.done(); it.next()) {
+            VertexId v = it.destination();
+            if(!workspace.isReached(v)) {
+                workspace.reach(v, u, it.weight());
+                if(v == target || dfsVisit(g, workspace, v, target)) {
+                    return true;
+                }
+            }
         }
+        return false;
+    }
 
-        dfsVisit(g, dfsTree, startVertex, visited);
+    template <typename G>
+    static VertexId dfsInWorkspace(const G& g, VertexId startVertex, TraversalWorkspace& workspace, VertexId target) {
+        workspace.begin(g.getNumVertices(), startVertex);
+        if(startVertex != target) {
+            dfsVisit(g, workspace, startVertex, target);
+        }
+        return workspace.getNumReached();
+    }
 
-        delete[] visited;
-        return dfsTree;
+#define GRAPH_DEFINE_DFS_IN_WORKSPACE(G) \
+    VertexId Algorithms::dfs(const G& g, VertexId startVertex, TraversalWorkspace& workspace, VertexId target) { \
+        return dfsInWorkspace(g, startVertex, workspace, target); \
     }
+    GRAPH_IN_MEMORY_TYPES(GRAPH_DEFINE_DFS_IN_WORKSPACE)
+#undef GRAPH_DEFINE_DFS_IN_WORKSPACE
 
     //An array-based priority queue for Dijkstra/Prim
     struct PQItem {
-        int vertex;
-        int dist;
+        VertexId vertex;
+        Distance dist;
     };
 
     class ArrayMinPriorityQueue {
     private:
         PQItem* data;
-        int size;
+        std::size_t capacity;
+        std::size_t size;
     public:
         // Keep constructor param 'cap' to allocate 'data'
-        ArrayMinPriorityQueue(int cap) : size(0) {
-            data = new PQItem[cap];
+        ArrayMinPriorityQueue(std::size_t cap) : capacity(cap), size(0) {
+            data = MemoryPolicy::allocateArray<PQItem>(cap);
         }
         ~ArrayMinPriorityQueue() {
-            delete[] data;
+            MemoryPolicy::releaseArray(data, capacity);
         }
         bool isEmpty() const {
             return (size == 0);
         }
-        void push(int vertex, int distance) {
+        void push(VertexId vertex, Distance distance) {
             data[size].vertex = vertex;
             data[size].dist = distance;
             size++;
         }
         PQItem pop() {
             if(isEmpty()) {
-                return { -1, -1 };
+                return { NO_VERTEX, -1 };
             }
-            int minIndex = 0;
-            int minVal = data[0].dist;
-            for(int i = 1; i < size; i++) {
+            std::size_t minIndex = 0;
+            Distance minVal = data[0].dist;
+            for(std::size_t i = 1; i < size; i++) {
                 if(data[i].dist < minVal) {
                     minVal = data[i].dist;
                     minIndex = i;
@@ -140,8 +871,8 @@ namespace graph {
             size--;
             return result;
         }
-        void decreaseKey(int vertex, int newDist) {
-            for(int i = 0; i < size; i++) {
+        void decreaseKey(VertexId vertex, Distance newDist) {
+            for(std::size_t i = 0; i < size; i++) {
                 if(data[i].vertex == vertex) {
                     if(newDist < data[i].dist) {
                         data[i].dist = newDist;
@@ -150,8 +881,8 @@ namespace graph {
                 }
             }
         }
-        bool contains(int vertex) const {
-            for(int i = 0; i < size; i++) {
+        bool contains(VertexId vertex) const {
+            for(std::size_t i = 0; i < size; i++) {
                 if(data[i].vertex == vertex) {
                     return true;
                 }
@@ -161,105 +892,227 @@ namespace graph {
     };
 
     //Dijkstra with negative edge weight exception
-    Graph Algorithms::dijkstra(const Graph& g, int startVertex) {
-        int n = g.getNumVertices();
-        Graph tree(n);
-
+    template <typename G>
+    static SsspResult dijkstraImpl(const G& g, VertexId startVertex) {
+        checkStartVertex(startVertex, g.getNumVertices());
         // Check for negative edges first
-        for(int u = 0; u < n; u++) {
-            int sizeAdj = g.getAdjSize(u);
-            Edge* edges = g.getAdjList(u);
-            for(int i = 0; i < sizeAdj; i++) {
-                if(edges[i].weight < 0) {
-                    throw "Dijkstra does not support negative edge weights.";
-                }
-            }
+        if(g.hasNegativeWeight()) {
+            throw "Dijkstra does not support negative edge weights.";
         }
 
-        int* dist = new int[n];
-        bool* visited = new bool[n];
-        int* parent = new int[n];
-
-        for(int i = 0; i < n; i++) {
-            dist[i] = std::numeric_limits<int>::max();
+        VertexId n = g.getNumVertices();
+        SsspResult result(n, startVertex);
+        bool* visited = MemoryPolicy::allocateArray<bool>(n);
+        for(VertexId i = 0; i < n; i++) {
             visited[i] = false;
-            parent[i] = -1;
         }
-        dist[startVertex] = 0;
 
-        ArrayMinPriorityQueue pq(n*2);
+        ArrayMinPriorityQueue pq(n); // a vertex is never in the queue twice
         pq.push(startVertex, 0);
 
         while(!pq.isEmpty()) {
             PQItem item = pq.pop();
-            int u = item.vertex;
-            if(u == -1) break;
+            VertexId u = item.vertex;
+            if(u == NO_VERTEX) break;
             if(visited[u]) continue;
 
             visited[u] = true;
+            Distance du = result.getDistance(u);
 
-            int sizeAdj = g.getAdjSize(u);
-            Edge* edges = g.getAdjList(u);
-            for(int i = 0; i < sizeAdj; i++) {
-                int v = edges[i].destination;
-                int w = edges[i].weight;
+            for(typename G::NeighborIterator it = g.neighbors(u); !it.done(); it.next()) {
+                VertexId v = it.destination();
+                Weight w = it.weight();
 
-                // Relax
-                if(!visited[v] && dist[u] != std::numeric_limits<int>::max()
-                   && dist[u] + w < dist[v]) {
-                    dist[v] = dist[u] + w;
-                    parent[v] = u;
+                // Relax (a saturated length is never shorter than the current one)
+                Distance dv = extendPath(du, w);
+                if(!visited[v] && du != infiniteDistance() && dv < result.getDistance(v)) {
+                    result.relax(v, dv, u, w);
                     if(!pq.contains(v)) {
-                        pq.push(v, dist[v]);
+                        pq.push(v, dv);
                     } else {
-                        pq.decreaseKey(v, dist[v]);
+                        pq.decreaseKey(v, dv);
                     }
                 }
             }
         }
 
-        // Build the shortest path tree
-        for(int i = 0; i < n; i++) {
-            if(parent[i] != -1) {
-                int w = dist[i] - dist[parent[i]];
-                tree.addEdge(parent[i], i, w);
+        MemoryPolicy::releaseArray(visited, n);
+        return result;
+    }
+
+    // Vectorized for the built-in distance types, a plain scan otherwise
+    inline std::size_t argminOf(const long long* values, std::size_t count) {
+        return simd::argmin(values, count);
+    }
+    inline std::size_t argminOf(const double* values, std::size_t count) {
+        return simd::argmin(values, count);
+    }
+    template <typename T>
+    static std::size_t argminOf(const T* values, std::size_t count) {
+        std::size_t best = 0;
+        for(std::size_t i = 1; i < count; i++) {
+            if(values[i] < values[best]) {
+                best = i;
+            }
+        }
+        return best;
+    }
+
+    // Classic O(V^2) Dijkstra: every round takes the argmin of 'key' (the distance of the vertices
+    // not settled yet, infinity for the settled ones) and relaxes the row of the winner
+    static SsspResult denseDijkstra(const DenseGraph& g, VertexId startVertex) {
+        checkStartVertex(startVertex, g.getNumVertices());
+        if(g.hasNegativeWeight()) {
+            throw "Dijkstra does not support negative edge weights.";
+        }
+
+        VertexId n = g.getNumVertices();
+        SsspResult result(n, startVertex);
+        Distance* key = MemoryPolicy::allocateArray<Distance>(n);
+        bool* visited = MemoryPolicy::allocateArray<bool>(n);
+        for(VertexId i = 0; i < n; i++) {
+            key[i] = infiniteDistance();
+            visited[i] = false;
+        }
+        key[startVertex] = 0;
+
+        for(;;) {
+            VertexId u = static_cast<VertexId>(argminOf(key, n));
+            if(key[u] == infiniteDistance()) {
+                break; // the rest is unreachable
+            }
+            key[u] = infiniteDistance();
+            visited[u] = true;
+            Distance du = result.getDistance(u);
+            for(DenseGraph::NeighborIterator it = g.neighbors(u); !it.done(); it.next()) {
+                VertexId v = it.destination();
+                Distance dv = extendPath(du, it.weight());
+                if(!visited[v] && dv < result.getDistance(v)) {
+                    result.relax(v, dv, u, it.weight());
+                    key[v] = dv;
+                }
             }
         }
 
-        delete[] dist;
-        delete[] visited;
-        delete[] parent;
-        return tree;
+        MemoryPolicy::releaseArray(key, n);
+        MemoryPolicy::releaseArray(visited, n);
+        return result;
+    }
+
+    template <typename G>
+    static SsspResult autoDijkstra(const G& g, VertexId startVertex) {
+        if(DenseGraph::shouldConvert(g.getNumVertices(), g.getNumAdjEntries())) {
+            return denseDijkstra(DenseGraph(g), startVertex);
+        }
+        return dijkstraImpl(g, startVertex);
+    }
+
+    // The search behind dijkstra / dijkstraResult: the array scan on a DenseGraph, the heap on the
+    // other types (a Graph or CsrGraph that is dense enough converts first)
+    template <typename G>
+    static SsspResult dijkstraOf(const G& g, VertexId startVertex) {
+        return dijkstraImpl(g, startVertex);
+    }
+
+    static SsspResult dijkstraOf(const Graph& g, VertexId startVertex) {
+        return autoDijkstra(g, startVertex);
+    }
+
+    static SsspResult dijkstraOf(const CsrGraph& g, VertexId startVertex) {
+        return autoDijkstra(g, startVertex);
+    }
+
+    static SsspResult dijkstraOf(const DenseGraph& g, VertexId startVertex) {
+        return denseDijkstra(g, startVertex);
     }
 
+#define GRAPH_DEFINE_DIJKSTRA(G) \
+    Graph Algorithms::dijkstra(const G& g, VertexId startVertex) { \
+        return dijkstraOf(g, startVertex).toGraph(); \
+    } \
+    SsspResult Algorithms::dijkstraResult(const G& g, VertexId startVertex) { \
+        return dijkstraOf(g, startVertex); \
+    }
+    GRAPH_UNDIRECTED_TYPES(GRAPH_DEFINE_DIJKSTRA)
+#undef GRAPH_DEFINE_DIJKSTRA
+
+    DirectedGraph Algorithms::dijkstra(const DirectedGraph& g, VertexId startVertex) {
+        return dijkstraImpl(g, startVertex).toDirectedGraph();
+    }
+
+    SsspResult Algorithms::dijkstraResult(const DirectedGraph& g, VertexId startVertex) {
+        return dijkstraImpl(g, startVertex);
+    }
+
+    // Dijkstra in a workspace with a binary heap. A vertex may be pushed again when its distance
+    // drops; the outdated entries are skipped when they come out.
+    template <typename G>
+    static VertexId dijkstraInWorkspace(const G& g, VertexId startVertex, TraversalWorkspace& workspace, VertexId target) {
+        workspace.begin(g.getNumVertices(), startVertex);
+        workspace.pushHeap(startVertex, 0);
+
+        while(!workspace.isHeapEmpty()) {
+            TraversalWorkspace::HeapEntry item = workspace.popHeap();
+            VertexId u = item.vertex;
+            if(workspace.isSettled(u) || workspace.getDistance(u) < item.dist) {
+                continue;
+            }
+            workspace.settle(u);
+            if(u == target) {
+                break;
+            }
+
+            for(typename G::NeighborIterator it = g.neighbors(u); !it.done(); it.next()) {
+                VertexId v = it.destination();
+                Weight w = it.weight();
+                if(isNegativeWeight(w)) {
+                    throw "Dijkstra does not support negative edge weights.";
+                }
+                Distance d = extendPath(item.dist, w);
+                if(!workspace.isSettled(v) && d < workspace.getDistance(v)) {
+                    workspace.relax(v, d, u, w);
+                    workspace.pushHeap(v, d);
+                }
+            }
+        }
+        return workspace.getNumReached();
+    }
+
+#define GRAPH_DEFINE_DIJKSTRA_IN_WORKSPACE(G) \
+    VertexId Algorithms::dijkstra(const G& g, VertexId startVertex, TraversalWorkspace& workspace, VertexId target) { \
+        return dijkstraInWorkspace(g, startVertex, workspace, target); \
+    }
+    GRAPH_IN_MEMORY_TYPES(GRAPH_DEFINE_DIJKSTRA_IN_WORKSPACE)
+#undef GRAPH_DEFINE_DIJKSTRA_IN_WORKSPACE
+
     //Union-Find for Kruskal
     class UnionFind {
     private:
-        int* parent;
-        int* rank;
-        int n;
+        VertexId* parent;
+        unsigned char* rank; // union by rank keeps it below 64
+        VertexId n;
     public:
-        UnionFind(int n_) : n(n_) {
-            parent = new int[n];
-            rank = new int[n];
-            for(int i = 0; i < n; i++) {
+        UnionFind(VertexId n_) : n(n_) {
+            parent = MemoryPolicy::allocateArray<VertexId>(n);
+            rank = MemoryPolicy::allocateArray<unsigned char>(n);
+            for(VertexId i = 0; i < n; i++) {
                 parent[i] = i;
                 rank[i] = 0;
             }
         }
         ~UnionFind() {
-            delete[] parent;
-            delete[] rank;
+            MemoryPolicy::releaseArray(parent, n);
+            MemoryPolicy::releaseArray(rank, n);
         }
-        int find(int x) {
+        VertexId find(VertexId x) {
             if(parent[x] != x) {
                 parent[x] = find(parent[x]);
             }
             return parent[x];
         }
-        void unite(int x, int y) {
-            int rx = find(x);
-            int ry = find(y);
+        void unite(VertexId x, VertexId y) {
+            VertexId rx = find(x);
+            VertexId ry = find(y);
             if(rx != ry) {
                 if(rank[rx] < rank[ry]) {
                     parent[rx] = ry;
@@ -274,37 +1127,43 @@ namespace graph {
     };
 
     // Prim
-    Graph Algorithms::prim(const Graph& g) {
-        int n = g.getNumVertices();
-        Graph mst(n);
+    template <typename G>
+    static MstResult primImpl(const G& g) {
+        VertexId n = g.getNumVertices();
+        MstResult mst(n);
+        if(n == 0) {
+            return mst;
+        }
 
-        bool* inMST = new bool[n];
-        int* dist = new int[n];
-        int* parent = new int[n];
+        bool* inMST = MemoryPolicy::allocateArray<bool>(n);
+        Distance* dist = MemoryPolicy::allocateArray<Distance>(n); // key: cheapest edge weight connecting the vertex to the tree
+        VertexId* parent = MemoryPolicy::allocateArray<VertexId>(n);
 
-        for(int i = 0; i < n; i++) {
+        for(VertexId i = 0; i < n; i++) {
             inMST[i] = false;
-            dist[i] = std::numeric_limits<int>::max();
-            parent[i] = -1;
+            dist[i] = infiniteDistance();
+            parent[i] = NO_VERTEX;
         }
 
         // Start from vertex 0
         dist[0] = 0;
-        ArrayMinPriorityQueue pq(n*2);
+        ArrayMinPriorityQueue pq(n); // a vertex is never in the queue twice
         pq.push(0, 0);
 
         while(!pq.isEmpty()) {
             PQItem item = pq.pop();
-            int u = item.vertex;
-            if(u == -1) break;
+            VertexId u = item.vertex;
+            if(u == NO_VERTEX) break;
             if(inMST[u]) continue;
             inMST[u] = true;
+            // The edge that brought u in joins the tree now
+            if(parent[u] != NO_VERTEX) {
+                mst.addEdge(parent[u], u, static_cast<Weight>(dist[u]));
+            }
 
-            int sizeAdj = g.getAdjSize(u);
-            Edge* edges = g.getAdjList(u);
-            for(int i = 0; i < sizeAdj; i++) {
-                int v = edges[i].destination;
-                int w = edges[i].weight;
+            for(typename G::NeighborIterator it = g.neighbors(u); !it.done(); it.next()) {
+                VertexId v = it.destination();
+                Weight w = it.weight();
                 if(!inMST[v] && w < dist[v]) {
                     dist[v] = w;
                     parent[v] = u;
@@ -317,46 +1176,118 @@ namespace graph {
             }
         }
 
-        // Build MST
-        for(int i = 1; i < n; i++) {
-            if(parent[i] != -1) {
-                mst.addEdge(parent[i], i, dist[i]);
+        MemoryPolicy::releaseArray(inMST, n);
+        MemoryPolicy::releaseArray(dist, n);
+        MemoryPolicy::releaseArray(parent, n);
+        return mst;
+    }
+
+    // O(V^2) Prim: same argmin scan as denseDijkstra, 'key' holding the cheapest edge to the tree
+    static MstResult densePrim(const DenseGraph& g) {
+        VertexId n = g.getNumVertices();
+        MstResult mst(n);
+        if(n == 0) {
+            return mst;
+        }
+
+        Distance* key = MemoryPolicy::allocateArray<Distance>(n);
+        bool* inMST = MemoryPolicy::allocateArray<bool>(n);
+        VertexId* parent = MemoryPolicy::allocateArray<VertexId>(n);
+        for(VertexId i = 0; i < n; i++) {
+            key[i] = infiniteDistance();
+            inMST[i] = false;
+            parent[i] = NO_VERTEX;
+        }
+
+        // Start from vertex 0
+        key[0] = 0;
+        for(;;) {
+            VertexId u = static_cast<VertexId>(argminOf(key, n));
+            if(key[u] == infiniteDistance()) {
+                break;
+            }
+            key[u] = infiniteDistance();
+            inMST[u] = true;
+            if(parent[u] != NO_VERTEX) {
+                mst.addEdge(parent[u], u, g.getWeightRow(parent[u])[u]);
+            }
+            for(DenseGraph::NeighborIterator it = g.neighbors(u); !it.done(); it.next()) {
+                VertexId v = it.destination();
+                if(!inMST[v] && it.weight() < key[v]) {
+                    key[v] = it.weight();
+                    parent[v] = u;
+                }
             }
         }
 
-        delete[] inMST;
-        delete[] dist;
-        delete[] parent;
+        MemoryPolicy::releaseArray(key, n);
+        MemoryPolicy::releaseArray(inMST, n);
+        MemoryPolicy::releaseArray(parent, n);
         return mst;
     }
 
+    template <typename G>
+    static MstResult autoPrim(const G& g) {
+        if(DenseGraph::shouldConvert(g.getNumVertices(), g.getNumAdjEntries())) {
+            return densePrim(DenseGraph(g));
+        }
+        return primImpl(g);
+    }
+
+    // The search behind prim / primResult (same choice as dijkstraOf)
+    template <typename G>
+    static MstResult primOf(const G& g) {
+        return primImpl(g);
+    }
+
+    static MstResult primOf(const Graph& g) {
+        return autoPrim(g);
+    }
+
+    static MstResult primOf(const CsrGraph& g) {
+        return autoPrim(g);
+    }
+
+    static MstResult primOf(const DenseGraph& g) {
+        return densePrim(g);
+    }
+
+#define GRAPH_DEFINE_PRIM(G) \
+    Graph Algorithms::prim(const G& g) { \
+        return primOf(g).toGraph(); \
+    } \
+    MstResult Algorithms::primResult(const G& g) { \
+        return primOf(g); \
+    }
+    GRAPH_UNDIRECTED_TYPES(GRAPH_DEFINE_PRIM)
+#undef GRAPH_DEFINE_PRIM
+
+    // Kruskal order: by weight, ties by endpoints, so the result does not depend on the input
+    // order (nor, for an ExternalGraph, on the run boundaries)
+    static bool lighterEdge(const WeightedEdge& a, const WeightedEdge& b) {
+        if(a.w != b.w) return a.w < b.w;
+        if(a.u != b.u) return a.u < b.u;
+        return a.v < b.v;
+    }
+
     // Kruskal
-    Graph Algorithms::kruskal(const Graph& g) {
-        int n = g.getNumVertices();
-        Graph mst(n);
+    template <typename G>
+    static MstResult kruskalImpl(const G& g) {
+        VertexId n = g.getNumVertices();
+        MstResult mst(n);
         UnionFind uf(n);
 
         // Count total edges (each edge appears twice in an undirected graph so we divide by 2)
-        int totalEdges = 0;
-        for(int i = 0; i < n; i++) {
-            totalEdges += g.getAdjSize(i);
-        }
-        int uniqueEdges = totalEdges / 2;
-
-        struct E {
-            int u;
-            int v;
-            int w;
-        };
-        E* edgesArr = new E[uniqueEdges];
-
-        int idx = 0;
-        for(int u = 0; u < n; u++) {
-            int adjSize = g.getAdjSize(u);
-            Edge* edges = g.getAdjList(u);
-            for(int i = 0; i < adjSize; i++) {
-                int v = edges[i].destination;
-                int w = edges[i].weight;
+        std::size_t totalEdges = g.getNumAdjEntries();
+        std::size_t uniqueEdges = totalEdges / 2;
+
+        WeightedEdge* edgesArr = MemoryPolicy::allocateArray<WeightedEdge>(uniqueEdges);
+
+        std::size_t idx = 0;
+        for(VertexId u = 0; u < n; u++) {
+            for(typename G::NeighborIterator it = g.neighbors(u); !it.done(); it.next()) {
+                VertexId v = it.destination();
+                Weight w = it.weight();
                 if(v > u) {
                     edgesArr[idx].u = u;
                     edgesArr[idx].v = v;
@@ -366,30 +1297,372 @@ namespace graph {
             }
         }
 
-        // bubble sort by w (high runtime but in the assignment requirements we were said that runtime efficiency doesn't matter)
-        for(int i = 0; i < uniqueEdges - 1; i++) {
-            for(int j = i + 1; j < uniqueEdges; j++) {
-                if(edgesArr[j].w < edgesArr[i].w) {
-                    E temp = edgesArr[i];
-                    edgesArr[i] = edgesArr[j];
-                    edgesArr[j] = temp;
-                }
-            }
-        }
+        std::sort(edgesArr, edgesArr + idx, lighterEdge);
 
         // build MST
-        for(int i = 0; i < uniqueEdges; i++) {
-            int u = edgesArr[i].u;
-            int v = edgesArr[i].v;
-            int w = edgesArr[i].w;
+        for(std::size_t i = 0; i < idx; i++) {
+            VertexId u = edgesArr[i].u;
+            VertexId v = edgesArr[i].v;
+            Weight w = edgesArr[i].w;
             if(uf.find(u) != uf.find(v)) {
                 uf.unite(u, v);
                 mst.addEdge(u, v, w);
             }
         }
 
-        delete[] edgesArr;
+        MemoryPolicy::releaseArray(edgesArr, uniqueEdges);
         return mst;
     }
 
+    // ----- Kruskal on an ExternalGraph: external merge sort of the edge list.
+    // The edges (u < v) are collected in runs of getSortBytes(); a full run is sorted and appended
+    // to a temporary file. If every edge fits in one run nothing is written. Otherwise the runs are
+    // merged at most mergeFanIn() at a time, so every run is read through a buffer of at least
+    // MIN_MERGE_READ_BYTES (large sequential preads); while there are more runs than that, a pass
+    // merges groups of them into a second temporary file, and the last merge feeds Kruskal directly.
+
+    // Sequential reader of one sorted run in the temporary file
+    class RunReader {
+    private:
+        int fd;
+        std::uint64_t next;      // next edge of the run not in the buffer
+        std::uint64_t end;
+        WeightedEdge* buffer;
+        std::size_t capacity;
+        std::size_t size;
+        std::size_t index;
+
+        void refill() {
+            std::uint64_t remaining = end - next;
+            size = remaining < capacity ? static_cast<std::size_t>(remaining) : capacity;
+            char* out = reinterpret_cast<char*>(buffer);
+            std::size_t bytes = size * sizeof(WeightedEdge);
+            off_t pos = static_cast<off_t>(next * sizeof(WeightedEdge));
+            while(bytes > 0) {
+                ssize_t got = ::pread(fd, out, bytes, pos);
+                if(got <= 0) {
+                    throw "Cannot read the temporary run file.";
+                }
+                out += got;
+                bytes -= static_cast<std::size_t>(got);
+                pos += got;
+            }
+            next += size;
+            index = 0;
+        }
+
+    public:
+        RunReader() : fd(-1), next(0), end(0), buffer(nullptr), capacity(0), size(0), index(0) {}
+        void start(int file, std::uint64_t first, std::uint64_t last, WeightedEdge* space, std::size_t spaceEdges) {
+            fd = file;
+            next = first;
+            end = last;
+            buffer = space;
+            capacity = spaceEdges;
+            refill();
+        }
+        bool done() const { return index == size; }
+        const WeightedEdge& current() const { return buffer[index]; }
+        void advance() {
+            if(++index == size && next < end) {
+                refill();
+            }
+        }
+    };
+
+    // Min-heap order of run indices by their current edge (for std::push_heap / pop_heap)
+    struct HeavierRun {
+        const RunReader* runs;
+        bool operator()(int a, int b) const {
+            return lighterEdge(runs[b].current(), runs[a].current());
+        }
+    };
+
+    static void writeRun(std::FILE* file, WeightedEdge* edges, std::size_t count) {
+        std::sort(edges, edges + count, lighterEdge);
+        if(std::fwrite(edges, sizeof(WeightedEdge), count, file) != count) {
+            throw "Cannot write the temporary run file.";
+        }
+    }
+
+    // Merge output of an intermediate pass: appends to a run file through a buffer of 'capacity' edges
+    class RunWriter {
+    private:
+        std::FILE* file;
+        WeightedEdge* buffer;
+        std::size_t capacity;
+        std::size_t size;
+    public:
+        RunWriter(std::FILE* out, WeightedEdge* space, std::size_t spaceEdges)
+            : file(out), buffer(space), capacity(spaceEdges), size(0) {}
+        bool operator()(const WeightedEdge& e) {
+            if(size == capacity) {
+                flush();
+            }
+            buffer[size++] = e;
+            return true;
+        }
+        void flush() {
+            if(std::fwrite(buffer, sizeof(WeightedEdge), size, file) != size) {
+                throw "Cannot write the temporary run file.";
+            }
+            size = 0;
+        }
+    };
+
+    // Merge output of the last pass: the Kruskal step, until the tree spans the graph
+    struct MstBuilder {
+        MstResult& mst;
+        UnionFind& uf;
+        bool operator()(const WeightedEdge& e) {
+            if(uf.find(e.u) != uf.find(e.v)) {
+                uf.unite(e.u, e.v);
+                mst.addEdge(e.u, e.v, e.w);
+            }
+            return !mst.isSpanningTree();
+        }
+    };
+
+    // k-way merge of runs [firstRun, endRun) of 'fd' (run r holds edges bounds[r] .. bounds[r + 1] - 1),
+    // each read through 'share' edges of 'space'. The edges go to sink(e) in order until it returns false.
+    template <typename Sink>
+    static void mergeRuns(int fd, const std::uint64_t* bounds, std::size_t firstRun, std::size_t endRun,
+                          WeightedEdge* space, std::size_t share, Sink& sink) {
+        std::size_t k = endRun - firstRun;
+        RunReader* runs = new RunReader[k];
+        int* heap = new int[k];
+        int heapSize = 0;
+        HeavierRun heavier = { runs };
+        try {
+            for(std::size_t r = 0; r < k; r++) {
+                runs[r].start(fd, bounds[firstRun + r], bounds[firstRun + r + 1], space + r * share, share);
+                if(!runs[r].done()) {
+                    heap[heapSize++] = static_cast<int>(r);
+                    std::push_heap(heap, heap + heapSize, heavier);
+                }
+            }
+            while(heapSize > 0) {
+                std::pop_heap(heap, heap + heapSize, heavier);
+                RunReader& run = runs[heap[heapSize - 1]];
+                if(!sink(run.current())) {
+                    break;
+                }
+                run.advance();
+                if(run.done()) {
+                    heapSize--;
+                } else {
+                    std::push_heap(heap, heap + heapSize, heavier);
+                }
+            }
+        } catch(...) {
+            delete[] heap;
+            delete[] runs;
+            throw;
+        }
+        delete[] heap;
+        delete[] runs;
+    }
+
+    // Runs merged at once: every reader and the output buffer get at least MIN_MERGE_READ_BYTES
+    // of the sort budget (but always 2 runs, however small the budget)
+    static std::size_t mergeFanIn(std::size_t sortBytes) {
+        std::size_t buffers = sortBytes / ExternalGraph::MIN_MERGE_READ_BYTES;
+        std::size_t fanIn = buffers > 1 ? buffers - 1 : 1;
+        fanIn = fanIn < ExternalGraph::MAX_MERGE_FAN_IN ? fanIn : ExternalGraph::MAX_MERGE_FAN_IN;
+        return fanIn < 2 ? 2 : fanIn;
+    }
+
+    static void closeRunFiles(std::FILE* a, std::FILE* b) {
+        if(a != nullptr) {
+            std::fclose(a); // a tmpfile is deleted when closed
+        }
+        if(b != nullptr) {
+            std::fclose(b);
+        }
+    }
+
+    static MstResult externalKruskal(const ExternalGraph& g) {
+        VertexId n = g.getNumVertices();
+        MstResult mst(n);
+        UnionFind uf(n);
+        MstBuilder builder = { mst, uf };
+
+        std::size_t capacity = g.getSortBytes() / sizeof(WeightedEdge);
+        capacity = capacity < 16 ? 16 : capacity;
+        WeightedEdge* buffer = MemoryPolicy::allocateArray<WeightedEdge>(capacity);
+
+        std::FILE* runFile = nullptr;
+        std::FILE* mergeFile = nullptr;
+        std::uint64_t* bounds = nullptr;
+        try {
+            // Pass 1: cut the edge list into sorted runs
+            std::size_t numRuns = 0;
+            std::size_t count = 0;
+            {
+                ExternalScanner scanner(g);
+                for(VertexId u = 0; u < n; u++) {
+                    for(scanner.open(u); !scanner.done(); scanner.next()) {
+                        if(scanner.destination() <= u) {
+                            continue;
+                        }
+                        if(count == capacity) {
+                            if(runFile == nullptr && (runFile = std::tmpfile()) == nullptr) {
+                                throw "Cannot create a temporary run file.";
+                            }
+                            writeRun(runFile, buffer, count);
+                            numRuns++;
+                            count = 0;
+                        }
+                        buffer[count].u = u;
+                        buffer[count].v = scanner.destination();
+                        buffer[count].w = scanner.weight();
+                        count++;
+                    }
+                }
+            }
+
+            if(runFile == nullptr) {
+                // Everything fit in memory: sort once and add edges while they join two trees
+                std::sort(buffer, buffer + count, lighterEdge);
+                for(std::size_t i = 0; i < count; i++) {
+                    if(!builder(buffer[i])) {
+                        break;
+                    }
+                }
+                MemoryPolicy::releaseArray(buffer, capacity);
+                return mst;
+            }
+            if(count > 0) {
+                writeRun(runFile, buffer, count);
+                numRuns++;
+            }
+            if(std::fflush(runFile) != 0) {
+                throw "Cannot write the temporary run file.";
+            }
+
+            // Every run but the last has 'capacity' edges
+            std::uint64_t totalEdges = static_cast<std::uint64_t>(numRuns - 1) * capacity + count;
+            bounds = new std::uint64_t[numRuns + 1];
+            for(std::size_t r = 0; r < numRuns; r++) {
+                bounds[r] = static_cast<std::uint64_t>(r) * capacity;
+            }
+            bounds[numRuns] = totalEdges;
+
+            // Intermediate passes: groups of fanIn runs become one run each. Every pass writes all
+            // the edges, so the second file is simply rewritten from the start.
+            std::size_t fanIn = mergeFanIn(g.getSortBytes());
+            std::size_t share = capacity / (fanIn + 1);
+            while(numRuns > fanIn) {
+                if(mergeFile == nullptr && (mergeFile = std::tmpfile()) == nullptr) {
+                    throw "Cannot create a temporary run file.";
+                }
+                std::rewind(mergeFile);
+                RunWriter writer(mergeFile, buffer + fanIn * share, share);
+                std::size_t merged = 0;
+                for(std::size_t first = 0; first < numRuns; first += fanIn) {
+                    std::size_t end = (first + fanIn < numRuns) ? first + fanIn : numRuns;
+                    mergeRuns(fileno(runFile), bounds, first, end, buffer, share, writer);
+                    bounds[merged++] = bounds[first]; // groups read later start beyond 'merged'
+                }
+                writer.flush();
+                if(std::fflush(mergeFile) != 0) {
+                    throw "Cannot write the temporary run file.";
+                }
+                bounds[merged] = totalEdges;
+                numRuns = merged;
+                std::swap(runFile, mergeFile);
+            }
+
+            // Last pass: the whole buffer is shared by the remaining runs
+            mergeRuns(fileno(runFile), bounds, 0, numRuns, buffer, capacity / numRuns, builder);
+        } catch(...) {
+            delete[] bounds;
+            closeRunFiles(runFile, mergeFile);
+            MemoryPolicy::releaseArray(buffer, capacity);
+            throw;
+        }
+
+        delete[] bounds;
+        closeRunFiles(runFile, mergeFile);
+        MemoryPolicy::releaseArray(buffer, capacity);
+        return mst;
+    }
+
+    // The search behind kruskal / kruskalResult: an ExternalGraph sorts its edges out of core
+    template <typename G>
+    static MstResult kruskalOf(const G& g) {
+        return kruskalImpl(g);
+    }
+
+    static MstResult kruskalOf(const ExternalGraph& g) {
+        return externalKruskal(g);
+    }
+
+#define GRAPH_DEFINE_KRUSKAL(G) \
+    Graph Algorithms::kruskal(const G& g) { \
+        return kruskalOf(g).toGraph(); \
+    } \
+    MstResult Algorithms::kruskalResult(const G& g) { \
+        return kruskalOf(g); \
+    }
+    GRAPH_UNDIRECTED_TYPES(GRAPH_DEFINE_KRUSKAL)
+    GRAPH_DEFINE_KRUSKAL(ExternalGraph)
+#undef GRAPH_DEFINE_KRUSKAL
+
+    // ----- Connected components (union-find over every edge, then dense labels)
+
+    static VertexId labelComponents(UnionFind& uf, VertexId n, VertexId* component) {
+        VertexId* labelOfRoot = MemoryPolicy::allocateArray<VertexId>(n);
+        for(VertexId v = 0; v < n; v++) {
+            labelOfRoot[v] = NO_VERTEX;
+        }
+        VertexId count = 0;
+        for(VertexId v = 0; v < n; v++) {
+            VertexId root = uf.find(v);
+            if(labelOfRoot[root] == NO_VERTEX) {
+                labelOfRoot[root] = count++;
+            }
+            component[v] = labelOfRoot[root];
+        }
+        MemoryPolicy::releaseArray(labelOfRoot, n);
+        return count;
+    }
+
+    template <typename G>
+    static VertexId componentsImpl(const G& g, VertexId* component) {
+        VertexId n = g.getNumVertices();
+        UnionFind uf(n);
+        for(VertexId u = 0; u < n; u++) {
+            for(typename G::NeighborIterator it = g.neighbors(u); !it.done(); it.next()) {
+                if(u < it.destination()) {
+                    uf.unite(u, it.destination());
+                }
+            }
+        }
+        return labelComponents(uf, n, component);
+    }
+
+    // One sequential pass over the destinations (the weights are not read)
+    static VertexId componentsImpl(const ExternalGraph& g, VertexId* component) {
+        VertexId n = g.getNumVertices();
+        UnionFind uf(n);
+        ExternalScanner scanner(g, false);
+        for(VertexId u = 0; u < n; u++) {
+            for(scanner.open(u); !scanner.done(); scanner.next()) {
+                if(u < scanner.destination()) {
+                    uf.unite(u, scanner.destination());
+                }
+            }
+        }
+        return labelComponents(uf, n, component);
+    }
+
+#define GRAPH_DEFINE_CONNECTED_COMPONENTS(G) \
+    VertexId Algorithms::connectedComponents(const G& g, VertexId* component) { \
+        return componentsImpl(g, component); \
+    }
+    GRAPH_UNDIRECTED_TYPES(GRAPH_DEFINE_CONNECTED_COMPONENTS)
+    GRAPH_DEFINE_CONNECTED_COMPONENTS(ExternalGraph)
+#undef GRAPH_DEFINE_CONNECTED_COMPONENTS
+
 } // namespace graph
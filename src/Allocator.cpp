@@ -0,0 +1,154 @@
+// email: yaacovkrawiec@gmail.com
+
+#include "../include/Allocator.hpp"
+#include "../include/MemoryPolicy.hpp"
+#include <new>
+
+namespace graph {
+
+    // ----- HeapAllocator
+
+    HeapAllocator::HeapAllocator() : head(nullptr) {}
+
+    HeapAllocator::~HeapAllocator() {
+        while(head != nullptr) {
+            Header* next = head->next;
+            ::operator delete(head);
+            head = next;
+        }
+    }
+
+    void* HeapAllocator::allocate(std::size_t bytes) {
+        if(bytes == 0) {
+            return nullptr;
+        }
+        Header* h = static_cast<Header*>(::operator new(sizeof(Header) + bytes));
+        h->prev = nullptr;
+        h->next = head;
+        if(head != nullptr) {
+            head->prev = h;
+        }
+        head = h;
+        return h + 1;
+    }
+
+    void HeapAllocator::deallocate(void* block, std::size_t) {
+        if(block == nullptr) {
+            return;
+        }
+        Header* h = static_cast<Header*>(block) - 1;
+        if(h->prev != nullptr) {
+            h->prev->next = h->next;
+        } else {
+            head = h->next;
+        }
+        if(h->next != nullptr) {
+            h->next->prev = h->prev;
+        }
+        ::operator delete(h);
+    }
+
+    BlockAllocator* HeapAllocator::clone() const {
+        return new HeapAllocator();
+    }
+
+    // ----- SlabAllocator
+
+    SlabAllocator::SlabAllocator(std::size_t chunkBytes)
+        : chunkSize(chunkBytes < 64 ? 64 : chunkBytes),
+          nextChunkSize(chunkSize < 4096 ? chunkSize : 4096), chunks(nullptr),
+          bumpCurrent(nullptr), bumpEnd(nullptr)
+    {
+        for(int i = 0; i < NUM_CLASSES; i++) {
+            freeLists[i] = nullptr;
+        }
+    }
+
+    SlabAllocator::~SlabAllocator() {
+        // Release whole chunks; the blocks inside them go away together
+        while(chunks != nullptr) {
+            Chunk* next = chunks->next;
+            MemoryPolicy::release(chunks, sizeof(Chunk) + chunks->size);
+            chunks = next;
+        }
+    }
+
+    int SlabAllocator::sizeClass(std::size_t bytes) {
+        if(bytes <= 16) {
+            return 0;
+        }
+        // p = floor(log2(bytes - 1)), so 2^p < bytes <= 2^(p+1)
+        int p = 0;
+        std::size_t x = bytes - 1;
+        while(x > 1) {
+            x >>= 1;
+            p++;
+        }
+        if(bytes <= (std::size_t(3) << (p - 1))) {
+            return 2 * (p - 4) + 1; // 24 * 2^(p-4)
+        }
+        return 2 * (p - 3);         // 16 * 2^(p-3)
+    }
+
+    std::size_t SlabAllocator::classSize(int sizeClassIndex) {
+        if(sizeClassIndex % 2 == 0) {
+            return std::size_t(16) << (sizeClassIndex / 2);
+        }
+        return std::size_t(24) << (sizeClassIndex / 2);
+    }
+
+    char* SlabAllocator::newChunk(std::size_t bytes) {
+        Chunk* c = static_cast<Chunk*>(MemoryPolicy::allocate(sizeof(Chunk) + bytes));
+        c->next = chunks;
+        c->size = bytes;
+        chunks = c;
+        return reinterpret_cast<char*>(c + 1);
+    }
+
+    void* SlabAllocator::allocate(std::size_t bytes) {
+        if(bytes == 0) {
+            return nullptr;
+        }
+        int c = sizeClass(bytes);
+
+        // Reuse a freed block of the same class first
+        if(freeLists[c] != nullptr) {
+            FreeBlock* b = freeLists[c];
+            freeLists[c] = b->next;
+            return b;
+        }
+
+        std::size_t size = classSize(c);
+        if(size > chunkSize / 4) {
+            return newChunk(size);
+        }
+        if(static_cast<std::size_t>(bumpEnd - bumpCurrent) < size) {
+            // A regular chunk takes nextChunkSize bytes with its header, so the largest ones are
+            // exactly one huge page (see MemoryPolicy)
+            std::size_t bytesForChunk = (nextChunkSize < size + sizeof(Chunk)) ? size : nextChunkSize - sizeof(Chunk);
+            bumpCurrent = newChunk(bytesForChunk);
+            bumpEnd = bumpCurrent + bytesForChunk;
+            if(nextChunkSize < chunkSize) {
+                nextChunkSize *= 2;
+            }
+        }
+        char* block = bumpCurrent;
+        bumpCurrent += size;
+        return block;
+    }
+
+    void SlabAllocator::deallocate(void* block, std::size_t bytes) {
+        if(block == nullptr) {
+            return;
+        }
+        int c = sizeClass(bytes);
+        FreeBlock* b = static_cast<FreeBlock*>(block);
+        b->next = freeLists[c];
+        freeLists[c] = b;
+    }
+
+    BlockAllocator* SlabAllocator::clone() const {
+        return new SlabAllocator(chunkSize);
+    }
+
+} // namespace graph
@@ -0,0 +1,430 @@
+// email: yaacovkrawiec@gmail.com
+
+#include "../include/Graph.hpp"
+#include "../include/CsrGraph.hpp"
+#include "../include/Algorithms.hpp"
+#include "../include/Reorder.hpp"
+#include "../include/MemoryPolicy.hpp"
+#include "../include/MappedGraph.hpp"
+#include "../include/ExternalGraph.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+
+using namespace graph;
+
+// ./bench [scale]: traversal times before and after reordering, on graphs of 2^scale vertices
+// (default 18) whose ids are shuffled, like ids assigned in input order usually are.
+// ./bench memory [scale]: the same BFS under each MemoryPolicy, with the speedup over the default.
+// ./bench external [scale]: BFS / components / Kruskal streamed from a graph file, next to the
+// memory-mapped file (the file stays in the page cache here, so this measures the streaming overhead).
+// ./bench direction [scale]: top-down BFS against direction-optimizing BFS on the grid and R-MAT graphs.
+// ./bench parallel [scale]: sequential BFS against parallelBfs on every core (plain and deterministic).
+// ./bench multi [scale]: 64 single-source BFS runs against one multiSourceBfs batch over the same sources.
+// ./bench pair [scale]: average time of a source - target hop query, by BFS with early exit and by
+// bidirectional BFS (both in reused workspaces).
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// xorshift64*: deterministic, so every run measures the same graphs
+static std::uint64_t nextRandom(std::uint64_t& state) {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 2685821657736338717ULL;
+}
+
+// Random permutation of 0..n-1 (Fisher-Yates)
+static VertexId* shuffledIds(VertexId n, std::uint64_t& state) {
+    VertexId* ids = new VertexId[n];
+    for(VertexId v = 0; v < n; v++) {
+        ids[v] = v;
+    }
+    for(VertexId v = n; v-- > 1; ) {
+        std::swap(ids[v], ids[nextRandom(state) % (static_cast<std::uint64_t>(v) + 1)]);
+    }
+    return ids;
+}
+
+// side x side grid (a road-network-like graph: low degree, large diameter)
+static Graph gridGraph(VertexId side, std::uint64_t& state) {
+    VertexId n = side * side;
+    VertexId* id = shuffledIds(n, state);
+    std::size_t m = 2 * static_cast<std::size_t>(side) * (side - 1);
+    VertexId* src = new VertexId[m];
+    VertexId* dst = new VertexId[m];
+    Weight* weights = new Weight[m];
+    std::size_t e = 0;
+    for(VertexId r = 0; r < side; r++) {
+        for(VertexId c = 0; c < side; c++) {
+            VertexId v = r * side + c;
+            if(c + 1 < side) {
+                src[e] = id[v]; dst[e] = id[v + 1]; weights[e] = static_cast<Weight>(1 + nextRandom(state) % 100); e++;
+            }
+            if(r + 1 < side) {
+                src[e] = id[v]; dst[e] = id[v + side]; weights[e] = static_cast<Weight>(1 + nextRandom(state) % 100); e++;
+            }
+        }
+    }
+    Graph g(n, src, dst, weights, e);
+    delete[] id;
+    delete[] src;
+    delete[] dst;
+    delete[] weights;
+    return g;
+}
+
+// R-MAT (a, b, c = 0.57, 0.19, 0.19): skewed degrees like a social network.
+// Loops and repeated edges are dropped.
+static Graph rmatGraph(int scale, int edgesPerVertex, std::uint64_t& state) {
+    VertexId n = static_cast<VertexId>(1) << scale;
+    VertexId* id = shuffledIds(n, state);
+    std::size_t wanted = static_cast<std::size_t>(n) * edgesPerVertex;
+    std::uint64_t* keys = new std::uint64_t[wanted];
+    std::size_t count = 0;
+    for(std::size_t i = 0; i < wanted; i++) {
+        std::uint64_t u = 0;
+        std::uint64_t v = 0;
+        for(int bit = 0; bit < scale; bit++) {
+            std::uint64_t r = nextRandom(state) % 100;
+            u = (u << 1) | (r >= 76 ? 1 : 0);          // c + d quadrants
+            v = (v << 1) | ((r >= 57 && r < 76) || r >= 95 ? 1 : 0); // b + d quadrants
+        }
+        u = static_cast<std::uint64_t>(id[u]);
+        v = static_cast<std::uint64_t>(id[v]);
+        if(u != v) {
+            keys[count++] = u < v ? (u << 32 | v) : (v << 32 | u);
+        }
+    }
+    std::sort(keys, keys + count);
+    count = static_cast<std::size_t>(std::unique(keys, keys + count) - keys);
+
+    VertexId* src = new VertexId[count];
+    VertexId* dst = new VertexId[count];
+    for(std::size_t i = 0; i < count; i++) {
+        src[i] = static_cast<VertexId>(keys[i] >> 32);
+        dst[i] = static_cast<VertexId>(keys[i] & 0xFFFFFFFFu);
+    }
+    Graph g(n, src, dst, nullptr, count);
+    delete[] id;
+    delete[] keys;
+    delete[] src;
+    delete[] dst;
+    return g;
+}
+
+// Highest-degree vertex: a start inside the big component (R-MAT leaves many vertices isolated)
+static VertexId busiestVertex(const Graph& g) {
+    VertexId best = 0;
+    for(VertexId v = 1; v < g.getNumVertices(); v++) {
+        if(g.getAdjSize(v) > g.getAdjSize(best)) {
+            best = v;
+        }
+    }
+    return best;
+}
+
+// Best of a few BFS runs over the Graph and over its CSR snapshot
+static void timeTraversals(const char* label, const Graph& g, VertexId start, double reorderSeconds) {
+    const int runs = 3;
+    double graphBest = 0;
+    double csrBest = 0;
+    CsrGraph csr = g.freeze();
+    for(int i = 0; i < runs; i++) {
+        std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+        Graph tree = Algorithms::bfs(g, start);
+        double seconds = secondsSince(t);
+        graphBest = (i == 0 || seconds < graphBest) ? seconds : graphBest;
+
+        t = std::chrono::steady_clock::now();
+        Graph csrTree = Algorithms::bfs(csr, start);
+        seconds = secondsSince(t);
+        csrBest = (i == 0 || seconds < csrBest) ? seconds : csrBest;
+    }
+    std::cout << "  " << std::left << std::setw(12) << label << std::right << std::fixed << std::setprecision(3)
+              << std::setw(12) << reorderSeconds
+              << std::setw(14) << graphBest
+              << std::setw(14) << csrBest << "\n";
+}
+
+static void benchmark(const char* name, const Graph& g) {
+    std::cout << name << ": " << g.getNumVertices() << " vertices, " << g.getNumAdjEntries() / 2 << " edges\n";
+    std::cout << "  ordering     reorder (s)  bfs Graph (s)  bfs Csr (s)\n";
+    // Every run starts from the same original vertex
+    const VertexId start = busiestVertex(g);
+    timeTraversals("original", g, start, 0);
+
+    const Reorder::Strategy strategies[] = { Reorder::DEGREE_DESC, Reorder::BFS_ORDER, Reorder::RCM, Reorder::GORDER };
+    const char* labels[] = { "degree", "bfs", "rcm", "gorder" };
+    for(int s = 0; s < 4; s++) {
+        std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+        Reordering r = Reorder::reorder(g, strategies[s]);
+        double seconds = secondsSince(t);
+        timeTraversals(labels[s], r.getGraph(), r.getNewId(start), seconds);
+    }
+    std::cout << "\n";
+}
+
+// BFS on the CSR snapshot of an R-MAT graph; the snapshot, the BFS work arrays and the slab
+// chunks of the tree are allocated again under each policy
+static void memoryBenchmark(int scale) {
+    std::uint64_t state = 0x9E3779B97F4A7C15ULL;
+    Graph g = rmatGraph(scale, 8, state);
+    std::cout << "rmat: " << g.getNumVertices() << " vertices, " << g.getNumAdjEntries() / 2 << " edges, "
+              << MemoryPolicy::getNumNodes() << " NUMA node(s)\n";
+    std::cout << "  policy                       bfs Csr (s)   speedup\n";
+
+    struct Setting {
+        const char* label;
+        MemoryPolicy::Pages pages;
+        MemoryPolicy::Placement placement;
+    };
+    const Setting settings[] = {
+        { "default",                  MemoryPolicy::DEFAULT_PAGES,          MemoryPolicy::FIRST_TOUCH },
+        { "small pages",              MemoryPolicy::SMALL_PAGES,            MemoryPolicy::FIRST_TOUCH },
+        { "transparent huge pages",   MemoryPolicy::TRANSPARENT_HUGE_PAGES, MemoryPolicy::FIRST_TOUCH },
+        { "hugetlb pages",            MemoryPolicy::HUGETLB_PAGES,          MemoryPolicy::FIRST_TOUCH },
+        { "thp + interleaved",        MemoryPolicy::TRANSPARENT_HUGE_PAGES, MemoryPolicy::INTERLEAVED },
+        { "thp + partitioned",        MemoryPolicy::TRANSPARENT_HUGE_PAGES, MemoryPolicy::PARTITIONED },
+    };
+    const int runs = 3;
+    double baseline = 0;
+    for(int s = 0; s < 6; s++) {
+        MemoryPolicy::set(settings[s].pages, settings[s].placement);
+        CsrGraph csr = g.freeze();
+        VertexId start = busiestVertex(g);
+        double best = 0;
+        for(int i = 0; i < runs; i++) {
+            std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+            Graph tree = Algorithms::bfs(csr, start);
+            double seconds = secondsSince(t);
+            best = (i == 0 || seconds < best) ? seconds : best;
+        }
+        if(s == 0) {
+            baseline = best;
+        }
+        std::cout << "  " << std::left << std::setw(28) << settings[s].label << std::right << std::fixed
+                  << std::setprecision(3) << std::setw(12) << best
+                  << std::setprecision(2) << std::setw(9) << baseline / best << "x\n";
+    }
+    MemoryPolicy::set(MemoryPolicy::DEFAULT_PAGES, MemoryPolicy::FIRST_TOUCH);
+    if(MemoryPolicy::getHugeTlbFallbacks() > 0) {
+        std::cout << "  (no reserved hugetlb pages: " << MemoryPolicy::getHugeTlbFallbacks()
+                  << " allocation(s) used transparent huge pages, see vm.nr_hugepages)\n";
+    }
+}
+
+static void externalBenchmark(int scale) {
+    std::uint64_t state = 0x9E3779B97F4A7C15ULL;
+    Graph g = rmatGraph(scale, 8, state);
+    const char* path = "bench_external.bin";
+    MappedGraph::write(g, path);
+    VertexId start = busiestVertex(g);
+    std::cout << "rmat: " << g.getNumVertices() << " vertices, " << g.getNumAdjEntries() / 2 << " edges\n";
+    std::cout << "  graph          bfs (s)   components (s)   kruskal (s)\n";
+
+    VertexId* component = new VertexId[g.getNumVertices()];
+    {
+        MappedGraph mapped(path);
+        std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+        Graph tree = Algorithms::bfs(mapped, start);
+        double bfsSeconds = secondsSince(t);
+        t = std::chrono::steady_clock::now();
+        Algorithms::connectedComponents(mapped, component);
+        double ccSeconds = secondsSince(t);
+        std::cout << "  " << std::left << std::setw(12) << "mapped" << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(10) << bfsSeconds << std::setw(17) << ccSeconds << std::setw(14) << "-" << "\n";
+    }
+    {
+        ExternalGraph external(path);
+        std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+        Graph tree = Algorithms::bfs(external, start);
+        double bfsSeconds = secondsSince(t);
+        t = std::chrono::steady_clock::now();
+        Algorithms::connectedComponents(external, component);
+        double ccSeconds = secondsSince(t);
+        t = std::chrono::steady_clock::now();
+        Graph mst = Algorithms::kruskal(external);
+        double mstSeconds = secondsSince(t);
+        std::cout << "  " << std::left << std::setw(12) << "external" << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(10) << bfsSeconds << std::setw(17) << ccSeconds << std::setw(14) << mstSeconds << "\n";
+    }
+    delete[] component;
+    std::remove(path);
+}
+
+// Best of a few runs of both searches over the CSR snapshot
+static void directionBenchmark(const char* name, const Graph& g) {
+    const int runs = 3;
+    CsrGraph csr = g.freeze();
+    VertexId start = busiestVertex(g);
+    double topDown = 0;
+    double hybrid = 0;
+    for(int i = 0; i < runs; i++) {
+        std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+        BfsResult plain = Algorithms::bfsResult(csr, start);
+        double seconds = secondsSince(t);
+        topDown = (i == 0 || seconds < topDown) ? seconds : topDown;
+
+        t = std::chrono::steady_clock::now();
+        BfsResult optimized = Algorithms::directionOptimizingBfs(csr, start);
+        seconds = secondsSince(t);
+        hybrid = (i == 0 || seconds < hybrid) ? seconds : hybrid;
+    }
+    std::cout << "  " << std::left << std::setw(8) << name << std::right << std::fixed << std::setprecision(3)
+              << std::setw(13) << topDown << std::setw(19) << hybrid
+              << std::setprecision(2) << std::setw(8) << topDown / hybrid << "x\n";
+}
+
+// Best of a few runs of the sequential and both parallel searches over the CSR snapshot
+static void parallelBenchmark(const char* name, const Graph& g) {
+    const int runs = 3;
+    CsrGraph csr = g.freeze();
+    VertexId start = busiestVertex(g);
+    double best[3] = { 0, 0, 0 };
+    for(int i = 0; i < runs; i++) {
+        for(int kind = 0; kind < 3; kind++) {
+            std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+            BfsResult result = kind == 0 ? Algorithms::bfsResult(csr, start) : Algorithms::parallelBfs(csr, start, kind == 2);
+            double seconds = secondsSince(t);
+            best[kind] = (i == 0 || seconds < best[kind]) ? seconds : best[kind];
+        }
+    }
+    std::cout << "  " << std::left << std::setw(8) << name << std::right << std::fixed << std::setprecision(3)
+              << std::setw(15) << best[0] << std::setw(14) << best[1] << std::setw(19) << best[2]
+              << std::setprecision(2) << std::setw(8) << best[0] / best[1] << "x\n";
+}
+
+// One bfsResult per source against a single multiSourceBfs batch, over the CSR snapshot
+static void multiSourceBenchmark(const char* name, const Graph& g) {
+    const std::size_t numSources = Algorithms::MULTI_SOURCE_BATCH;
+    CsrGraph csr = g.freeze();
+    VertexId* sources = new VertexId[numSources];
+    std::uint64_t state = 12345;
+    for(std::size_t i = 0; i < numSources; i++) {
+        sources[i] = static_cast<VertexId>(nextRandom(state) % static_cast<std::uint64_t>(g.getNumVertices()));
+    }
+
+    std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+    Distance singleSum = 0;
+    for(std::size_t i = 0; i < numSources; i++) {
+        BfsResult single = Algorithms::bfsResult(csr, sources[i]);
+        singleSum += single.getDepth(sources[0]);
+    }
+    double single = secondsSince(t);
+
+    t = std::chrono::steady_clock::now();
+    MultiSourceBfsResult batch = Algorithms::multiSourceBfs(csr, sources, numSources);
+    double multi = secondsSince(t);
+    Distance batchSum = 0;
+    for(std::size_t i = 0; i < numSources; i++) {
+        batchSum += batch.getDepth(i, sources[0]);
+    }
+    delete[] sources;
+
+    std::cout << "  " << std::left << std::setw(8) << name << std::right << std::fixed << std::setprecision(3)
+              << std::setw(13) << single << std::setw(12) << multi
+              << std::setprecision(2) << std::setw(8) << single / multi << "x"
+              << (singleSum == batchSum ? "" : "  (depths differ!)") << "\n";
+}
+
+// Random source - target pairs answered by one-sided BFS stopping at the target, then bidirectionally
+static void pairBenchmark(const char* name, const Graph& g) {
+    const int queries = 200;
+    CsrGraph csr = g.freeze();
+    TraversalWorkspace forward(g.getNumVertices());
+    TraversalWorkspace backward(g.getNumVertices());
+    std::uint64_t state = 999;
+    VertexId* sources = new VertexId[queries];
+    VertexId* targets = new VertexId[queries];
+    for(int i = 0; i < queries; i++) {
+        sources[i] = static_cast<VertexId>(nextRandom(state) % static_cast<std::uint64_t>(g.getNumVertices()));
+        targets[i] = static_cast<VertexId>(nextRandom(state) % static_cast<std::uint64_t>(g.getNumVertices()));
+    }
+
+    std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+    Distance oneSided = 0;
+    for(int i = 0; i < queries; i++) {
+        Algorithms::bfs(csr, sources[i], forward, targets[i]);
+        oneSided += forward.isReached(targets[i]) ? forward.getDepth(targets[i]) : 0;
+    }
+    double single = secondsSince(t);
+
+    t = std::chrono::steady_clock::now();
+    Distance twoSided = 0;
+    for(int i = 0; i < queries; i++) {
+        HopPathResult hops = Algorithms::bidirectionalBfs(csr, sources[i], targets[i], forward, backward);
+        twoSided += hops.isConnected() ? hops.getDistance() : 0;
+    }
+    double bidirectional = secondsSince(t);
+    delete[] sources;
+    delete[] targets;
+
+    std::cout << "  " << std::left << std::setw(8) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(13) << single / queries * 1e6 << std::setw(18) << bidirectional / queries * 1e6
+              << std::setw(8) << single / bidirectional << "x"
+              << (oneSided == twoSided ? "" : "  (distances differ!)") << "\n";
+}
+
+int main(int argc, char** argv) {
+    bool memory = argc > 1 && std::strcmp(argv[1], "memory") == 0;
+    bool external = argc > 1 && std::strcmp(argv[1], "external") == 0;
+    bool direction = argc > 1 && std::strcmp(argv[1], "direction") == 0;
+    bool parallel = argc > 1 && std::strcmp(argv[1], "parallel") == 0;
+    bool multi = argc > 1 && std::strcmp(argv[1], "multi") == 0;
+    bool pair = argc > 1 && std::strcmp(argv[1], "pair") == 0;
+    int scaleArg = (memory || external || direction || parallel || multi || pair) ? 2 : 1;
+    int scale = argc > scaleArg ? std::atoi(argv[scaleArg]) : 18;
+    if(scale < 4 || scale > 30 || (static_cast<std::uint64_t>(1) << scale) > static_cast<std::uint64_t>(std::numeric_limits<VertexId>::max())) {
+        std::cerr << "Scale must be between 4 and 30 and fit the vertex id type.\n";
+        return 1;
+    }
+    if(memory) {
+        memoryBenchmark(scale);
+        return 0;
+    }
+    if(external) {
+        externalBenchmark(scale);
+        return 0;
+    }
+    std::uint64_t state = 0x9E3779B97F4A7C15ULL;
+    if(direction) {
+        std::cout << "  graph    top-down (s)  direction-opt (s)  speedup\n";
+        directionBenchmark("grid", gridGraph(static_cast<VertexId>(1) << (scale / 2), state));
+        directionBenchmark("rmat", rmatGraph(scale, 8, state));
+        return 0;
+    }
+    if(parallel) {
+        std::cout << "  graph    sequential (s)  parallel (s)  deterministic (s)  speedup\n";
+        parallelBenchmark("grid", gridGraph(static_cast<VertexId>(1) << (scale / 2), state));
+        parallelBenchmark("rmat", rmatGraph(scale, 8, state));
+        return 0;
+    }
+    if(multi) {
+        std::cout << "  graph    64 x bfs (s)  ms-bfs (s)  speedup\n";
+        multiSourceBenchmark("grid", gridGraph(static_cast<VertexId>(1) << (scale / 2), state));
+        multiSourceBenchmark("rmat", rmatGraph(scale, 8, state));
+        return 0;
+    }
+    if(pair) {
+        std::cout << "  graph    bfs (us/query)  bidirectional (us)  speedup\n";
+        pairBenchmark("grid", gridGraph(static_cast<VertexId>(1) << (scale / 2), state));
+        pairBenchmark("rmat", rmatGraph(scale, 8, state));
+        return 0;
+    }
+
+    Graph grid = gridGraph(static_cast<VertexId>(1) << (scale / 2), state);
+    benchmark("grid", grid);
+
+    Graph rmat = rmatGraph(scale, 8, state);
+    benchmark("rmat", rmat);
+    return 0;
+}
@@ -0,0 +1,218 @@
+// email: yaacovkrawiec@gmail.com
+
+#include "../include/CompressedGraph.hpp"
+#include "../include/MemoryPolicy.hpp"
+#include <algorithm> // std::sort
+
+namespace graph {
+
+    static bool edgeLess(const Edge& a, const Edge& b) {
+        if(a.destination != b.destination) {
+            return a.destination < b.destination;
+        }
+        return a.weight < b.weight;
+    }
+
+    // Make room for 'bytes' more bytes in 'buffer' (doubling)
+    static void reserveBytes(unsigned char*& buffer, std::size_t size, std::size_t& capacity, std::size_t bytes) {
+        if(size + bytes > capacity) {
+            std::size_t newCap = (capacity < 64) ? 64 : capacity * 2;
+            unsigned char* bigger = new unsigned char[newCap];
+            for(std::size_t i = 0; i < size; i++) {
+                bigger[i] = buffer[i];
+            }
+            delete[] buffer;
+            buffer = bigger;
+            capacity = newCap;
+        }
+    }
+
+    // Append 'value' as a varint
+    static void appendVarint(unsigned char*& buffer, std::size_t& size, std::size_t& capacity, unsigned long long value) {
+        reserveBytes(buffer, size, capacity, 10);
+        while(value >= 0x80) {
+            buffer[size++] = static_cast<unsigned char>(value | 0x80);
+            value >>= 7;
+        }
+        buffer[size++] = static_cast<unsigned char>(value);
+    }
+
+    // Shared by both constructors: G is Graph or CsrGraph
+    template <typename G>
+    void CompressedGraph::build(const G& g) {
+        numVertices = g.getNumVertices();
+        groupOffsets = MemoryPolicy::allocateArray<std::size_t>(numGroups());
+        localOffsets = MemoryPolicy::allocateArray<unsigned int>(numVertices);
+        numAdjEntries = 0;
+        negativeWeights = false;
+
+        int maxDegree = 0;
+        for(VertexId v = 0; v < numVertices; v++) {
+            if(g.getAdjSize(v) > maxDegree) {
+                maxDegree = g.getAdjSize(v);
+            }
+        }
+        Edge* sorted = new Edge[maxDegree > 0 ? maxDegree : 1];
+
+        unsigned char* buffer = nullptr;
+        std::size_t size = 0;
+        std::size_t capacity = 0;
+        for(VertexId v = 0; v < numVertices; v++) {
+            if((v & ((1 << GROUP_BITS) - 1)) == 0) {
+                groupOffsets[v >> GROUP_BITS] = size;
+            }
+            std::size_t local = size - groupOffsets[v >> GROUP_BITS];
+            if(local > 0xFFFFFFFFu) {
+                delete[] buffer;
+                delete[] sorted;
+                MemoryPolicy::releaseArray(groupOffsets, numGroups());
+                MemoryPolicy::releaseArray(localOffsets, numVertices);
+                throw "CompressedGraph: a group of vertices needs more than 4 GiB.";
+            }
+            localOffsets[v] = static_cast<unsigned int>(local);
+
+            int degree = 0;
+            for(typename G::NeighborIterator it = g.neighbors(v); !it.done(); it.next()) {
+                sorted[degree].destination = it.destination();
+                sorted[degree].weight = it.weight();
+                if(isNegativeWeight(it.weight())) {
+                    negativeWeights = true;
+                }
+                degree++;
+            }
+            std::sort(sorted, sorted + degree, edgeLess);
+
+            appendVarint(buffer, size, capacity, static_cast<unsigned int>(degree));
+            for(int i = 0; i < degree; i++) {
+                if(i == 0) {
+                    long long delta = static_cast<long long>(sorted[0].destination) - static_cast<long long>(v);
+                    appendVarint(buffer, size, capacity, VertexVarint<>::zigzag(delta));
+                } else {
+                    appendVarint(buffer, size, capacity,
+                                 static_cast<unsigned long long>(sorted[i].destination - sorted[i - 1].destination));
+                }
+                reserveBytes(buffer, size, capacity, WeightCodec<Weight>::MAX_BYTES);
+                size += WeightCodec<Weight>::encode(sorted[i].weight, buffer + size);
+            }
+            numAdjEntries += degree;
+        }
+
+        // Trim the buffer to the exact encoded size
+        dataBytes = size;
+        data = MemoryPolicy::allocateArray<unsigned char>(size > 0 ? size : 1);
+        for(std::size_t i = 0; i < size; i++) {
+            data[i] = buffer[i];
+        }
+        delete[] buffer;
+        delete[] sorted;
+    }
+
+    CompressedGraph::CompressedGraph(const Graph& g) {
+        build(g);
+    }
+
+    CompressedGraph::CompressedGraph(const CsrGraph& g) {
+        build(g);
+    }
+
+    CompressedGraph::~CompressedGraph() {
+        MemoryPolicy::releaseArray(groupOffsets, numGroups());
+        MemoryPolicy::releaseArray(localOffsets, numVertices);
+        MemoryPolicy::releaseArray(data, dataBytes > 0 ? dataBytes : 1);
+    }
+
+    // Copy constructor
+    CompressedGraph::CompressedGraph(const CompressedGraph& other)
+        : numVertices(other.numVertices), dataBytes(other.dataBytes),
+          numAdjEntries(other.numAdjEntries), negativeWeights(other.negativeWeights)
+    {
+        groupOffsets = MemoryPolicy::allocateArray<std::size_t>(numGroups());
+        for(std::size_t i = 0; i < numGroups(); i++) {
+            groupOffsets[i] = other.groupOffsets[i];
+        }
+        localOffsets = MemoryPolicy::allocateArray<unsigned int>(numVertices);
+        for(VertexId v = 0; v < numVertices; v++) {
+            localOffsets[v] = other.localOffsets[v];
+        }
+        data = MemoryPolicy::allocateArray<unsigned char>(dataBytes > 0 ? dataBytes : 1);
+        for(std::size_t i = 0; i < dataBytes; i++) {
+            data[i] = other.data[i];
+        }
+    }
+
+    // operator= (copy-and-swap)
+    CompressedGraph& CompressedGraph::operator=(const CompressedGraph& other) {
+        if(this != &other) {
+            CompressedGraph copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    // Move constructor
+    CompressedGraph::CompressedGraph(CompressedGraph&& other) noexcept
+        : numVertices(other.numVertices), groupOffsets(other.groupOffsets),
+          localOffsets(other.localOffsets), data(other.data), dataBytes(other.dataBytes),
+          numAdjEntries(other.numAdjEntries), negativeWeights(other.negativeWeights)
+    {
+        other.numVertices = 0;
+        other.groupOffsets = nullptr;
+        other.localOffsets = nullptr;
+        other.data = nullptr;
+        other.dataBytes = 0;
+        other.numAdjEntries = 0;
+    }
+
+    // Move assignment
+    CompressedGraph& CompressedGraph::operator=(CompressedGraph&& other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    void CompressedGraph::swap(CompressedGraph& other) noexcept {
+        VertexId tmpVertices = numVertices;
+        numVertices = other.numVertices;
+        other.numVertices = tmpVertices;
+
+        std::size_t* tmpGroups = groupOffsets;
+        groupOffsets = other.groupOffsets;
+        other.groupOffsets = tmpGroups;
+
+        unsigned int* tmpLocal = localOffsets;
+        localOffsets = other.localOffsets;
+        other.localOffsets = tmpLocal;
+
+        unsigned char* tmpData = data;
+        data = other.data;
+        other.data = tmpData;
+
+        std::size_t tmpBytes = dataBytes;
+        dataBytes = other.dataBytes;
+        other.dataBytes = tmpBytes;
+
+        std::size_t tmpEntries = numAdjEntries;
+        numAdjEntries = other.numAdjEntries;
+        other.numAdjEntries = tmpEntries;
+
+        bool tmpNegative = negativeWeights;
+        negativeWeights = other.negativeWeights;
+        other.negativeWeights = tmpNegative;
+    }
+
+    std::size_t CompressedGraph::getMemoryBytes() const {
+        return numGroups() * sizeof(std::size_t) + numVertices * sizeof(unsigned int) + dataBytes;
+    }
+
+    void CompressedGraph::printGraph() const {
+        std::cout << "Graph adjacency list:\n";
+        for(VertexId v = 0; v < numVertices; v++) {
+            std::cout << "Vertex " << v << ": ";
+            for(NeighborIterator it = neighbors(v); !it.done(); it.next()) {
+                std::cout << "(" << it.destination()
+                          << ", w=" << printableWeight(it.weight()) << ") ";
+            }
+            std::cout << "\n";
+        }
+    }
+
+} // namespace graph
@@ -0,0 +1,145 @@
+// email: yaacovkrawiec@gmail.com
+
+#include "../include/CsrGraph.hpp"
+#include "../include/MemoryPolicy.hpp"
+#include "../include/SimdKernels.hpp"
+#include <type_traits>
+
+namespace graph {
+
+    // The SIMD kernel handles int weights with int ids: the records are then scanned as one int
+    // array, and since every destination is a valid (non-negative) id, a negative value is a weight.
+    // Other types use a plain loop.
+    template <bool IntRecords>
+    struct EdgeWeightScan {
+        static bool anyNegative(const Edge* edges, std::size_t count) {
+            for(std::size_t i = 0; i < count; i++) {
+                if(isNegativeWeight(edges[i].weight)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+    template <>
+    struct EdgeWeightScan<true> {
+        static bool anyNegative(const Edge* edges, std::size_t count) {
+            return simd::anyNegative(reinterpret_cast<const int*>(edges), 2 * count);
+        }
+    };
+    typedef EdgeWeightScan<std::is_same<VertexId, int>::value && std::is_same<Weight, int>::value
+                           && sizeof(Edge) == 2 * sizeof(int)> CsrWeightScan;
+
+    CsrGraph::CsrGraph(const Graph& g)
+        : numVertices(g.getNumVertices())
+    {
+        // First pass: prefix sums of the adjacency sizes
+        offsets = MemoryPolicy::allocateArray<std::size_t>(static_cast<std::size_t>(numVertices) + 1);
+        offsets[0] = 0;
+        for(VertexId v = 0; v < numVertices; v++) {
+            offsets[v + 1] = offsets[v] + g.getAdjSize(v);
+        }
+
+        // Second pass: copy every adjacency array into its slot
+        edges = MemoryPolicy::allocateArray<Edge>(offsets[numVertices]);
+        for(VertexId v = 0; v < numVertices; v++) {
+            Edge* src = g.getAdjList(v);
+            Edge* dst = edges + offsets[v];
+            int size = g.getAdjSize(v);
+            for(int i = 0; i < size; i++) {
+                dst[i] = src[i];
+            }
+        }
+    }
+
+    CsrGraph::CsrGraph(VertexId numberOfVertices, std::size_t* offsetArray, Edge* edgeArray)
+        : numVertices(numberOfVertices), offsets(offsetArray), edges(edgeArray)
+    {
+    }
+
+    // Frees both arrays (their sizes come from 'offsets', so it goes last)
+    void CsrGraph::release() {
+        if(offsets != nullptr) {
+            MemoryPolicy::releaseArray(edges, offsets[numVertices]);
+            MemoryPolicy::releaseArray(offsets, static_cast<std::size_t>(numVertices) + 1);
+        }
+        offsets = nullptr;
+        edges = nullptr;
+    }
+
+    CsrGraph::~CsrGraph() {
+        release();
+    }
+
+    // Copy constructor (a moved-from snapshot has no arrays and copies as one)
+    CsrGraph::CsrGraph(const CsrGraph& other)
+        : numVertices(other.numVertices), offsets(nullptr), edges(nullptr)
+    {
+        if(other.offsets == nullptr) {
+            return;
+        }
+        offsets = MemoryPolicy::allocateArray<std::size_t>(static_cast<std::size_t>(numVertices) + 1);
+        for(std::size_t v = 0; v <= static_cast<std::size_t>(numVertices); v++) {
+            offsets[v] = other.offsets[v];
+        }
+        edges = MemoryPolicy::allocateArray<Edge>(offsets[numVertices]);
+        for(std::size_t i = 0; i < offsets[numVertices]; i++) {
+            edges[i] = other.edges[i];
+        }
+    }
+
+    // operator= (copy-and-swap)
+    CsrGraph& CsrGraph::operator=(const CsrGraph& other) {
+        if(this != &other) {
+            CsrGraph copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    // Move constructor
+    CsrGraph::CsrGraph(CsrGraph&& other) noexcept
+        : numVertices(other.numVertices), offsets(other.offsets), edges(other.edges)
+    {
+        other.numVertices = 0;
+        other.offsets = nullptr;
+        other.edges = nullptr;
+    }
+
+    // Move assignment
+    CsrGraph& CsrGraph::operator=(CsrGraph&& other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    void CsrGraph::swap(CsrGraph& other) noexcept {
+        VertexId tmpVertices = numVertices;
+        numVertices = other.numVertices;
+        other.numVertices = tmpVertices;
+
+        std::size_t* tmpOffsets = offsets;
+        offsets = other.offsets;
+        other.offsets = tmpOffsets;
+
+        Edge* tmpEdges = edges;
+        edges = other.edges;
+        other.edges = tmpEdges;
+    }
+
+    bool CsrGraph::hasNegativeWeight() const {
+        return CsrWeightScan::anyNegative(edges, getNumAdjEntries());
+    }
+
+    void CsrGraph::printGraph() const {
+        std::cout << "Graph adjacency list:\n";
+        for(VertexId v = 0; v < numVertices; v++) {
+            std::cout << "Vertex " << v << ": ";
+            for(std::size_t i = offsets[v]; i < offsets[v + 1]; i++) {
+                std::cout << "(" << edges[i].destination
+                          << ", w=" << printableWeight(edges[i].weight) << ") ";
+            }
+            std::cout << "\n";
+        }
+    }
+
+} // namespace graph
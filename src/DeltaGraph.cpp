@@ -0,0 +1,442 @@
+// email: yaacovkrawiec@gmail.com
+
+#include "../include/DeltaGraph.hpp"
+#include "../include/MemoryPolicy.hpp"
+
+namespace graph {
+
+    // ----- DeltaLayer
+
+    DeltaLayer::DeltaLayer(VertexId numberOfVertices)
+        : inserts(numberOfVertices), numInsertEntries(0), numTombstoneEntries(0), numTouched(0)
+    {
+        tombstones = new VertexId*[numberOfVertices];
+        tombstoneSizes = new int[numberOfVertices];
+        tombstoneCapacities = new int[numberOfVertices];
+        touched = new VertexId[numberOfVertices];
+        isTouched = new bool[numberOfVertices];
+        for(VertexId v = 0; v < numberOfVertices; v++) {
+            tombstones[v] = nullptr;
+            tombstoneSizes[v] = 0;
+            tombstoneCapacities[v] = 0;
+            isTouched[v] = false;
+        }
+    }
+
+    DeltaLayer::~DeltaLayer() {
+        for(VertexId v = 0; v < inserts.getNumVertices(); v++) {
+            delete[] tombstones[v];
+        }
+        delete[] tombstones;
+        delete[] tombstoneSizes;
+        delete[] tombstoneCapacities;
+        delete[] touched;
+        delete[] isTouched;
+    }
+
+    void DeltaLayer::insert(VertexId source, VertexId dest, Weight weight) {
+        touch(source);
+        touch(dest);
+        inserts.addEdge(source, dest, weight);
+        numInsertEntries += 2;
+    }
+
+    bool DeltaLayer::eraseInsert(VertexId source, VertexId dest) {
+        const Edge* list = inserts.getAdjList(source);
+        for(int i = 0; i < inserts.getAdjSize(source); i++) {
+            if(list[i].destination == dest) {
+                inserts.removeEdgeAt(source, i);
+                numInsertEntries -= 2;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool DeltaLayer::findInsert(VertexId source, VertexId dest, Weight& weight) const {
+        const Edge* list = inserts.getAdjList(source);
+        for(int i = 0; i < inserts.getAdjSize(source); i++) {
+            if(list[i].destination == dest) {
+                weight = list[i].weight;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Sorted insertion (the lists stay short: the layer is folded away at the threshold)
+    void DeltaLayer::addTombstoneEntry(VertexId vertex, VertexId dest) {
+        VertexId* list = tombstones[vertex];
+        int size = tombstoneSizes[vertex];
+        VertexId* pos = std::lower_bound(list, list + size, dest);
+        if(pos != list + size && *pos == dest) {
+            return;
+        }
+        int index = static_cast<int>(pos - list);
+        if(size == tombstoneCapacities[vertex]) {
+            int newCap = (size == 0) ? 2 : size * 2;
+            VertexId* bigger = new VertexId[newCap];
+            for(int i = 0; i < size; i++) {
+                bigger[i] = list[i];
+            }
+            delete[] list;
+            list = bigger;
+            tombstones[vertex] = list;
+            tombstoneCapacities[vertex] = newCap;
+        }
+        for(int i = size; i > index; i--) {
+            list[i] = list[i - 1];
+        }
+        list[index] = dest;
+        tombstoneSizes[vertex]++;
+        numTombstoneEntries++;
+    }
+
+    void DeltaLayer::addTombstone(VertexId source, VertexId dest) {
+        touch(source);
+        touch(dest);
+        addTombstoneEntry(source, dest);
+        addTombstoneEntry(dest, source);
+    }
+
+    void DeltaLayer::clear() {
+        for(VertexId i = 0; i < numTouched; i++) {
+            VertexId v = touched[i];
+            while(inserts.getAdjSize(v) > 0) {
+                inserts.removeEdgeAt(v, inserts.getAdjSize(v) - 1);
+            }
+            tombstoneSizes[v] = 0;
+            isTouched[v] = false;
+        }
+        numTouched = 0;
+        numInsertEntries = 0;
+        numTombstoneEntries = 0;
+    }
+
+    // ----- DeltaGraph
+
+    static bool byDestination(const Edge& a, const Edge& b) {
+        return a.destination < b.destination;
+    }
+
+    template <typename G>
+    CsrGraph* DeltaGraph::mergeLayers(const G& below, const DeltaLayer* layer) {
+        VertexId n = below.getNumVertices();
+        std::size_t* offsets = MemoryPolicy::allocateArray<std::size_t>(static_cast<std::size_t>(n) + 1);
+        offsets[0] = 0;
+        for(VertexId v = 0; v < n; v++) {
+            std::size_t degree = 0;
+            for(typename G::NeighborIterator it = below.neighbors(v); !it.done(); it.next()) {
+                if(layer == nullptr || !layer->isTombstoned(v, it.destination())) {
+                    degree++;
+                }
+            }
+            if(layer != nullptr) {
+                degree += static_cast<std::size_t>(layer->getInserts().getAdjSize(v));
+            }
+            offsets[v + 1] = offsets[v] + degree;
+        }
+
+        Edge* edges = nullptr;
+        try {
+            edges = MemoryPolicy::allocateArray<Edge>(offsets[n]);
+        } catch(...) {
+            MemoryPolicy::releaseArray(offsets, static_cast<std::size_t>(n) + 1);
+            throw;
+        }
+        for(VertexId v = 0; v < n; v++) {
+            Edge* out = edges + offsets[v];
+            for(typename G::NeighborIterator it = below.neighbors(v); !it.done(); it.next()) {
+                if(layer == nullptr || !layer->isTombstoned(v, it.destination())) {
+                    out->destination = it.destination();
+                    out->weight = it.weight();
+                    out++;
+                }
+            }
+            if(layer != nullptr) {
+                const Edge* added = layer->getInserts().getAdjList(v);
+                for(int i = 0; i < layer->getInserts().getAdjSize(v); i++) {
+                    *out++ = added[i];
+                }
+            }
+            std::sort(edges + offsets[v], edges + offsets[v + 1], byDestination);
+        }
+        try {
+            return new CsrGraph(n, offsets, edges);
+        } catch(...) {
+            MemoryPolicy::releaseArray(edges, offsets[n]);
+            MemoryPolicy::releaseArray(offsets, static_cast<std::size_t>(n) + 1);
+            throw;
+        }
+    }
+
+    DeltaGraph::DeltaGraph(const Graph& g, std::size_t compactionEntries)
+        : numVertices(g.getNumVertices()), base(nullptr), sealed(nullptr), active(nullptr),
+          degrees(nullptr), numAdjEntries(g.getNumAdjEntries()),
+          compactionThreshold(compactionEntries > 0 ? compactionEntries : 1), spare(nullptr),
+          compacted(nullptr), compactionDone(false)
+    {
+        base = mergeLayers(g, nullptr);
+        active = new DeltaLayer(numVertices);
+        spare = new DeltaLayer(numVertices);
+        degrees = new int[numVertices];
+        for(VertexId v = 0; v < numVertices; v++) {
+            degrees[v] = g.getAdjSize(v);
+        }
+    }
+
+    // A result or an error still pending is dropped with the layers
+    DeltaGraph::~DeltaGraph() {
+        joinCompactor();
+        delete compacted;
+        delete base;
+        delete sealed;
+        delete active;
+        delete spare;
+        delete[] degrees;
+    }
+
+    // Move constructor
+    DeltaGraph::DeltaGraph(DeltaGraph&& other) noexcept
+        : numVertices(0), base(nullptr), sealed(nullptr), active(nullptr), degrees(nullptr),
+          numAdjEntries(0), compactionThreshold(other.compactionThreshold), spare(nullptr),
+          compacted(nullptr), compactionDone(false)
+    {
+        swap(other);
+    }
+
+    // Move assignment
+    DeltaGraph& DeltaGraph::operator=(DeltaGraph&& other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    // The compactor points at 'this', so both compactor threads finish before anything moves
+    // (a finished result or error moves with its graph and is installed / rethrown later)
+    void DeltaGraph::swap(DeltaGraph& other) noexcept {
+        joinCompactor();
+        other.joinCompactor();
+
+        VertexId tmpVertices = numVertices;
+        numVertices = other.numVertices;
+        other.numVertices = tmpVertices;
+
+        CsrGraph* tmpBase = base;
+        base = other.base;
+        other.base = tmpBase;
+
+        DeltaLayer* tmpSealed = sealed;
+        sealed = other.sealed;
+        other.sealed = tmpSealed;
+
+        DeltaLayer* tmpActive = active;
+        active = other.active;
+        other.active = tmpActive;
+
+        DeltaLayer* tmpSpare = spare;
+        spare = other.spare;
+        other.spare = tmpSpare;
+
+        CsrGraph* tmpCompacted = compacted;
+        compacted = other.compacted;
+        other.compacted = tmpCompacted;
+
+        compactionError.swap(other.compactionError);
+
+        bool tmpDone = compactionDone.load();
+        compactionDone.store(other.compactionDone.load());
+        other.compactionDone.store(tmpDone);
+
+        int* tmpDegrees = degrees;
+        degrees = other.degrees;
+        other.degrees = tmpDegrees;
+
+        std::size_t tmpEntries = numAdjEntries;
+        numAdjEntries = other.numAdjEntries;
+        other.numAdjEntries = tmpEntries;
+
+        std::size_t tmpThreshold = compactionThreshold;
+        compactionThreshold = other.compactionThreshold;
+        other.compactionThreshold = tmpThreshold;
+    }
+
+    // Visible in the base or the sealed layer, and not removed in the active layer
+    bool DeltaGraph::visibleBelowActive(VertexId source, VertexId dest) const {
+        if(active->isTombstoned(source, dest)) {
+            return false;
+        }
+        Weight weight;
+        if(sealed != nullptr) {
+            if(sealed->findInsert(source, dest, weight)) {
+                return true;
+            }
+            if(sealed->isTombstoned(source, dest)) {
+                return false;
+            }
+        }
+        const Edge* list = base->getAdjList(source);
+        const Edge* end = list + base->getAdjSize(source);
+        Edge key;
+        key.destination = dest;
+        key.weight = Weight();
+        const Edge* pos = std::lower_bound(list, end, key, byDestination);
+        return pos != end && pos->destination == dest;
+    }
+
+    bool DeltaGraph::hasEdge(VertexId source, VertexId dest) const {
+        if(!isValidVertex(source, numVertices) || !isValidVertex(dest, numVertices)) {
+            return false;
+        }
+        Weight weight;
+        return active->findInsert(source, dest, weight) || visibleBelowActive(source, dest);
+    }
+
+    void DeltaGraph::addEdge(VertexId source, VertexId dest, Weight weight) {
+        if(!isValidVertex(source, numVertices) || !isValidVertex(dest, numVertices)) {
+            std::cerr << "Invalid vertex.\n";
+            return;
+        }
+        if(source == dest) {
+            std::cerr << "Simple graph: no loops allowed.\n";
+            return;
+        }
+        installIfDone();
+
+        // Replacing an edge: hide the old copy first
+        if(hasEdge(source, dest)) {
+            if(!active->eraseInsert(source, dest)) {
+                active->addTombstone(source, dest);
+            }
+        } else {
+            degrees[source]++;
+            degrees[dest]++;
+            numAdjEntries += 2;
+        }
+        active->insert(source, dest, weight);
+
+        if(sealed == nullptr && active->size() >= compactionThreshold) {
+            startCompaction();
+        }
+    }
+
+    void DeltaGraph::removeEdge(VertexId source, VertexId dest) {
+        if(!isValidVertex(source, numVertices) || !isValidVertex(dest, numVertices)) {
+            throw "Invalid vertices for removeEdge.";
+        }
+        installIfDone();
+
+        if(!active->eraseInsert(source, dest)) {
+            if(!visibleBelowActive(source, dest)) {
+                throw "Edge does not exist.";
+            }
+            active->addTombstone(source, dest);
+        }
+        degrees[source]--;
+        degrees[dest]--;
+        numAdjEntries -= 2;
+
+        if(sealed == nullptr && active->size() >= compactionThreshold) {
+            startCompaction();
+        }
+    }
+
+    // Seal the active layer and merge it with the base on another thread. The spare layer
+    // becomes the active one, so nothing O(n) is allocated here.
+    void DeltaGraph::startCompaction() {
+        sealed = active;
+        active = spare;
+        spare = nullptr;
+        compactionDone = false;
+        compactor = std::thread([this]() {
+            try {
+                compacted = mergeLayers(*base, sealed);
+            } catch(...) {
+                compactionError = std::current_exception();
+            }
+            compactionDone.store(true, std::memory_order_release);
+        });
+    }
+
+    // Never waits for the compactor: installs its result, or rethrows its error, once it has finished.
+    // After a failed merge nothing is pending and the sealed layer waits for waitForCompaction().
+    void DeltaGraph::installIfDone() {
+        if(sealed != nullptr && compactionDone.load(std::memory_order_acquire)
+           && (compacted != nullptr || compactionError)) {
+            waitForCompaction();
+        }
+    }
+
+    void DeltaGraph::joinCompactor() noexcept {
+        if(compactor.joinable()) {
+            compactor.join();
+        }
+    }
+
+    void DeltaGraph::waitForCompaction() {
+        if(sealed == nullptr) {
+            return;
+        }
+        joinCompactor();
+        if(compactionError) {
+            std::exception_ptr error = compactionError;
+            compactionError = nullptr;
+            std::rethrow_exception(error);
+        }
+        if(compacted == nullptr) {
+            // An earlier merge failed: retry it on this thread
+            compacted = mergeLayers(*base, sealed);
+        }
+        delete base;
+        base = compacted;
+        compacted = nullptr;
+
+        // The sealed layer is cleared in O(entries) and kept for the next compaction
+        sealed->clear();
+        spare = sealed;
+        sealed = nullptr;
+    }
+
+    void DeltaGraph::compact() {
+        waitForCompaction();
+        if(active != nullptr && active->size() > 0) {
+            startCompaction();
+            waitForCompaction();
+        }
+    }
+
+    Graph DeltaGraph::toGraph() const {
+        Graph g(numVertices);
+        for(VertexId v = 0; v < numVertices; v++) {
+            for(NeighborIterator it = neighbors(v); !it.done(); it.next()) {
+                if(v < it.destination()) {
+                    g.addEdge(v, it.destination(), it.weight());
+                }
+            }
+        }
+        return g;
+    }
+
+    bool DeltaGraph::hasNegativeWeight() const {
+        for(VertexId v = 0; v < numVertices; v++) {
+            for(NeighborIterator it = neighbors(v); !it.done(); it.next()) {
+                if(isNegativeWeight(it.weight())) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    void DeltaGraph::printGraph() const {
+        std::cout << "Graph adjacency list:\n";
+        for(VertexId v = 0; v < numVertices; v++) {
+            std::cout << "Vertex " << v << ": ";
+            for(NeighborIterator it = neighbors(v); !it.done(); it.next()) {
+                std::cout << "(" << it.destination()
+                          << ", w=" << printableWeight(it.weight()) << ") ";
+            }
+            std::cout << "\n";
+        }
+    }
+
+} // namespace graph
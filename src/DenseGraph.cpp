@@ -0,0 +1,206 @@
+// email: yaacovkrawiec@gmail.com
+
+#include "../include/DenseGraph.hpp"
+#include "../include/SimdKernels.hpp"
+#include "../include/MemoryPolicy.hpp"
+#include <cmath>
+#include <limits>
+#include <new>
+
+namespace graph {
+
+    // Entries without an edge hold 0, so the whole matrix can be scanned (vectorized for int weights)
+    inline bool anyNegativeEntry(const int* weights, std::size_t count) {
+        return simd::anyNegative(weights, count);
+    }
+    template <typename T>
+    static bool anyNegativeEntry(const T* weights, std::size_t count) {
+        for(std::size_t i = 0; i < count; i++) {
+            if(isNegativeWeight(weights[i])) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool DenseGraph::isDenseEnough(VertexId numberOfVertices, std::size_t adjEntries) {
+        if(numberOfVertices < MIN_VERTICES) {
+            return false;
+        }
+        double n = static_cast<double>(numberOfVertices);
+        return static_cast<double>(adjEntries) * 100.0 >= DENSITY_PERCENT * n * (n - 1);
+    }
+
+    std::size_t DenseGraph::matrixBytes(VertexId numberOfVertices) {
+        double n = static_cast<double>(numberOfVertices);
+        double bytes = n * n * sizeof(Weight) + n * std::ceil(n / 64) * sizeof(std::uint64_t) + n * sizeof(int);
+        return bytes < static_cast<double>(std::numeric_limits<std::size_t>::max())
+            ? static_cast<std::size_t>(bytes) : std::numeric_limits<std::size_t>::max();
+    }
+
+    bool DenseGraph::shouldConvert(VertexId numberOfVertices, std::size_t adjEntries) {
+        return isDenseEnough(numberOfVertices, adjEntries) && matrixBytes(numberOfVertices) <= AUTO_CONVERT_BYTES;
+    }
+
+    // Shared by both constructors: G is Graph or CsrGraph
+    template <typename G>
+    void DenseGraph::build(const G& g) {
+        numVertices = g.getNumVertices();
+        std::size_t n = static_cast<std::size_t>(numVertices);
+        if(n > 0 && n > std::numeric_limits<std::size_t>::max() / n) {
+            throw std::bad_alloc();
+        }
+        wordsPerRow = (n + 63) / 64;
+        bits = MemoryPolicy::allocateArray<std::uint64_t>(n * wordsPerRow);
+        weights = MemoryPolicy::allocateArray<Weight>(matrixSize());
+        degrees = new int[n > 0 ? n : 1];
+        for(std::size_t i = 0; i < n * wordsPerRow; i++) {
+            bits[i] = 0;
+        }
+        for(std::size_t i = 0; i < matrixSize(); i++) {
+            weights[i] = Weight();
+        }
+
+        numAdjEntries = 0;
+        for(VertexId v = 0; v < numVertices; v++) {
+            std::uint64_t* rowBits = bits + static_cast<std::size_t>(v) * wordsPerRow;
+            Weight* row = weights + static_cast<std::size_t>(v) * n;
+            degrees[v] = 0;
+            for(typename G::NeighborIterator it = g.neighbors(v); !it.done(); it.next()) {
+                VertexId d = it.destination();
+                std::uint64_t mask = std::uint64_t(1) << (d % 64);
+                if((rowBits[d / 64] & mask) == 0) {
+                    rowBits[d / 64] |= mask;
+                    row[d] = it.weight();
+                    degrees[v]++;
+                } else if(it.weight() < row[d]) {
+                    row[d] = it.weight();
+                }
+            }
+            numAdjEntries += degrees[v];
+        }
+    }
+
+    DenseGraph::DenseGraph(const Graph& g) {
+        build(g);
+    }
+
+    DenseGraph::DenseGraph(const CsrGraph& g) {
+        build(g);
+    }
+
+    void DenseGraph::release() {
+        if(bits != nullptr) {
+            MemoryPolicy::releaseArray(bits, static_cast<std::size_t>(numVertices) * wordsPerRow);
+            MemoryPolicy::releaseArray(weights, matrixSize());
+        }
+        delete[] degrees;
+        bits = nullptr;
+        weights = nullptr;
+        degrees = nullptr;
+    }
+
+    DenseGraph::~DenseGraph() {
+        release();
+    }
+
+    // Copy constructor
+    DenseGraph::DenseGraph(const DenseGraph& other)
+        : numVertices(other.numVertices), wordsPerRow(other.wordsPerRow), numAdjEntries(other.numAdjEntries)
+    {
+        std::size_t n = static_cast<std::size_t>(numVertices);
+        bits = MemoryPolicy::allocateArray<std::uint64_t>(n * wordsPerRow);
+        weights = MemoryPolicy::allocateArray<Weight>(matrixSize());
+        degrees = new int[n > 0 ? n : 1];
+        for(std::size_t i = 0; i < n * wordsPerRow; i++) {
+            bits[i] = other.bits[i];
+        }
+        for(std::size_t i = 0; i < matrixSize(); i++) {
+            weights[i] = other.weights[i];
+        }
+        for(std::size_t v = 0; v < n; v++) {
+            degrees[v] = other.degrees[v];
+        }
+    }
+
+    // operator= (copy-and-swap)
+    DenseGraph& DenseGraph::operator=(const DenseGraph& other) {
+        if(this != &other) {
+            DenseGraph copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    // Move constructor
+    DenseGraph::DenseGraph(DenseGraph&& other) noexcept
+        : numVertices(other.numVertices), wordsPerRow(other.wordsPerRow), bits(other.bits),
+          weights(other.weights), degrees(other.degrees), numAdjEntries(other.numAdjEntries)
+    {
+        other.numVertices = 0;
+        other.wordsPerRow = 0;
+        other.bits = nullptr;
+        other.weights = nullptr;
+        other.degrees = nullptr;
+        other.numAdjEntries = 0;
+    }
+
+    // Move assignment
+    DenseGraph& DenseGraph::operator=(DenseGraph&& other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    void DenseGraph::swap(DenseGraph& other) noexcept {
+        VertexId tmpVertices = numVertices;
+        numVertices = other.numVertices;
+        other.numVertices = tmpVertices;
+
+        std::size_t tmpWords = wordsPerRow;
+        wordsPerRow = other.wordsPerRow;
+        other.wordsPerRow = tmpWords;
+
+        std::uint64_t* tmpBits = bits;
+        bits = other.bits;
+        other.bits = tmpBits;
+
+        Weight* tmpWeights = weights;
+        weights = other.weights;
+        other.weights = tmpWeights;
+
+        int* tmpDegrees = degrees;
+        degrees = other.degrees;
+        other.degrees = tmpDegrees;
+
+        std::size_t tmpEntries = numAdjEntries;
+        numAdjEntries = other.numAdjEntries;
+        other.numAdjEntries = tmpEntries;
+    }
+
+    Weight DenseGraph::edgeWeight(VertexId source, VertexId dest) const {
+        if(!isValidVertex(source, numVertices) || !isValidVertex(dest, numVertices)) {
+            throw "Invalid vertices for edgeWeight.";
+        }
+        if(!hasEdge(source, dest)) {
+            throw "Edge does not exist.";
+        }
+        return getWeightRow(source)[dest];
+    }
+
+    bool DenseGraph::hasNegativeWeight() const {
+        return anyNegativeEntry(weights, matrixSize());
+    }
+
+    void DenseGraph::printGraph() const {
+        std::cout << "Graph adjacency list:\n";
+        for(VertexId v = 0; v < numVertices; v++) {
+            std::cout << "Vertex " << v << ": ";
+            for(NeighborIterator it = neighbors(v); !it.done(); it.next()) {
+                std::cout << "(" << it.destination()
+                          << ", w=" << printableWeight(it.weight()) << ") ";
+            }
+            std::cout << "\n";
+        }
+    }
+
+} // namespace graph
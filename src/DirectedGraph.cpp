@@ -0,0 +1,136 @@
+// email: yaacovkrawiec@gmail.com
+
+#include "../include/DirectedGraph.hpp"
+#include <utility>
+
+namespace graph {
+
+    DirectedGraph::DirectedGraph(VertexId numberOfVertices)
+        : AdjacencyLists(numberOfVertices, new SlabAllocator(), 0), inOffsets(nullptr), inEdges(nullptr)
+    {
+    }
+
+    DirectedGraph::DirectedGraph(VertexId numberOfVertices, BlockAllocator* edgeAllocator)
+        : AdjacencyLists(numberOfVertices, edgeAllocator, 0), inOffsets(nullptr), inEdges(nullptr)
+    {
+    }
+
+    DirectedGraph::~DirectedGraph() {
+        delete[] inOffsets;
+        delete[] inEdges;
+    }
+
+    // Copy constructor
+    DirectedGraph::DirectedGraph(const DirectedGraph& other)
+        : AdjacencyLists(other), inOffsets(nullptr), inEdges(nullptr)
+    {
+    }
+
+    // operator= (copy-and-swap)
+    DirectedGraph& DirectedGraph::operator=(const DirectedGraph& other) {
+        if(this != &other) {
+            DirectedGraph copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    // Move constructor
+    DirectedGraph::DirectedGraph(DirectedGraph&& other) noexcept
+        : AdjacencyLists(std::move(other)), inOffsets(other.inOffsets), inEdges(other.inEdges)
+    {
+        other.inOffsets = nullptr;
+        other.inEdges = nullptr;
+    }
+
+    // Move assignment
+    DirectedGraph& DirectedGraph::operator=(DirectedGraph&& other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    void DirectedGraph::swap(DirectedGraph& other) noexcept {
+        AdjacencyLists::swap(other);
+
+        std::size_t* tmpInOffsets = inOffsets;
+        inOffsets = other.inOffsets;
+        other.inOffsets = tmpInOffsets;
+
+        Edge* tmpInEdges = inEdges;
+        inEdges = other.inEdges;
+        other.inEdges = tmpInEdges;
+    }
+
+    void DirectedGraph::addEdge(VertexId source, VertexId dest, Weight weight) {
+        if(!checkNewEdge(source, dest, weight)) {
+            return;
+        }
+
+        if(adjacencySizes[source] == adjacencyCapacities[source]) {
+            expandEdgeList(source);
+        }
+        adjacencyList[source][ adjacencySizes[source] ].destination = dest;
+        adjacencyList[source][ adjacencySizes[source] ].weight = weight;
+        adjacencySizes[source]++;
+        dropInIndex();
+    }
+
+    void DirectedGraph::removeEdge(VertexId source, VertexId dest) {
+        if(!isValidVertex(source, numVertices) || !isValidVertex(dest, numVertices)) {
+            throw "Invalid vertices for removeEdge.";
+        }
+        for(int i = 0; i < adjacencySizes[source]; i++) {
+            if(adjacencyList[source][i].destination == dest) {
+                // Swap-with-last, same as Graph
+                adjacencyList[source][i] = adjacencyList[source][ adjacencySizes[source] - 1 ];
+                adjacencySizes[source]--;
+                dropInIndex();
+                return;
+            }
+        }
+        throw "Edge does not exist.";
+    }
+
+    // Counting sort of all edges by destination
+    void DirectedGraph::buildInIndex() const {
+        inOffsets = new std::size_t[static_cast<std::size_t>(numVertices) + 1];
+        for(std::size_t v = 0; v <= static_cast<std::size_t>(numVertices); v++) {
+            inOffsets[v] = 0;
+        }
+        for(VertexId u = 0; u < numVertices; u++) {
+            for(int i = 0; i < adjacencySizes[u]; i++) {
+                inOffsets[ adjacencyList[u][i].destination + 1 ]++;
+            }
+        }
+        for(VertexId v = 0; v < numVertices; v++) {
+            inOffsets[v + 1] += inOffsets[v];
+        }
+
+        inEdges = new Edge[ inOffsets[numVertices] ];
+        std::size_t* cursor = new std::size_t[numVertices];
+        for(VertexId v = 0; v < numVertices; v++) {
+            cursor[v] = inOffsets[v];
+        }
+        for(VertexId u = 0; u < numVertices; u++) {
+            for(int i = 0; i < adjacencySizes[u]; i++) {
+                const Edge& e = adjacencyList[u][i];
+                Edge& in = inEdges[ cursor[e.destination]++ ];
+                in.destination = u;
+                in.weight = e.weight;
+            }
+        }
+        delete[] cursor;
+    }
+
+    void DirectedGraph::dropInIndex() {
+        delete[] inOffsets;
+        delete[] inEdges;
+        inOffsets = nullptr;
+        inEdges = nullptr;
+    }
+
+    void DirectedGraph::printGraph() const {
+        printLists("Directed graph adjacency list:", " -> ");
+    }
+
+} // namespace graph
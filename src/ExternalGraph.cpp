@@ -0,0 +1,200 @@
+// email: yaacovkrawiec@gmail.com
+
+#include "../include/ExternalGraph.hpp"
+#include "../include/MemoryPolicy.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace graph {
+
+    // Reads 'count' bytes at 'pos', retrying short reads (false on error or end of file)
+    static bool readFully(int fd, void* bytes, std::size_t count, std::uint64_t pos) {
+        char* out = static_cast<char*>(bytes);
+        while(count > 0) {
+            ssize_t got = ::pread(fd, out, count, static_cast<off_t>(pos));
+            if(got <= 0) {
+                return false;
+            }
+            out += got;
+            count -= static_cast<std::size_t>(got);
+            pos += static_cast<std::uint64_t>(got);
+        }
+        return true;
+    }
+
+    static void readAhead(int fd, std::uint64_t pos, std::uint64_t length) {
+#ifdef POSIX_FADV_WILLNEED
+        ::posix_fadvise(fd, static_cast<off_t>(pos), static_cast<off_t>(length), POSIX_FADV_WILLNEED);
+#else
+        (void)fd; (void)pos; (void)length;
+#endif
+    }
+
+    // ----- ExternalScanner
+
+    ExternalScanner::ExternalScanner(const ExternalGraph& graph, bool readWeights)
+        : g(&graph), withWeights(readWeights), weightBuffer(nullptr),
+          bufferStart(0), bufferEnd(0), position(0), end(0)
+    {
+        capacity = graph.bufferBytes / sizeof(VertexId);
+        capacity = capacity < 16 ? 16 : capacity;
+        destBuffer = MemoryPolicy::allocateArray<VertexId>(capacity);
+        if(withWeights) {
+            weightBuffer = MemoryPolicy::allocateArray<Weight>(capacity);
+        }
+    }
+
+    ExternalScanner::~ExternalScanner() {
+        MemoryPolicy::releaseArray(destBuffer, capacity);
+        MemoryPolicy::releaseArray(weightBuffer, capacity);
+    }
+
+    void ExternalScanner::open(VertexId vertex) {
+        position = g->offsets[vertex];
+        end = g->offsets[vertex + 1];
+        if(position < end && (position < bufferStart || position >= bufferEnd)) {
+            refill(position);
+        }
+    }
+
+    // Loads the block starting at 'entry' and starts the read of the block after it
+    void ExternalScanner::refill(std::uint64_t entry) {
+        std::uint64_t remaining = g->numAdjEntries - entry;
+        std::size_t count = remaining < capacity ? static_cast<std::size_t>(remaining) : capacity;
+        if(!readFully(g->fd, destBuffer, count * sizeof(VertexId), g->destinationsPos + entry * sizeof(VertexId))
+           || (withWeights && !readFully(g->fd, weightBuffer, count * sizeof(Weight), g->weightsPos + entry * sizeof(Weight)))) {
+            throw "Cannot read graph file.";
+        }
+        bufferStart = entry;
+        bufferEnd = entry + count;
+
+        if(bufferEnd < g->numAdjEntries) {
+            readAhead(g->fd, g->destinationsPos + bufferEnd * sizeof(VertexId), capacity * sizeof(VertexId));
+            if(withWeights) {
+                readAhead(g->fd, g->weightsPos + bufferEnd * sizeof(Weight), capacity * sizeof(Weight));
+            }
+        }
+    }
+
+    // ----- ExternalGraph
+
+    ExternalGraph::ExternalGraph(const char* path, std::size_t bufferBytes_, std::size_t sortBytes_)
+        : numVertices(0), numAdjEntries(0), offsets(nullptr), fd(-1), destinationsPos(0), weightsPos(0),
+          negativeWeights(false), bufferBytes(bufferBytes_), sortBytes(sortBytes_)
+    {
+        fd = ::open(path, O_RDONLY);
+        if(fd < 0) {
+            throw "Cannot open graph file.";
+        }
+        GraphFileLayout layout;
+        const char* error = MappedGraph::readLayout(fd, layout);
+        if(error != nullptr) {
+            close();
+            throw error;
+        }
+
+        std::size_t count = static_cast<std::size_t>(layout.numVertices) + 1;
+        try {
+            offsets = MemoryPolicy::allocateArray<std::uint64_t>(count);
+        } catch(...) {
+            close();
+            throw;
+        }
+        numVertices = static_cast<VertexId>(layout.numVertices);
+        if(!readFully(fd, offsets, count * sizeof(std::uint64_t), layout.offsetsPos)) {
+            close();
+            throw "Graph file is truncated or corrupted.";
+        }
+        // The offsets are in memory anyway, so they are all checked
+        bool valid = offsets[0] == 0 && offsets[numVertices] == layout.numAdjEntries;
+        for(VertexId v = 0; valid && v < numVertices; v++) {
+            valid = offsets[v] <= offsets[v + 1];
+        }
+        if(!valid) {
+            close();
+            throw "Graph file is truncated or corrupted.";
+        }
+
+        numAdjEntries = static_cast<std::size_t>(layout.numAdjEntries);
+        destinationsPos = layout.destinationsPos;
+        weightsPos = layout.weightsPos;
+        negativeWeights = layout.negativeWeights;
+#ifdef POSIX_FADV_SEQUENTIAL
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL); // larger kernel read-ahead window
+#endif
+    }
+
+    void ExternalGraph::close() {
+        if(offsets != nullptr) {
+            MemoryPolicy::releaseArray(offsets, static_cast<std::size_t>(numVertices) + 1);
+        }
+        if(fd >= 0) {
+            ::close(fd);
+        }
+        offsets = nullptr;
+        fd = -1;
+        numVertices = 0;
+        numAdjEntries = 0;
+    }
+
+    ExternalGraph::~ExternalGraph() {
+        close();
+    }
+
+    // Move constructor
+    ExternalGraph::ExternalGraph(ExternalGraph&& other) noexcept
+        : numVertices(other.numVertices), numAdjEntries(other.numAdjEntries), offsets(other.offsets),
+          fd(other.fd), destinationsPos(other.destinationsPos), weightsPos(other.weightsPos),
+          negativeWeights(other.negativeWeights), bufferBytes(other.bufferBytes), sortBytes(other.sortBytes)
+    {
+        other.numVertices = 0;
+        other.numAdjEntries = 0;
+        other.offsets = nullptr;
+        other.fd = -1;
+    }
+
+    // Move assignment
+    ExternalGraph& ExternalGraph::operator=(ExternalGraph&& other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    void ExternalGraph::swap(ExternalGraph& other) noexcept {
+        VertexId tmpVertices = numVertices;
+        numVertices = other.numVertices;
+        other.numVertices = tmpVertices;
+
+        std::size_t tmpEntries = numAdjEntries;
+        numAdjEntries = other.numAdjEntries;
+        other.numAdjEntries = tmpEntries;
+
+        std::uint64_t* tmpOffsets = offsets;
+        offsets = other.offsets;
+        other.offsets = tmpOffsets;
+
+        int tmpFd = fd;
+        fd = other.fd;
+        other.fd = tmpFd;
+
+        std::uint64_t tmpPos = destinationsPos;
+        destinationsPos = other.destinationsPos;
+        other.destinationsPos = tmpPos;
+
+        tmpPos = weightsPos;
+        weightsPos = other.weightsPos;
+        other.weightsPos = tmpPos;
+
+        bool tmpNegative = negativeWeights;
+        negativeWeights = other.negativeWeights;
+        other.negativeWeights = tmpNegative;
+
+        std::size_t tmpBytes = bufferBytes;
+        bufferBytes = other.bufferBytes;
+        other.bufferBytes = tmpBytes;
+
+        tmpBytes = sortBytes;
+        sortBytes = other.sortBytes;
+        other.sortBytes = tmpBytes;
+    }
+
+} // namespace graph
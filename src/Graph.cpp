@@ -1,180 +1,499 @@
 // email: yaacovkrawiec@gmail.com
 
 #include "../include/Graph.hpp"
+#include "../include/CsrGraph.hpp"
+#include <algorithm>
+#include <limits>
+#include <thread>
+#include <utility>
 
 namespace graph {
 
-    Graph::Graph(int numberOfVertices)
-        : numVertices(numberOfVertices)
+    Graph::Graph()
+        : AdjacencyLists(sizeof(int)), sortedAdjacency(false)
     {
-        if(numberOfVertices <= 0) {
-            std::cerr << "Number of vertices must be positive.\n";
-            std::exit(1);
-        }
+    }
 
-        // Allocate arrays
-        adjacencyList = new Edge*[numVertices];
-        adjacencySizes = new int[numVertices];
-        adjacencyCapacities = new int[numVertices];
+    Graph::Graph(VertexId numberOfVertices)
+        : AdjacencyLists(numberOfVertices, new SlabAllocator(), sizeof(int)), sortedAdjacency(false)
+    {
+    }
 
-        // Initialize
-        for(int i = 0; i < numVertices; i++) {
-            adjacencyList[i] = nullptr;
-            adjacencySizes[i] = 0;
-            adjacencyCapacities[i] = 0;
-        }
+    Graph::Graph(VertexId numberOfVertices, BlockAllocator* edgeAllocator)
+        : AdjacencyLists(numberOfVertices, edgeAllocator, sizeof(int)), sortedAdjacency(false)
+    {
     }
 
     Graph::~Graph() {
-        // Free each adjacency sub-array
-        for(int i = 0; i < numVertices; i++) {
-            delete[] adjacencyList[i];
+    }
+
+    // Copy constructor (the twin indices are copied with the lists)
+    Graph::Graph(const Graph& other)
+        : AdjacencyLists(other), sortedAdjacency(other.sortedAdjacency)
+    {
+    }
+
+    // operator= (copy-and-swap: the old data is freed by the temporary)
+    Graph& Graph::operator=(const Graph& other) {
+        if(this != &other) {
+            Graph copy(other);
+            swap(copy);
         }
-        delete[] adjacencyList;
+        return *this;
+    }
 
-        // Free arrays
-        delete[] adjacencySizes;
-        delete[] adjacencyCapacities;
+    // Move constructor
+    Graph::Graph(Graph&& other) noexcept
+        : AdjacencyLists(std::move(other)), sortedAdjacency(other.sortedAdjacency)
+    {
+        other.sortedAdjacency = false;
     }
 
-    // Copy constructor
-    Graph::Graph(const Graph& other)
-        : numVertices(other.numVertices)
+    // Move assignment: our old data ends up in 'other' and is freed by its destructor
+    Graph& Graph::operator=(Graph&& other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    void Graph::swap(Graph& other) noexcept {
+        AdjacencyLists::swap(other);
+
+        bool tmpSorted = sortedAdjacency;
+        sortedAdjacency = other.sortedAdjacency;
+        other.sortedAdjacency = tmpSorted;
+    }
+
+    // Edge-list constructor: same as Graph(n) followed by addEdges(...)
+    Graph::Graph(VertexId numberOfVertices, const VertexId* src, const VertexId* dst, const Weight* weights, std::size_t numEdges)
+        : AdjacencyLists(numberOfVertices, new SlabAllocator(), sizeof(int)), sortedAdjacency(false)
     {
-        adjacencyList = new Edge*[numVertices];
-        adjacencySizes = new int[numVertices];
-        adjacencyCapacities = new int[numVertices];
+        addEdges(src, dst, weights, numEdges);
+    }
 
-        for(int i = 0; i < numVertices; i++) {
-            adjacencySizes[i] = other.adjacencySizes[i];
-            adjacencyCapacities[i] = other.adjacencyCapacities[i];
+    void Graph::reserveVertices(VertexId count) {
+        if(count > vertexCapacity) {
+            growVertexArrays(count);
+        }
+    }
 
-            adjacencyList[i] = new Edge[ adjacencyCapacities[i] ];
-            for(int j = 0; j < adjacencySizes[i]; j++) {
-                adjacencyList[i][j] = other.adjacencyList[i][j];
-            }
+    VertexId Graph::addVertex() {
+        const VertexId maxVertices = std::numeric_limits<VertexId>::max();
+        if(numVertices == maxVertices) {
+            throw "Too many vertices for VertexId.";
+        }
+        if(numVertices == vertexCapacity) {
+            VertexId newCapacity = (vertexCapacity < 4) ? 4 : vertexCapacity;
+            newCapacity = (newCapacity <= maxVertices / 2) ? newCapacity * 2 : maxVertices;
+            growVertexArrays(newCapacity);
         }
+        return numVertices++;
     }
 
-    // operator=
-    Graph& Graph::operator=(const Graph& other) {
-        if(this == &other) {
-            return *this;
+    void Graph::addEdge(VertexId source, VertexId dest, Weight weight) {
+        if(!checkNewEdge(source, dest, weight)) {
+            return;
         }
 
-        // Free old data
-        for(int i = 0; i < numVertices; i++) {
-            delete[] adjacencyList[i];
+        // Make room in both lists first so the twin indices are known
+        if(adjacencySizes[source] == adjacencyCapacities[source]) {
+            expandEdgeList(source);
+        }
+        if(adjacencySizes[dest] == adjacencyCapacities[dest]) {
+            expandEdgeList(dest);
         }
-        delete[] adjacencyList;
-        delete[] adjacencySizes;
-        delete[] adjacencyCapacities;
+        int srcIndex = openEntry(source, dest);
+        int destIndex = openEntry(dest, source);
 
-        // Copy new data
-        numVertices = other.numVertices;
-        adjacencyList = new Edge*[numVertices];
-        adjacencySizes = new int[numVertices];
-        adjacencyCapacities = new int[numVertices];
+        // Add (dest, weight) to adjacencyList[source]
+        adjacencyList[source][srcIndex].destination = dest;
+        adjacencyList[source][srcIndex].weight = weight;
+        twinsOf(source)[srcIndex] = destIndex;
 
-        for(int i = 0; i < numVertices; i++) {
-            adjacencySizes[i] = other.adjacencySizes[i];
-            adjacencyCapacities[i] = other.adjacencyCapacities[i];
-            adjacencyList[i] = new Edge[ adjacencyCapacities[i] ];
-            for(int j = 0; j < adjacencySizes[i]; j++) {
-                adjacencyList[i][j] = other.adjacencyList[i][j];
-            }
+        // Add (source, weight) to adjacencyList[dest]
+        adjacencyList[dest][destIndex].destination = source;
+        adjacencyList[dest][destIndex].weight = weight;
+        twinsOf(dest)[destIndex] = srcIndex;
+    }
+
+    int Graph::openEntry(VertexId vertex, VertexId dest) {
+        int size = adjacencySizes[vertex]++;
+        if(!sortedAdjacency) {
+            return size;
         }
-        return *this;
+        // After any equal destinations, so repeated edges keep their insertion order
+        Edge* list = adjacencyList[vertex];
+        int* twins = twinsOf(vertex);
+        int index = size;
+        while(index > 0 && list[index - 1].destination > dest) {
+            list[index] = list[index - 1];
+            twins[index] = twins[index - 1];
+            relinkTwin(vertex, index);
+            index--;
+        }
+        return index;
     }
 
-    void Graph::expandEdgeList(int vertex) {
-        int oldCap = adjacencyCapacities[vertex];
-        int newCap = (oldCap == 0) ? 2 : oldCap * 2;
-        Edge* newArray = new Edge[newCap];
+    // Bulk insertion in two passes:
+    //   1) validate the edges and give both entries of every edge their final slot
+    //      (appending in input order, exactly like repeated addEdge calls),
+    //   2) grow every adjacency array at most once, then fill the slots in parallel.
+    void Graph::addEdges(const VertexId* src, const VertexId* dst, const Weight* weights, std::size_t numEdges) {
+        int* extra = new int[numVertices];
+        for(VertexId v = 0; v < numVertices; v++) {
+            extra[v] = 0;
+        }
 
-        for(int i = 0; i < adjacencySizes[vertex]; i++) {
-            newArray[i] = adjacencyList[vertex][i];
+        // srcSlot[e] / dstSlot[e] = index of edge e in the lists of src[e] / dst[e] (-1 = skipped)
+        int* srcSlot = new int[numEdges > 0 ? numEdges : 1];
+        int* dstSlot = new int[numEdges > 0 ? numEdges : 1];
+
+        std::size_t skipped = 0;
+        std::size_t negative = 0;
+        for(std::size_t e = 0; e < numEdges; e++) {
+            if(!isValidEdge(src[e], dst[e])) {
+                srcSlot[e] = -1;
+                dstSlot[e] = -1;
+                skipped++;
+                continue;
+            }
+            if(weights != nullptr && isNegativeWeight(weights[e])) {
+                negative++;
+            }
+            srcSlot[e] = adjacencySizes[src[e]] + extra[src[e]]++;
+            dstSlot[e] = adjacencySizes[dst[e]] + extra[dst[e]]++;
+        }
+        // One summary line instead of a message per edge
+        if(skipped > 0) {
+            std::cerr << "Skipped " << skipped << " invalid edge(s) (bad vertex or loop).\n";
+        }
+        if(negative > 0) {
+            std::cerr << "Warning: " << negative << " negative edge weight(s). Dijkstra may fail if used.\n";
         }
 
-        delete[] adjacencyList[vertex];
-        adjacencyList[vertex] = newArray;
-        adjacencyCapacities[vertex] = newCap;
-    }
+        // Allocate each array exactly once (rounded up to a power of two like expandEdgeList)
+        for(VertexId v = 0; v < numVertices; v++) {
+            int needed = adjacencySizes[v] + extra[v];
+            if(needed > adjacencyCapacities[v]) {
+                int newCap = 2;
+                while(newCap < needed) {
+                    newCap *= 2;
+                }
+                resizeEdgeList(v, newCap);
+            }
+        }
 
-    void Graph::addEdge(int source, int dest, int weight) {
-        if(source < 0 || source >= numVertices || dest < 0 || dest >= numVertices) {
-            std::cerr << "Invalid vertex.\n";
-            return;
+        // Every entry already has its own slot, so the edges can be split into
+        // equal ranges and written by several threads without any locking.
+        int numThreads = 1;
+        if(numEdges >= PARALLEL_FILL_THRESHOLD) {
+            numThreads = static_cast<int>(std::thread::hardware_concurrency());
+            if(numThreads < 1) {
+                numThreads = 1;
+            }
         }
-        if(source == dest) {
-            std::cerr << "Simple graph: no loops allowed.\n";
-            return;
+
+        if(numThreads == 1) {
+            fillEdges(src, dst, weights, srcSlot, dstSlot, 0, numEdges);
+        } else {
+            std::thread* workers = new std::thread[numThreads];
+            std::size_t perThread = numEdges / numThreads + 1;
+            for(int i = 0; i < numThreads; i++) {
+                std::size_t first = perThread * i;
+                std::size_t end = (first + perThread < numEdges) ? first + perThread : numEdges;
+                if(first > numEdges) {
+                    first = numEdges;
+                }
+                workers[i] = std::thread(&Graph::fillEdges, this, src, dst, weights, srcSlot, dstSlot, first, end);
+            }
+            for(int i = 0; i < numThreads; i++) {
+                workers[i].join();
+            }
+            delete[] workers;
         }
-        // For Dijkstra (or BFS/DFS), if negative is not allowed, we might just warn or throw
-        if(weight < 0) {
-            std::cerr << "Warning: negative edge weight. Dijkstra may fail if used.\n";
+
+        for(VertexId v = 0; v < numVertices; v++) {
+            adjacencySizes[v] += extra[v];
         }
 
-        // Add (dest, weight) to adjacencyList[source]
-        if(adjacencySizes[source] == adjacencyCapacities[source]) {
-            expandEdgeList(source);
+        delete[] srcSlot;
+        delete[] dstSlot;
+        delete[] extra;
+
+        // Appending and sorting once is cheaper than numEdges sorted insertions
+        if(sortedAdjacency && numEdges > 0) {
+            sortAllLists();
         }
-        adjacencyList[source][ adjacencySizes[source] ].destination = dest;
-        adjacencyList[source][ adjacencySizes[source] ].weight = weight;
-        adjacencySizes[source]++;
+    }
 
-        // Add (source, weight) to adjacencyList[dest]
-        if(adjacencySizes[dest] == adjacencyCapacities[dest]) {
-            expandEdgeList(dest);
+    // Write edges [firstEdge, endEdge) into the slots chosen by addEdges
+    void Graph::fillEdges(const VertexId* src, const VertexId* dst, const Weight* weights,
+                          const int* srcSlot, const int* dstSlot, std::size_t firstEdge, std::size_t endEdge) {
+        for(std::size_t e = firstEdge; e < endEdge; e++) {
+            if(srcSlot[e] < 0) {
+                continue;
+            }
+            VertexId s = src[e];
+            VertexId d = dst[e];
+            Weight w = (weights != nullptr) ? weights[e] : Weight(1);
+
+            Edge& forward = adjacencyList[s][ srcSlot[e] ];
+            forward.destination = d;
+            forward.weight = w;
+            twinsOf(s)[ srcSlot[e] ] = dstSlot[e];
+
+            Edge& backward = adjacencyList[d][ dstSlot[e] ];
+            backward.destination = s;
+            backward.weight = w;
+            twinsOf(d)[ dstSlot[e] ] = srcSlot[e];
         }
-        adjacencyList[dest][ adjacencySizes[dest] ].destination = source;
-        adjacencyList[dest][ adjacencySizes[dest] ].weight = weight;
-        adjacencySizes[dest]++;
     }
 
-    void Graph::removeEdge(int source, int dest) {
-        if(source < 0 || source >= numVertices || dest < 0 || dest >= numVertices) {
+    void Graph::removeEdge(VertexId source, VertexId dest) {
+        if(!isValidVertex(source, numVertices) || !isValidVertex(dest, numVertices)) {
             throw "Invalid vertices for removeEdge.";
         }
-        bool foundSrc = false;
-        for(int i = 0; i < adjacencySizes[source]; i++) {
-            if(adjacencyList[source][i].destination == dest) {
-                foundSrc = true;
-                for(int j = i; j < adjacencySizes[source] - 1; j++) {
-                    adjacencyList[source][j] = adjacencyList[source][j+1];
-                }
-                adjacencySizes[source]--;
-                break;
+
+        // Only the shorter list has to be searched; the twin index gives the other entry
+        VertexId from = source;
+        VertexId to = dest;
+        if(adjacencySizes[dest] < adjacencySizes[source]) {
+            from = dest;
+            to = source;
+        }
+        int index = findEntry(from, to);
+        if(index < 0) {
+            throw "Edge does not exist.";
+        }
+        removeEdgeAt(from, index);
+    }
+
+    void Graph::removeEdgeAt(VertexId vertex, int index) {
+        if(!isValidVertex(vertex, numVertices) || index < 0 || index >= adjacencySizes[vertex]) {
+            throw "Invalid edge index for removeEdgeAt.";
+        }
+        VertexId other = adjacencyList[vertex][index].destination;
+        int otherIndex = twinsOf(vertex)[index];
+        removeEntry(vertex, index);
+        removeEntry(other, otherIndex);
+    }
+
+    // Swap-with-last removal of one directed entry, fixing the twin of the moved entry.
+    // Sorted lists shift the tail left instead, fixing the twin of every moved entry.
+    void Graph::removeEntry(VertexId vertex, int index) {
+        int last = adjacencySizes[vertex] - 1;
+        Edge* list = adjacencyList[vertex];
+        int* twins = twinsOf(vertex);
+        if(sortedAdjacency) {
+            for(int i = index; i < last; i++) {
+                list[i] = list[i + 1];
+                twins[i] = twins[i + 1];
+                relinkTwin(vertex, i);
             }
+        } else if(index != last) {
+            list[index] = list[last];
+            twins[index] = twins[last];
+            relinkTwin(vertex, index);
         }
+        adjacencySizes[vertex]--;
+    }
 
-        bool foundDest = false;
-        for(int i = 0; i < adjacencySizes[dest]; i++) {
-            if(adjacencyList[dest][i].destination == source) {
-                foundDest = true;
-                for(int j = i; j < adjacencySizes[dest] - 1; j++) {
-                    adjacencyList[dest][j] = adjacencyList[dest][j+1];
-                }
-                adjacencySizes[dest]--;
-                break;
+    static bool byDestination(const Edge& a, const Edge& b) {
+        return a.destination < b.destination;
+    }
+
+    int Graph::findEntry(VertexId vertex, VertexId dest) const {
+        const Edge* list = adjacencyList[vertex];
+        int size = adjacencySizes[vertex];
+        if(sortedAdjacency) {
+            Edge key;
+            key.destination = dest;
+            key.weight = Weight();
+            const Edge* pos = std::lower_bound(list, list + size, key, byDestination);
+            return (pos != list + size && pos->destination == dest) ? static_cast<int>(pos - list) : -1;
+        }
+        for(int i = 0; i < size; i++) {
+            if(list[i].destination == dest) {
+                return i;
             }
         }
+        return -1;
+    }
 
-        if(!foundSrc || !foundDest) {
+    bool Graph::hasEdge(VertexId source, VertexId dest) const {
+        if(!isValidVertex(source, numVertices) || !isValidVertex(dest, numVertices)) {
+            return false;
+        }
+        if(adjacencySizes[dest] < adjacencySizes[source]) {
+            return findEntry(dest, source) >= 0;
+        }
+        return findEntry(source, dest) >= 0;
+    }
+
+    Weight Graph::edgeWeight(VertexId source, VertexId dest) const {
+        if(!isValidVertex(source, numVertices) || !isValidVertex(dest, numVertices)) {
+            throw "Invalid vertices for edgeWeight.";
+        }
+        VertexId from = source;
+        VertexId to = dest;
+        if(adjacencySizes[dest] < adjacencySizes[source]) {
+            from = dest;
+            to = source;
+        }
+        int index = findEntry(from, to);
+        if(index < 0) {
             throw "Edge does not exist.";
         }
+        return adjacencyList[from][index].weight;
     }
 
-    void Graph::printGraph() const {
-        std::cout << "Graph adjacency list:\n";
-        for(int v = 0; v < numVertices; v++) {
-            std::cout << "Vertex " << v << ": ";
+    void Graph::setSortedAdjacency(bool sorted) {
+        if(sorted && !sortedAdjacency) {
+            sortAllLists();
+        }
+        sortedAdjacency = sorted;
+    }
+
+    // Orders the entries of one list by destination (ties by position, so the sort is stable)
+    struct EntryOrder {
+        const Edge* list;
+        bool operator()(int a, int b) const {
+            return list[a].destination < list[b].destination
+                || (list[a].destination == list[b].destination && a < b);
+        }
+    };
+
+    // Every list is permuted independently, so the twin indices are rebuilt through
+    // newIndex[] (old position -> new position, flat over all lists) before anything moves
+    void Graph::sortAllLists() {
+        std::size_t* offsets = new std::size_t[static_cast<std::size_t>(numVertices) + 1];
+        offsets[0] = 0;
+        int maxDegree = 0;
+        for(VertexId v = 0; v < numVertices; v++) {
+            offsets[v + 1] = offsets[v] + adjacencySizes[v];
+            maxDegree = adjacencySizes[v] > maxDegree ? adjacencySizes[v] : maxDegree;
+        }
+        std::size_t total = offsets[numVertices];
+        int* order = new int[total > 0 ? total : 1];
+        int* newIndex = new int[total > 0 ? total : 1];
+        for(VertexId v = 0; v < numVertices; v++) {
+            int* vertexOrder = order + offsets[v];
+            bool sorted = true;
             for(int i = 0; i < adjacencySizes[v]; i++) {
-                std::cout << "(" << adjacencyList[v][i].destination 
-                          << ", w=" << adjacencyList[v][i].weight << ") ";
+                vertexOrder[i] = i;
+                if(i > 0 && adjacencyList[v][i - 1].destination > adjacencyList[v][i].destination) {
+                    sorted = false;
+                }
+            }
+            if(!sorted) {
+                EntryOrder byEntry = { adjacencyList[v] };
+                std::sort(vertexOrder, vertexOrder + adjacencySizes[v], byEntry);
             }
-            std::cout << "\n";
+            for(int i = 0; i < adjacencySizes[v]; i++) {
+                newIndex[offsets[v] + vertexOrder[i]] = i;
+            }
+        }
+
+        int* newTwins = new int[total > 0 ? total : 1];
+        for(VertexId v = 0; v < numVertices; v++) {
+            const int* twins = twinsOf(v);
+            for(int i = 0; i < adjacencySizes[v]; i++) {
+                int old = order[offsets[v] + i];
+                VertexId partner = adjacencyList[v][old].destination;
+                newTwins[offsets[v] + i] = newIndex[offsets[partner] + twins[old]];
+            }
+        }
+
+        Edge* scratch = new Edge[maxDegree > 0 ? maxDegree : 1];
+        for(VertexId v = 0; v < numVertices; v++) {
+            Edge* list = adjacencyList[v];
+            int* twins = twinsOf(v);
+            for(int i = 0; i < adjacencySizes[v]; i++) {
+                scratch[i] = list[ order[offsets[v] + i] ];
+            }
+            for(int i = 0; i < adjacencySizes[v]; i++) {
+                list[i] = scratch[i];
+                twins[i] = newTwins[offsets[v] + i];
+            }
+        }
+
+        delete[] scratch;
+        delete[] newTwins;
+        delete[] newIndex;
+        delete[] order;
+        delete[] offsets;
+    }
+
+    // First index in [from, size) whose destination is >= key: doubling steps, then a binary
+    // search inside the last step. O(log distance), so a walk through a hub list costs
+    // O(k log(d / k)) for k lookups instead of O(d).
+    static int gallop(const Edge* list, int from, int size, VertexId key) {
+        int step = 1;
+        int low = from;
+        int high = from;
+        while(high < size && list[high].destination < key) {
+            low = high + 1;
+            high += step;
+            step *= 2;
+        }
+        if(high > size) {
+            high = size;
         }
+        Edge probe;
+        probe.destination = key;
+        probe.weight = Weight();
+        return static_cast<int>(std::lower_bound(list + low, list + high, probe, byDestination) - list);
+    }
+
+    std::size_t Graph::countCommonNeighbors(VertexId u, VertexId v) const {
+        if(!isValidVertex(u, numVertices) || !isValidVertex(v, numVertices)) {
+            throw "Invalid vertices for countCommonNeighbors.";
+        }
+        if(!sortedAdjacency) {
+            throw "Adjacency lists are not sorted.";
+        }
+        const Edge* small = adjacencyList[u];
+        const Edge* large = adjacencyList[v];
+        int smallSize = adjacencySizes[u];
+        int largeSize = adjacencySizes[v];
+        if(smallSize > largeSize) {
+            std::swap(small, large);
+            std::swap(smallSize, largeSize);
+        }
+
+        std::size_t common = 0;
+        int i = 0;
+        int j = 0;
+        if(static_cast<long long>(smallSize) * GALLOP_RATIO < largeSize) {
+            // Hub: jump through the long list
+            for(; i < smallSize && j < largeSize; i++) {
+                j = gallop(large, j, largeSize, small[i].destination);
+                if(j < largeSize && large[j].destination == small[i].destination) {
+                    common++;
+                    j++;
+                }
+            }
+            return common;
+        }
+        while(i < smallSize && j < largeSize) {
+            if(small[i].destination < large[j].destination) {
+                i++;
+            } else if(large[j].destination < small[i].destination) {
+                j++;
+            } else {
+                common++;
+                i++;
+                j++;
+            }
+        }
+        return common;
+    }
+
+    void Graph::printGraph() const {
+        printLists("Graph adjacency list:", ": ");
+    }
+
+    CsrGraph Graph::freeze() const {
+        return CsrGraph(*this);
     }
 
 } // namespace graph
@@ -0,0 +1,451 @@
+// email: yaacovkrawiec@gmail.com
+
+#include "../include/GraphReader.hpp"
+#include <algorithm> // std::sort, std::inplace_merge, std::count
+#include <cmath>     // std::pow
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace graph {
+
+    // Read-only mapping of a whole text file
+    class TextFile {
+    private:
+        void* mapping;
+    public:
+        const char* begin;
+        const char* end;
+
+        TextFile(const TextFile& other) = delete;
+        TextFile& operator=(const TextFile& other) = delete;
+
+        explicit TextFile(const char* path) : mapping(nullptr), begin(nullptr), end(nullptr) {
+            int fd = ::open(path, O_RDONLY);
+            if(fd < 0) {
+                throw "Cannot open graph file.";
+            }
+            struct stat info;
+            if(::fstat(fd, &info) != 0) {
+                ::close(fd);
+                throw "Cannot open graph file.";
+            }
+            std::size_t bytes = static_cast<std::size_t>(info.st_size);
+            if(bytes > 0) {
+                void* address = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+                if(address == MAP_FAILED) {
+                    ::close(fd);
+                    throw "Cannot map graph file.";
+                }
+                ::madvise(address, bytes, MADV_SEQUENTIAL);
+                mapping = address;
+                begin = static_cast<const char*>(address);
+                end = begin + bytes;
+            }
+            ::close(fd);
+        }
+        ~TextFile() {
+            if(mapping != nullptr) {
+                ::munmap(mapping, static_cast<std::size_t>(end - begin));
+            }
+        }
+    };
+
+    struct ParsedEdge {
+        VertexId u;
+        VertexId v;
+        Weight w;
+    };
+
+    static bool edgeKeyLess(const ParsedEdge& a, const ParsedEdge& b) {
+        if(a.u != b.u) {
+            return a.u < b.u;
+        }
+        if(a.v != b.v) {
+            return a.v < b.v;
+        }
+        return a.w < b.w;
+    }
+
+    // Edges parsed by one thread (grows by doubling)
+    struct EdgeBuffer {
+        ParsedEdge* edges;
+        std::size_t size;
+        std::size_t capacity;
+        unsigned long long maxId;  // largest vertex id seen (after the 1-based shift)
+        const char* badLine;       // first malformed line, nullptr if none
+
+        EdgeBuffer() : edges(nullptr), size(0), capacity(0), maxId(0), badLine(nullptr) {}
+        ~EdgeBuffer() {
+            delete[] edges;
+        }
+        void push(unsigned long long u, unsigned long long v, Weight w) {
+            if(size == capacity) {
+                std::size_t newCap = (capacity == 0) ? 1024 : capacity * 2;
+                ParsedEdge* bigger = new ParsedEdge[newCap];
+                for(std::size_t i = 0; i < size; i++) {
+                    bigger[i] = edges[i];
+                }
+                delete[] edges;
+                edges = bigger;
+                capacity = newCap;
+            }
+            edges[size].u = static_cast<VertexId>(u);
+            edges[size].v = static_cast<VertexId>(v);
+            edges[size].w = w;
+            size++;
+            if(u > maxId) maxId = u;
+            if(v > maxId) maxId = v;
+        }
+    };
+
+    static bool isBlank(char c) {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    static void skipBlanks(const char*& p, const char* end) {
+        while(p < end && isBlank(*p)) {
+            p++;
+        }
+    }
+
+    static const char* nextLine(const char* p, const char* end) {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        return (newline != nullptr) ? newline + 1 : end;
+    }
+
+    // Unsigned decimal integer; false if there is no digit
+    static bool parseUnsigned(const char*& p, const char* end, unsigned long long& value) {
+        if(p == end || *p < '0' || *p > '9') {
+            return false;
+        }
+        unsigned long long result = 0;
+        while(p < end && *p >= '0' && *p <= '9') {
+            result = result * 10 + static_cast<unsigned long long>(*p - '0');
+            p++;
+        }
+        value = result;
+        return true;
+    }
+
+    // Decimal number with optional sign, fraction and exponent ("-3", "2.5", "1e-3")
+    static bool parseWeight(const char*& p, const char* end, Weight& out) {
+        bool negative = false;
+        if(p < end && (*p == '-' || *p == '+')) {
+            negative = (*p == '-');
+            p++;
+        }
+        unsigned long long intPart = 0;
+        bool hasDigits = parseUnsigned(p, end, intPart);
+        bool real = false;
+        double value = static_cast<double>(intPart);
+
+        if(p < end && *p == '.') {
+            real = true;
+            p++;
+            const char* fracStart = p;
+            unsigned long long fraction = 0;
+            if(parseUnsigned(p, end, fraction)) {
+                hasDigits = true;
+                value += static_cast<double>(fraction) / std::pow(10.0, static_cast<double>(p - fracStart));
+            }
+        }
+        if(!hasDigits) {
+            return false;
+        }
+        if(p < end && (*p == 'e' || *p == 'E')) {
+            real = true;
+            p++;
+            bool negativeExp = false;
+            if(p < end && (*p == '-' || *p == '+')) {
+                negativeExp = (*p == '-');
+                p++;
+            }
+            unsigned long long exponent = 0;
+            if(!parseUnsigned(p, end, exponent)) {
+                return false;
+            }
+            value *= std::pow(10.0, negativeExp ? -static_cast<double>(exponent) : static_cast<double>(exponent));
+        }
+
+        if(real) {
+            out = static_cast<Weight>(negative ? -value : value);
+        } else {
+            long long whole = static_cast<long long>(intPart);
+            out = static_cast<Weight>(negative ? -whole : whole);
+        }
+        return true;
+    }
+
+    // Parses the lines in [begin, end) (begin is the start of a line) into 'out'.
+    // 'base' is 1 for the 1-based formats.
+    static void parseChunk(const char* begin, const char* end, int format, unsigned long long base,
+                           EdgeBuffer* out) {
+        const char* p = begin;
+        while(p < end) {
+            const char* line = p;
+            skipBlanks(p, end);
+            if(p == end) {
+                break;
+            }
+
+            bool skipLine = false;
+            if(*p == '\n') {
+                skipLine = true;
+            } else if(format == GraphReader::DIMACS) {
+                if(*p == 'a') {
+                    p++;
+                } else if(*p == 'c' || *p == 'p') {
+                    skipLine = true;
+                } else {
+                    out->badLine = line;
+                    return;
+                }
+            } else if(*p == '#' || *p == '%') {
+                skipLine = true;
+            }
+
+            if(!skipLine) {
+                unsigned long long u = 0;
+                unsigned long long v = 0;
+                Weight w = 1;
+                skipBlanks(p, end);
+                bool ok = parseUnsigned(p, end, u);
+                skipBlanks(p, end);
+                ok = ok && parseUnsigned(p, end, v);
+                skipBlanks(p, end);
+                if(ok && p < end && *p != '\n') {
+                    ok = parseWeight(p, end, w);
+                }
+                if(!ok || u < base || v < base) {
+                    out->badLine = line;
+                    return;
+                }
+                out->push(u - base, v - base, w);
+            }
+            p = nextLine(p, end);
+        }
+    }
+
+    // std::sort on 'parts' slices in parallel, then pairwise merges (also in parallel)
+    static void sortSlice(ParsedEdge* first, ParsedEdge* last) {
+        std::sort(first, last, edgeKeyLess);
+    }
+    static void mergeSlices(ParsedEdge* first, ParsedEdge* middle, ParsedEdge* last) {
+        std::inplace_merge(first, middle, last, edgeKeyLess);
+    }
+    static void parallelSort(ParsedEdge* edges, std::size_t count, int parts) {
+        std::size_t* bounds = new std::size_t[parts + 1];
+        for(int i = 0; i <= parts; i++) {
+            bounds[i] = count / parts * i + count % parts * i / parts;
+        }
+        std::thread* workers = new std::thread[parts];
+        for(int i = 0; i < parts; i++) {
+            workers[i] = std::thread(sortSlice, edges + bounds[i], edges + bounds[i + 1]);
+        }
+        for(int i = 0; i < parts; i++) {
+            workers[i].join();
+        }
+        for(int width = 1; width < parts; width *= 2) {
+            int started = 0;
+            for(int i = 0; i + width < parts; i += 2 * width) {
+                int last = (i + 2 * width < parts) ? i + 2 * width : parts;
+                workers[started++] = std::thread(mergeSlices, edges + bounds[i], edges + bounds[i + width],
+                                                 edges + bounds[last]);
+            }
+            for(int i = 0; i < started; i++) {
+                workers[i].join();
+            }
+        }
+        delete[] workers;
+        delete[] bounds;
+    }
+
+    GraphReader::Format GraphReader::formatOf(const char* path) {
+        const char* dot = std::strrchr(path, '.');
+        if(dot != nullptr && std::strcmp(dot, ".mtx") == 0) {
+            return MATRIX_MARKET;
+        }
+        if(dot != nullptr && std::strcmp(dot, ".gr") == 0) {
+            return DIMACS;
+        }
+        return EDGE_LIST;
+    }
+
+    Graph GraphReader::read(const char* path) {
+        return read(path, formatOf(path));
+    }
+
+    Graph GraphReader::read(const char* path, Format format, bool removeDuplicates) {
+        TextFile file(path);
+        const char* body = file.begin;
+        const char* end = file.end;
+
+        // Header (serial): number of vertices for the formats that declare it
+        unsigned long long declaredVertices = 0;
+        if(format == MATRIX_MARKET) {
+            const char banner[] = "%%MatrixMarket";
+            const char* bannerEnd = (body != nullptr) ? nextLine(body, end) : end;
+            if(body == nullptr || static_cast<std::size_t>(end - body) < sizeof(banner) - 1
+               || std::memcmp(body, banner, sizeof(banner) - 1) != 0) {
+                throw "Not a Matrix Market file.";
+            }
+            const char coordinate[] = "coordinate";
+            if(std::search(body, bannerEnd, coordinate, coordinate + sizeof(coordinate) - 1) == bannerEnd) {
+                throw "Only the Matrix Market coordinate format is supported.";
+            }
+            body = bannerEnd;
+            while(body < end && (*body == '%' || *body == '\n')) {
+                body = nextLine(body, end);
+            }
+            unsigned long long rows = 0;
+            unsigned long long cols = 0;
+            const char* p = body;
+            skipBlanks(p, end);
+            bool ok = parseUnsigned(p, end, rows);
+            skipBlanks(p, end);
+            if(!ok || !parseUnsigned(p, end, cols)) {
+                throw "Matrix Market file has no size line.";
+            }
+            declaredVertices = (rows > cols) ? rows : cols;
+            body = nextLine(p, end);
+        } else if(format == DIMACS) {
+            const char* p = body;
+            while(p != nullptr && p < end && *p != 'p' && *p != 'a') {
+                p = nextLine(p, end);
+            }
+            if(p == nullptr || p == end || *p != 'p') {
+                throw "DIMACS file has no 'p' line before the arcs.";
+            }
+            p++;
+            skipBlanks(p, end);
+            while(p < end && !isBlank(*p) && *p != '\n') {
+                p++; // problem type ("sp")
+            }
+            skipBlanks(p, end);
+            if(!parseUnsigned(p, end, declaredVertices)) {
+                throw "DIMACS 'p' line has no vertex count.";
+            }
+        }
+        unsigned long long base = (format == EDGE_LIST) ? 0 : 1;
+
+        // Cut the body into one chunk per thread, each starting at the beginning of a line
+        std::size_t bytes = (body != nullptr) ? static_cast<std::size_t>(end - body) : 0;
+        int numThreads = 1;
+        if(bytes >= PARALLEL_PARSE_THRESHOLD) {
+            numThreads = static_cast<int>(std::thread::hardware_concurrency());
+            if(numThreads < 1) {
+                numThreads = 1;
+            }
+        }
+        const char** cuts = new const char*[numThreads + 1];
+        cuts[0] = body;
+        cuts[numThreads] = end;
+        for(int i = 1; i < numThreads; i++) {
+            const char* cut = body + bytes / numThreads * i;
+            if(cut < cuts[i - 1]) {
+                cut = cuts[i - 1];
+            }
+            cuts[i] = (cut == body) ? body : nextLine(cut - 1, end);
+        }
+
+        EdgeBuffer* buffers = new EdgeBuffer[numThreads];
+        if(numThreads == 1) {
+            if(bytes > 0) {
+                parseChunk(cuts[0], cuts[1], format, base, &buffers[0]);
+            }
+        } else {
+            std::thread* workers = new std::thread[numThreads];
+            for(int i = 0; i < numThreads; i++) {
+                workers[i] = std::thread(parseChunk, cuts[i], cuts[i + 1], static_cast<int>(format), base, &buffers[i]);
+            }
+            for(int i = 0; i < numThreads; i++) {
+                workers[i].join();
+            }
+            delete[] workers;
+        }
+        delete[] cuts;
+
+        // Errors are reported after all threads are done (the first bad line in file order wins)
+        std::size_t total = 0;
+        unsigned long long maxId = 0;
+        for(int i = 0; i < numThreads; i++) {
+            if(buffers[i].badLine != nullptr) {
+                std::size_t lineNumber = 1 + std::count(file.begin, buffers[i].badLine, '\n');
+                std::cerr << "Malformed line " << lineNumber << " in " << path << ".\n";
+                delete[] buffers;
+                throw "Malformed line in graph file.";
+            }
+            total += buffers[i].size;
+            if(buffers[i].maxId > maxId) {
+                maxId = buffers[i].maxId;
+            }
+        }
+
+        unsigned long long numVertices = declaredVertices;
+        if(format == EDGE_LIST) {
+            if(total == 0) {
+                delete[] buffers;
+                throw "Graph file has no edges.";
+            }
+            numVertices = maxId + 1;
+        } else if(total > 0 && maxId >= declaredVertices) {
+            delete[] buffers;
+            throw "Vertex id larger than the declared number of vertices.";
+        }
+        // Unsigned VertexIds reserve their largest value for NO_VERTEX
+        if(numVertices == 0 || numVertices > static_cast<unsigned long long>(std::numeric_limits<VertexId>::max())) {
+            delete[] buffers;
+            throw "Number of vertices does not fit in VertexId.";
+        }
+
+        // Concatenate the per-thread results (u < v when duplicates are merged)
+        ParsedEdge* edges = new ParsedEdge[total > 0 ? total : 1];
+        std::size_t pos = 0;
+        for(int i = 0; i < numThreads; i++) {
+            for(std::size_t j = 0; j < buffers[i].size; j++) {
+                ParsedEdge e = buffers[i].edges[j];
+                if(removeDuplicates && e.v < e.u) {
+                    VertexId tmp = e.u;
+                    e.u = e.v;
+                    e.v = tmp;
+                }
+                edges[pos++] = e;
+            }
+        }
+        delete[] buffers;
+
+        std::size_t numEdges = total;
+        if(removeDuplicates && total > 1) {
+            parallelSort(edges, total, numThreads);
+            // Equal (u, v) pairs are adjacent now, the smallest weight first
+            numEdges = 1;
+            for(std::size_t i = 1; i < total; i++) {
+                if(edges[i].u != edges[numEdges - 1].u || edges[i].v != edges[numEdges - 1].v) {
+                    edges[numEdges++] = edges[i];
+                }
+            }
+        }
+
+        VertexId* src = new VertexId[numEdges > 0 ? numEdges : 1];
+        VertexId* dst = new VertexId[numEdges > 0 ? numEdges : 1];
+        Weight* weights = new Weight[numEdges > 0 ? numEdges : 1];
+        for(std::size_t i = 0; i < numEdges; i++) {
+            src[i] = edges[i].u;
+            dst[i] = edges[i].v;
+            weights[i] = edges[i].w;
+        }
+        delete[] edges;
+
+        Graph g(static_cast<VertexId>(numVertices), src, dst, weights, numEdges);
+        delete[] src;
+        delete[] dst;
+        delete[] weights;
+        return g;
+    }
+
+} // namespace graph
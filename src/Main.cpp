@@ -2,11 +2,31 @@
 
 #include "../include/Graph.hpp"
 #include "../include/Algorithms.hpp"
+#include "../include/GraphReader.hpp"
 #include <iostream>
 
 using namespace graph;
 
-int main() {
+// ./Main <file>: load a graph file (.txt edge list, .mtx, .gr) and print a short summary
+static int summarizeFile(const char* path) {
+    try {
+        Graph g = GraphReader::read(path);
+        std::cout << path << ": " << g.getNumVertices() << " vertices, "
+                  << g.getNumAdjEntries() / 2 << " edges\n";
+        Graph bfsTree = Algorithms::bfs(g, 0);
+        std::cout << "BFS from 0 reaches " << bfsTree.getNumAdjEntries() / 2 + 1 << " vertices\n";
+    } catch(const char* msg) {
+        std::cerr << "Exception caught: " << msg << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if(argc > 1) {
+        return summarizeFile(argv[1]);
+    }
+
     // First example with only positive weighted edges (no negative edeges)
     Graph g(5);
     g.addEdge(0,1,2);
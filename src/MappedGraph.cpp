@@ -0,0 +1,296 @@
+// email: yaacovkrawiec@gmail.com
+
+#include "../include/MappedGraph.hpp"
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace graph {
+
+    static const char FILE_MAGIC[8] = {'G', 'R', 'P', 'H', 'C', 'S', 'R', '1'};
+    static const std::uint32_t BYTE_ORDER_MARK = 0x01020304u;
+    static const std::uint64_t ARRAY_ALIGNMENT = 16;
+
+    // How an arithmetic type is stored (so int32 and float32 files are not mixed up)
+    enum TypeKind { KIND_UNSIGNED = 0, KIND_SIGNED = 1, KIND_FLOAT = 2 };
+
+    template <typename T>
+    static std::uint32_t typeKind() {
+        if(std::numeric_limits<T>::is_integer) {
+            return std::numeric_limits<T>::is_signed ? KIND_SIGNED : KIND_UNSIGNED;
+        }
+        return KIND_FLOAT;
+    }
+
+    struct GraphFileHeader {
+        char magic[8];
+        std::uint32_t byteOrder;
+        std::uint32_t flags;          // bit 0: some weight is negative
+        std::uint32_t vertexBytes;
+        std::uint32_t vertexKind;
+        std::uint32_t weightBytes;
+        std::uint32_t weightKind;
+        std::uint64_t numVertices;
+        std::uint64_t numAdjEntries;
+        std::uint64_t offsetsPos;      // byte positions of the arrays from the start of the file
+        std::uint64_t destinationsPos;
+        std::uint64_t weightsPos;
+        std::uint64_t fileBytes;
+    };
+
+    static const std::uint32_t FLAG_NEGATIVE_WEIGHTS = 1;
+
+    static std::uint64_t alignUp(std::uint64_t pos) {
+        return (pos + ARRAY_ALIGNMENT - 1) / ARRAY_ALIGNMENT * ARRAY_ALIGNMENT;
+    }
+
+    // Writes 'count' bytes (closes the file and throws on failure)
+    static void writeBytes(std::FILE* file, const void* bytes, std::size_t count) {
+        if(count > 0 && std::fwrite(bytes, 1, count, file) != count) {
+            std::fclose(file);
+            throw "Cannot write graph file.";
+        }
+    }
+    // Pads with zeros from 'pos' up to the next array position
+    static void padTo(std::FILE* file, std::uint64_t& pos, std::uint64_t nextPos) {
+        static const char zeros[ARRAY_ALIGNMENT] = {0};
+        writeBytes(file, zeros, static_cast<std::size_t>(nextPos - pos));
+        pos = nextPos;
+    }
+
+    // Streams the arrays straight from 'g' (no intermediate copy). G is any graph with neighbors(v).
+    template <typename G>
+    void MappedGraph::writeFile(const G& g, const char* path) {
+        VertexId n = g.getNumVertices();
+        std::uint64_t m = g.getNumAdjEntries();
+
+        GraphFileHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+        header.byteOrder = BYTE_ORDER_MARK;
+        header.flags = g.hasNegativeWeight() ? FLAG_NEGATIVE_WEIGHTS : 0;
+        header.vertexBytes = sizeof(VertexId);
+        header.vertexKind = typeKind<VertexId>();
+        header.weightBytes = sizeof(Weight);
+        header.weightKind = typeKind<Weight>();
+        header.numVertices = static_cast<std::uint64_t>(n);
+        header.numAdjEntries = m;
+        header.offsetsPos = alignUp(sizeof(GraphFileHeader));
+        header.destinationsPos = alignUp(header.offsetsPos + (header.numVertices + 1) * sizeof(std::uint64_t));
+        header.weightsPos = alignUp(header.destinationsPos + m * sizeof(VertexId));
+        header.fileBytes = header.weightsPos + m * sizeof(Weight);
+
+        std::FILE* file = std::fopen(path, "wb");
+        if(file == nullptr) {
+            throw "Cannot create graph file.";
+        }
+        std::uint64_t pos = 0;
+        writeBytes(file, &header, sizeof(header));
+        pos += sizeof(header);
+        padTo(file, pos, header.offsetsPos);
+
+        std::uint64_t offset = 0;
+        writeBytes(file, &offset, sizeof(offset));
+        for(VertexId v = 0; v < n; v++) {
+            offset += static_cast<std::uint64_t>(g.getAdjSize(v));
+            writeBytes(file, &offset, sizeof(offset));
+        }
+        pos += (header.numVertices + 1) * sizeof(std::uint64_t);
+        padTo(file, pos, header.destinationsPos);
+
+        for(VertexId v = 0; v < n; v++) {
+            for(typename G::NeighborIterator it = g.neighbors(v); !it.done(); it.next()) {
+                VertexId dest = it.destination();
+                writeBytes(file, &dest, sizeof(dest));
+            }
+        }
+        pos += m * sizeof(VertexId);
+        padTo(file, pos, header.weightsPos);
+
+        for(VertexId v = 0; v < n; v++) {
+            for(typename G::NeighborIterator it = g.neighbors(v); !it.done(); it.next()) {
+                Weight w = it.weight();
+                writeBytes(file, &w, sizeof(w));
+            }
+        }
+
+        if(std::fclose(file) != 0) {
+            throw "Cannot write graph file.";
+        }
+    }
+
+    void MappedGraph::write(const Graph& g, const char* path) {
+        writeFile(g, path);
+    }
+
+    void MappedGraph::write(const CsrGraph& g, const char* path) {
+        writeFile(g, path);
+    }
+
+    void MappedGraph::write(const SoaCsrGraph& g, const char* path) {
+        writeFile(g, path);
+    }
+
+    // Checks the header against this build and the file size. The arrays themselves are trusted
+    // (checking every offset would touch the whole file and defeat the lazy loading).
+    const char* MappedGraph::readLayout(int fd, GraphFileLayout& layout) {
+        struct stat info;
+        if(::fstat(fd, &info) != 0 || static_cast<std::uint64_t>(info.st_size) < sizeof(GraphFileHeader)) {
+            return "Not a graph file.";
+        }
+        std::uint64_t fileBytes = static_cast<std::uint64_t>(info.st_size);
+        GraphFileHeader header;
+        if(::pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+            return "Not a graph file.";
+        }
+
+        if(std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) {
+            return "Not a graph file.";
+        }
+        if(header.byteOrder != BYTE_ORDER_MARK) {
+            return "Graph file was written on a machine with another byte order.";
+        }
+        if(header.vertexBytes != sizeof(VertexId) || header.vertexKind != typeKind<VertexId>()
+           || header.weightBytes != sizeof(Weight) || header.weightKind != typeKind<Weight>()) {
+            return "Graph file uses other VertexId / Weight types than this build.";
+        }
+        if(header.numVertices > static_cast<std::uint64_t>(std::numeric_limits<VertexId>::max())
+           || header.numVertices > fileBytes || header.numAdjEntries > fileBytes
+           || header.fileBytes != fileBytes
+           || header.offsetsPos % ARRAY_ALIGNMENT != 0 || header.destinationsPos % ARRAY_ALIGNMENT != 0
+           || header.weightsPos % ARRAY_ALIGNMENT != 0
+           || header.offsetsPos + (header.numVertices + 1) * sizeof(std::uint64_t) > header.destinationsPos
+           || header.destinationsPos + header.numAdjEntries * sizeof(VertexId) > header.weightsPos
+           || header.weightsPos + header.numAdjEntries * sizeof(Weight) > fileBytes) {
+            return "Graph file is truncated or corrupted.";
+        }
+
+        layout.numVertices = header.numVertices;
+        layout.numAdjEntries = header.numAdjEntries;
+        layout.offsetsPos = header.offsetsPos;
+        layout.destinationsPos = header.destinationsPos;
+        layout.weightsPos = header.weightsPos;
+        layout.negativeWeights = (header.flags & FLAG_NEGATIVE_WEIGHTS) != 0;
+        return nullptr;
+    }
+
+    MappedGraph::MappedGraph(const char* path)
+        : numVertices(0), numAdjEntries(0), offsets(nullptr), destinations(nullptr), weights(nullptr),
+          negativeWeights(false), mapping(nullptr), mappingBytes(0)
+    {
+        int fd = ::open(path, O_RDONLY);
+        if(fd < 0) {
+            throw "Cannot open graph file.";
+        }
+        GraphFileLayout layout;
+        const char* error = readLayout(fd, layout);
+        if(error != nullptr) {
+            ::close(fd);
+            throw error;
+        }
+        mappingBytes = static_cast<std::size_t>(layout.weightsPos + layout.numAdjEntries * sizeof(Weight));
+        void* address = ::mmap(nullptr, mappingBytes, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd); // the mapping stays valid without the descriptor
+        if(address == MAP_FAILED) {
+            mappingBytes = 0;
+            throw "Cannot map graph file.";
+        }
+        mapping = address;
+
+        const unsigned char* base = static_cast<const unsigned char*>(mapping);
+        offsets = reinterpret_cast<const std::uint64_t*>(base + layout.offsetsPos);
+        if(offsets[0] != 0 || offsets[layout.numVertices] != layout.numAdjEntries) {
+            unmap();
+            throw "Graph file is truncated or corrupted.";
+        }
+        destinations = reinterpret_cast<const VertexId*>(base + layout.destinationsPos);
+        weights = reinterpret_cast<const Weight*>(base + layout.weightsPos);
+        numVertices = static_cast<VertexId>(layout.numVertices);
+        numAdjEntries = static_cast<std::size_t>(layout.numAdjEntries);
+        negativeWeights = layout.negativeWeights;
+    }
+
+    void MappedGraph::unmap() {
+        if(mapping != nullptr) {
+            ::munmap(mapping, mappingBytes);
+        }
+        mapping = nullptr;
+        mappingBytes = 0;
+    }
+
+    MappedGraph::~MappedGraph() {
+        unmap();
+    }
+
+    // Move constructor
+    MappedGraph::MappedGraph(MappedGraph&& other) noexcept
+        : numVertices(other.numVertices), numAdjEntries(other.numAdjEntries), offsets(other.offsets),
+          destinations(other.destinations), weights(other.weights), negativeWeights(other.negativeWeights),
+          mapping(other.mapping), mappingBytes(other.mappingBytes)
+    {
+        other.numVertices = 0;
+        other.numAdjEntries = 0;
+        other.offsets = nullptr;
+        other.destinations = nullptr;
+        other.weights = nullptr;
+        other.mapping = nullptr;
+        other.mappingBytes = 0;
+    }
+
+    // Move assignment
+    MappedGraph& MappedGraph::operator=(MappedGraph&& other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    void MappedGraph::swap(MappedGraph& other) noexcept {
+        VertexId tmpVertices = numVertices;
+        numVertices = other.numVertices;
+        other.numVertices = tmpVertices;
+
+        std::size_t tmpEntries = numAdjEntries;
+        numAdjEntries = other.numAdjEntries;
+        other.numAdjEntries = tmpEntries;
+
+        const std::uint64_t* tmpOffsets = offsets;
+        offsets = other.offsets;
+        other.offsets = tmpOffsets;
+
+        const VertexId* tmpDest = destinations;
+        destinations = other.destinations;
+        other.destinations = tmpDest;
+
+        const Weight* tmpWeights = weights;
+        weights = other.weights;
+        other.weights = tmpWeights;
+
+        bool tmpNegative = negativeWeights;
+        negativeWeights = other.negativeWeights;
+        other.negativeWeights = tmpNegative;
+
+        void* tmpMapping = mapping;
+        mapping = other.mapping;
+        other.mapping = tmpMapping;
+
+        std::size_t tmpBytes = mappingBytes;
+        mappingBytes = other.mappingBytes;
+        other.mappingBytes = tmpBytes;
+    }
+
+    void MappedGraph::printGraph() const {
+        std::cout << "Graph adjacency list:\n";
+        for(VertexId v = 0; v < numVertices; v++) {
+            std::cout << "Vertex " << v << ": ";
+            for(std::uint64_t i = offsets[v]; i < offsets[v + 1]; i++) {
+                std::cout << "(" << destinations[i]
+                          << ", w=" << printableWeight(weights[i]) << ") ";
+            }
+            std::cout << "\n";
+        }
+    }
+
+} // namespace graph
@@ -0,0 +1,185 @@
+// email: yaacovkrawiec@gmail.com
+
+#include "../include/MemoryPolicy.hpp"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace graph {
+
+    // Modes of the mbind system call (<linux/mempolicy.h>)
+    static const int MODE_PREFERRED = 1;
+    static const int MODE_INTERLEAVE = 3;
+    static const int MAX_NODES = 64; // node masks are one unsigned long
+
+    static std::atomic<int> pagesSetting(MemoryPolicy::DEFAULT_PAGES);
+    static std::atomic<int> placementSetting(MemoryPolicy::FIRST_TOUCH);
+    static std::atomic<unsigned long> hugeTlbFallbacks(0);
+
+    void MemoryPolicy::set(Pages pages, Placement placement) {
+        pagesSetting = pages;
+        placementSetting = placement;
+    }
+
+    MemoryPolicy::Pages MemoryPolicy::getPages() {
+        return static_cast<Pages>(pagesSetting.load());
+    }
+
+    MemoryPolicy::Placement MemoryPolicy::getPlacement() {
+        return static_cast<Placement>(placementSetting.load());
+    }
+
+    unsigned long MemoryPolicy::getHugeTlbFallbacks() {
+        return hugeTlbFallbacks.load();
+    }
+
+    // Parses a node list such as "0", "0-3" or "0-1,4" into a bit mask
+    static unsigned long readOnlineNodes() {
+        std::FILE* file = std::fopen("/sys/devices/system/node/online", "r");
+        if(file == nullptr) {
+            return 1;
+        }
+        unsigned long mask = 0;
+        int first = -1;
+        int value = -1;
+        for(;;) {
+            int c = std::fgetc(file);
+            if(c >= '0' && c <= '9') {
+                value = (value < 0 ? 0 : value * 10) + (c - '0');
+                continue;
+            }
+            if(c == '-') {
+                first = value;
+                value = -1;
+                continue;
+            }
+            if(value >= 0) {
+                for(int node = first >= 0 ? first : value; node <= value && node < MAX_NODES; node++) {
+                    mask |= 1UL << node;
+                }
+            }
+            first = -1;
+            value = -1;
+            if(c == EOF) {
+                break;
+            }
+        }
+        std::fclose(file);
+        return mask != 0 ? mask : 1;
+    }
+
+    static unsigned long onlineNodes() {
+        static const unsigned long mask = readOnlineNodes();
+        return mask;
+    }
+
+    int MemoryPolicy::getNumNodes() {
+        int count = 0;
+        for(unsigned long mask = onlineNodes(); mask != 0; mask &= mask - 1) {
+            count++;
+        }
+        return count;
+    }
+
+    static std::size_t roundToHugePages(std::size_t bytes) {
+        return (bytes + MemoryPolicy::HUGE_PAGE_BYTES - 1) / MemoryPolicy::HUGE_PAGE_BYTES * MemoryPolicy::HUGE_PAGE_BYTES;
+    }
+
+    // The kernel only backs 2 MB aligned ranges with transparent huge pages:
+    // map one extra huge page and cut off the unaligned head and tail
+    static void* mapAligned(std::size_t length) {
+        std::size_t padded = length + MemoryPolicy::HUGE_PAGE_BYTES;
+        void* address = ::mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(address == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        char* start = static_cast<char*>(address);
+        std::uintptr_t misalignment = reinterpret_cast<std::uintptr_t>(start) % MemoryPolicy::HUGE_PAGE_BYTES;
+        std::size_t head = misalignment == 0 ? 0 : MemoryPolicy::HUGE_PAGE_BYTES - misalignment;
+        if(head > 0) {
+            ::munmap(start, head);
+        }
+        if(padded - head > length) {
+            ::munmap(start + head + length, padded - head - length);
+        }
+        return start + head;
+    }
+
+    static void bindRange(void* address, std::size_t length, int mode, unsigned long mask) {
+#ifdef SYS_mbind
+        // maxnode counts one bit more than the mask holds (kernel quirk)
+        ::syscall(SYS_mbind, address, length, mode, &mask, static_cast<unsigned long>(MAX_NODES + 1), 0);
+#else
+        (void)address; (void)length; (void)mode; (void)mask;
+#endif
+    }
+
+    // Must run before the pages are touched: mbind only steers future page faults
+    static void placePages(void* block, std::size_t length) {
+        MemoryPolicy::Placement placement = MemoryPolicy::getPlacement();
+        int nodes = MemoryPolicy::getNumNodes();
+        if(placement == MemoryPolicy::FIRST_TOUCH || nodes < 2) {
+            return;
+        }
+        unsigned long mask = onlineNodes();
+        if(placement == MemoryPolicy::INTERLEAVED) {
+            bindRange(block, length, MODE_INTERLEAVE, mask);
+            return;
+        }
+        // PARTITIONED: part i (a whole number of huge pages) goes to the i-th online node
+        std::size_t part = roundToHugePages((length + nodes - 1) / nodes);
+        char* start = static_cast<char*>(block);
+        for(std::size_t offset = 0; offset < length; offset += part) {
+            unsigned long node = mask & (~mask + 1); // lowest remaining node
+            mask &= mask - 1;
+            bindRange(start + offset, offset + part < length ? part : length - offset, MODE_PREFERRED, node);
+        }
+    }
+
+    void* MemoryPolicy::allocate(std::size_t bytes) {
+        if(bytes < HUGE_PAGE_BYTES) {
+            return ::operator new(bytes);
+        }
+        std::size_t length = roundToHugePages(bytes);
+        Pages pages = getPages();
+        void* block = nullptr;
+#ifdef MAP_HUGETLB
+        if(pages == HUGETLB_PAGES) {
+            void* address = ::mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if(address != MAP_FAILED) {
+                block = address;
+            } else {
+                hugeTlbFallbacks++;
+            }
+        }
+#endif
+        if(block == nullptr) {
+            block = mapAligned(length);
+#if defined(MADV_HUGEPAGE) && defined(MADV_NOHUGEPAGE)
+            if(pages == SMALL_PAGES) {
+                ::madvise(block, length, MADV_NOHUGEPAGE);
+            } else if(pages != DEFAULT_PAGES) {
+                ::madvise(block, length, MADV_HUGEPAGE);
+            }
+#endif
+        }
+        placePages(block, length);
+        return block;
+    }
+
+    void MemoryPolicy::release(void* block, std::size_t bytes) {
+        if(block == nullptr) {
+            return;
+        }
+        if(bytes < HUGE_PAGE_BYTES) {
+            ::operator delete(block);
+            return;
+        }
+        ::munmap(block, roundToHugePages(bytes));
+    }
+
+} // namespace graph
@@ -0,0 +1,467 @@
+// email: yaacovkrawiec@gmail.com
+
+#include "../include/Reorder.hpp"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace graph {
+
+    // ----- Reordering
+
+    Reordering::Reordering(Graph&& relabeled, VertexId* newIdArray, VertexId* oldIdArray)
+        : graph(std::move(relabeled)), newIds(newIdArray), oldIds(oldIdArray)
+    {
+    }
+
+    Reordering::~Reordering() {
+        delete[] newIds;
+        delete[] oldIds;
+    }
+
+    // Copy constructor
+    Reordering::Reordering(const Reordering& other)
+        : graph(other.graph)
+    {
+        VertexId n = graph.getNumVertices();
+        newIds = new VertexId[n];
+        oldIds = new VertexId[n];
+        for(VertexId v = 0; v < n; v++) {
+            newIds[v] = other.newIds[v];
+            oldIds[v] = other.oldIds[v];
+        }
+    }
+
+    // operator= (copy-and-swap)
+    Reordering& Reordering::operator=(const Reordering& other) {
+        if(this != &other) {
+            Reordering copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    // Move constructor
+    Reordering::Reordering(Reordering&& other) noexcept
+        : graph(std::move(other.graph)), newIds(other.newIds), oldIds(other.oldIds)
+    {
+        other.newIds = nullptr;
+        other.oldIds = nullptr;
+    }
+
+    // Move assignment
+    Reordering& Reordering::operator=(Reordering&& other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    void Reordering::swap(Reordering& other) noexcept {
+        graph.swap(other.graph);
+
+        VertexId* tmpNew = newIds;
+        newIds = other.newIds;
+        other.newIds = tmpNew;
+
+        VertexId* tmpOld = oldIds;
+        oldIds = other.oldIds;
+        other.oldIds = tmpOld;
+    }
+
+    Graph Reordering::toOriginalIds(const Graph& result) const {
+        if(result.getNumVertices() != graph.getNumVertices()) {
+            throw "Graph does not have the vertices of this reordering.";
+        }
+        return Reorder::relabel(result, oldIds);
+    }
+
+    // ----- Orderings (each fills order[i] = vertex that gets new id i)
+
+    // Ascending degree, ties by id (for std::sort)
+    struct ByDegree {
+        const Graph* g;
+        bool operator()(VertexId a, VertexId b) const {
+            int da = g->getAdjSize(a);
+            int db = g->getAdjSize(b);
+            return da < db || (da == db && a < b);
+        }
+    };
+
+    // Counting sort: O(n + max degree)
+    static void degreeOrder(const Graph& g, VertexId* order) {
+        VertexId n = g.getNumVertices();
+        int maxDegree = 0;
+        for(VertexId v = 0; v < n; v++) {
+            if(g.getAdjSize(v) > maxDegree) {
+                maxDegree = g.getAdjSize(v);
+            }
+        }
+        // start[d] = first position of the vertices of degree d (higher degrees come first)
+        std::size_t* start = new std::size_t[maxDegree + 1];
+        for(int d = 0; d <= maxDegree; d++) {
+            start[d] = 0;
+        }
+        for(VertexId v = 0; v < n; v++) {
+            start[g.getAdjSize(v)]++;
+        }
+        std::size_t pos = 0;
+        for(int d = maxDegree; d >= 0; d--) {
+            std::size_t count = start[d];
+            start[d] = pos;
+            pos += count;
+        }
+        for(VertexId v = 0; v < n; v++) {
+            order[ start[g.getAdjSize(v)]++ ] = v;
+        }
+        delete[] start;
+    }
+
+    // 'order' itself is the BFS queue
+    static void bfsOrder(const Graph& g, VertexId* order) {
+        VertexId n = g.getNumVertices();
+        bool* placed = new bool[n];
+        for(VertexId v = 0; v < n; v++) {
+            placed[v] = false;
+        }
+        std::size_t tail = 0;
+        for(VertexId s = 0; s < n; s++) {
+            if(placed[s]) {
+                continue;
+            }
+            std::size_t head = tail;
+            placed[s] = true;
+            order[tail++] = s;
+            while(head < tail) {
+                VertexId u = order[head++];
+                for(Graph::NeighborIterator it = g.neighbors(u); !it.done(); it.next()) {
+                    if(!placed[it.destination()]) {
+                        placed[it.destination()] = true;
+                        order[tail++] = it.destination();
+                    }
+                }
+            }
+        }
+        delete[] placed;
+    }
+
+    // BFS from 'root' over its component. Returns the depth of the last level and stores its
+    // lowest-degree vertex in 'farthest'. level[] is -1 for every vertex before and after the call.
+    static int lastLevel(const Graph& g, VertexId root, int* level, VertexId* queue, VertexId& farthest) {
+        std::size_t head = 0;
+        std::size_t tail = 0;
+        level[root] = 0;
+        queue[tail++] = root;
+        while(head < tail) {
+            VertexId u = queue[head++];
+            for(Graph::NeighborIterator it = g.neighbors(u); !it.done(); it.next()) {
+                if(level[it.destination()] < 0) {
+                    level[it.destination()] = level[u] + 1;
+                    queue[tail++] = it.destination();
+                }
+            }
+        }
+        int depth = level[queue[tail - 1]];
+        farthest = queue[tail - 1];
+        for(std::size_t i = tail; i-- > 0 && level[queue[i]] == depth; ) {
+            if(g.getAdjSize(queue[i]) < g.getAdjSize(farthest)) {
+                farthest = queue[i];
+            }
+        }
+        for(std::size_t i = 0; i < tail; i++) {
+            level[queue[i]] = -1;
+        }
+        return depth;
+    }
+
+    // George-Liu: jump to the far end of the BFS levels until the depth stops growing
+    static VertexId peripheralVertex(const Graph& g, VertexId start, int* level, VertexId* queue) {
+        VertexId root = start;
+        VertexId candidate;
+        int depth = lastLevel(g, root, level, queue, candidate);
+        while(candidate != root) {
+            VertexId next;
+            int candidateDepth = lastLevel(g, candidate, level, queue, next);
+            if(candidateDepth <= depth) {
+                break;
+            }
+            root = candidate;
+            depth = candidateDepth;
+            candidate = next;
+        }
+        return root;
+    }
+
+    static void rcmOrder(const Graph& g, VertexId* order) {
+        VertexId n = g.getNumVertices();
+        ByDegree byDegree = { &g };
+
+        // Components are started from their lowest-degree vertex
+        VertexId* seeds = new VertexId[n];
+        degreeOrder(g, seeds);
+        std::reverse(seeds, seeds + n);
+
+        bool* placed = new bool[n];
+        int* level = new int[n];
+        for(VertexId v = 0; v < n; v++) {
+            placed[v] = false;
+            level[v] = -1;
+        }
+        VertexId* queue = new VertexId[n];
+
+        std::size_t tail = 0;
+        for(VertexId i = 0; i < n; i++) {
+            if(placed[seeds[i]]) {
+                continue;
+            }
+            VertexId root = peripheralVertex(g, seeds[i], level, queue);
+            std::size_t head = tail;
+            placed[root] = true;
+            order[tail++] = root;
+            while(head < tail) {
+                VertexId u = order[head++];
+                std::size_t first = tail;
+                for(Graph::NeighborIterator it = g.neighbors(u); !it.done(); it.next()) {
+                    if(!placed[it.destination()]) {
+                        placed[it.destination()] = true;
+                        order[tail++] = it.destination();
+                    }
+                }
+                std::sort(order + first, order + tail, byDegree);
+            }
+        }
+        std::reverse(order, order + n);
+
+        delete[] seeds;
+        delete[] placed;
+        delete[] level;
+        delete[] queue;
+    }
+
+    // Unplaced vertices bucketed by Gorder score, with O(1) increment / decrement.
+    // Decrements are lazy: a vertex stays in the bucket of its old score (keys[v] >= scores[v]) and
+    // is only moved down when popMax meets it, which saves most of the relinking.
+    class ScoreBuckets {
+    private:
+        VertexId* heads;  // heads[k] = first vertex in bucket k (NO_VERTEX if none)
+        VertexId* prevs;
+        VertexId* nexts;
+        int* keys;        // bucket of each vertex
+        int* scores;      // actual score of each vertex
+        int top;          // no bucket above 'top' is in use
+
+        void unlink(VertexId v) {
+            if(prevs[v] != NO_VERTEX) {
+                nexts[prevs[v]] = nexts[v];
+            } else {
+                heads[keys[v]] = nexts[v];
+            }
+            if(nexts[v] != NO_VERTEX) {
+                prevs[nexts[v]] = prevs[v];
+            }
+        }
+        void link(VertexId v) {
+            prevs[v] = NO_VERTEX;
+            nexts[v] = heads[keys[v]];
+            if(nexts[v] != NO_VERTEX) {
+                prevs[nexts[v]] = v;
+            }
+            heads[keys[v]] = v;
+        }
+
+        ScoreBuckets(const ScoreBuckets&);
+        ScoreBuckets& operator=(const ScoreBuckets&);
+
+    public:
+        // Every vertex starts in bucket 0, lowest id first
+        ScoreBuckets(VertexId n, int maxScore) : top(0) {
+            heads = new VertexId[maxScore + 1];
+            for(int k = 0; k <= maxScore; k++) {
+                heads[k] = NO_VERTEX;
+            }
+            prevs = new VertexId[n];
+            nexts = new VertexId[n];
+            keys = new int[n];
+            scores = new int[n];
+            for(VertexId v = n; v-- > 0; ) {
+                keys[v] = 0;
+                scores[v] = 0;
+                link(v);
+            }
+        }
+        ~ScoreBuckets() {
+            delete[] heads;
+            delete[] prevs;
+            delete[] nexts;
+            delete[] keys;
+            delete[] scores;
+        }
+        void increment(VertexId v) {
+            if(++scores[v] > keys[v]) {
+                unlink(v);
+                keys[v] = scores[v];
+                link(v);
+                if(keys[v] > top) {
+                    top = keys[v];
+                }
+            }
+        }
+        void decrement(VertexId v) {
+            scores[v]--;
+        }
+        void remove(VertexId v) {
+            unlink(v);
+        }
+        // A vertex whose key is its actual score in the highest non-empty bucket has the maximum score
+        VertexId popMax() {
+            for(;;) {
+                while(top > 0 && heads[top] == NO_VERTEX) {
+                    top--;
+                }
+                VertexId v = heads[top];
+                unlink(v);
+                if(keys[v] == scores[v]) {
+                    return v;
+                }
+                keys[v] = scores[v];
+                link(v);
+            }
+        }
+    };
+
+    // Adds (delta = +1) or withdraws (-1) the score that 'u' gives the unplaced vertices while it
+    // is in the window: 1 per edge to u, 1 per common neighbor with u. Hubs (degree > hubDegree)
+    // are not expanded: that would cost deg^2, and their neighbors barely share anything else.
+    static void gorderUpdate(const Graph& g, VertexId u, int delta, int hubDegree,
+                             const bool* placed, ScoreBuckets& buckets) {
+        for(Graph::NeighborIterator it = g.neighbors(u); !it.done(); it.next()) {
+            VertexId x = it.destination();
+            if(!placed[x]) {
+                if(delta > 0) buckets.increment(x); else buckets.decrement(x);
+            }
+            if(g.getAdjSize(x) > hubDegree) {
+                continue;
+            }
+            for(Graph::NeighborIterator sib = g.neighbors(x); !sib.done(); sib.next()) {
+                VertexId y = sib.destination();
+                if(y != u && !placed[y]) {
+                    if(delta > 0) buckets.increment(y); else buckets.decrement(y);
+                }
+            }
+        }
+    }
+
+    // Wei et al., "Speedup Graph Processing by Graph Ordering" (greedy with a sliding window)
+    static void gorderOrder(const Graph& g, VertexId* order) {
+        VertexId n = g.getNumVertices();
+        const int window = Reorder::GORDER_WINDOW;
+        int hubDegree = static_cast<int>(std::sqrt(static_cast<double>(n))) + 1;
+
+        VertexId start = 0;
+        for(VertexId v = 0; v < n; v++) {
+            if(g.getAdjSize(v) > g.getAdjSize(start)) {
+                start = v;
+            }
+        }
+        // One window vertex adds at most 1 + degree(v) to v
+        ScoreBuckets buckets(n, window * (g.getAdjSize(start) + 1));
+
+        bool* placed = new bool[n];
+        for(VertexId v = 0; v < n; v++) {
+            placed[v] = false;
+        }
+
+        buckets.remove(start);
+        placed[start] = true;
+        order[0] = start;
+        gorderUpdate(g, start, +1, hubDegree, placed, buckets);
+        for(VertexId i = 1; i < n; i++) {
+            if(i >= window) {
+                gorderUpdate(g, order[i - window], -1, hubDegree, placed, buckets);
+            }
+            VertexId v = buckets.popMax();
+            placed[v] = true;
+            order[i] = v;
+            gorderUpdate(g, v, +1, hubDegree, placed, buckets);
+        }
+
+        delete[] placed;
+    }
+
+    // ----- Reorder
+
+    Reordering Reorder::reorder(const Graph& g, Strategy strategy) {
+        VertexId n = g.getNumVertices();
+        VertexId* oldIds = new VertexId[n];
+        if(n > 0) {
+            switch(strategy) {
+                case DEGREE_DESC: degreeOrder(g, oldIds); break;
+                case BFS_ORDER:   bfsOrder(g, oldIds);    break;
+                case RCM:         rcmOrder(g, oldIds);    break;
+                case GORDER:      gorderOrder(g, oldIds); break;
+            }
+        }
+        VertexId* newIds = new VertexId[n];
+        for(VertexId i = 0; i < n; i++) {
+            newIds[oldIds[i]] = i;
+        }
+        return Reordering(relabel(g, newIds), newIds, oldIds);
+    }
+
+    static bool byDestination(const Edge& a, const Edge& b) {
+        return a.destination < b.destination;
+    }
+
+    Graph Reorder::relabel(const Graph& g, const VertexId* newId) {
+        VertexId n = g.getNumVertices();
+        if(n == 0) {
+            return Graph();
+        }
+        VertexId* oldId = new VertexId[n];
+        for(VertexId v = 0; v < n; v++) {
+            oldId[v] = NO_VERTEX;
+        }
+        for(VertexId v = 0; v < n; v++) {
+            if(!isValidVertex(newId[v], n) || oldId[newId[v]] != NO_VERTEX) {
+                delete[] oldId;
+                throw "Not a permutation of the vertices.";
+            }
+            oldId[newId[v]] = v;
+        }
+
+        // Each edge is emitted once, by its lower new endpoint, in increasing order of both
+        // endpoints, so every new adjacency list comes out sorted
+        std::size_t numEdges = g.getNumAdjEntries() / 2;
+        VertexId* src = new VertexId[numEdges];
+        VertexId* dst = new VertexId[numEdges];
+        Weight* weights = new Weight[numEdges];
+        Edge* higher = new Edge[n];
+        std::size_t e = 0;
+        for(VertexId nu = 0; nu < n; nu++) {
+            int count = 0;
+            for(Graph::NeighborIterator it = g.neighbors(oldId[nu]); !it.done(); it.next()) {
+                VertexId nv = newId[it.destination()];
+                if(nu < nv) {
+                    higher[count].destination = nv;
+                    higher[count].weight = it.weight();
+                    count++;
+                }
+            }
+            std::sort(higher, higher + count, byDestination);
+            for(int i = 0; i < count; i++) {
+                src[e] = nu;
+                dst[e] = higher[i].destination;
+                weights[e] = higher[i].weight;
+                e++;
+            }
+        }
+
+        Graph result(n, src, dst, weights, e);
+        result.setSortedAdjacency(true); // already sorted: only checked
+        delete[] oldId;
+        delete[] src;
+        delete[] dst;
+        delete[] weights;
+        delete[] higher;
+        return result;
+    }
+
+} // namespace graph
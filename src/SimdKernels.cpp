@@ -0,0 +1,364 @@
+// email: yaacovkrawiec@gmail.com
+
+#include "../include/SimdKernels.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define GRAPH_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace graph {
+namespace simd {
+
+    // ----- scalar tails / fallback
+
+    static bool anyNegativeScalar(const int* values, std::size_t count) {
+        for(std::size_t i = 0; i < count; i++) {
+            if(values[i] < 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static void minMaxScalar(const int* values, std::size_t count, int& minOut, int& maxOut) {
+        for(std::size_t i = 0; i < count; i++) {
+            if(values[i] < minOut) minOut = values[i];
+            if(values[i] > maxOut) maxOut = values[i];
+        }
+    }
+
+    static long long sumScalar(const int* values, std::size_t count) {
+        long long total = 0;
+        for(std::size_t i = 0; i < count; i++) {
+            total += values[i];
+        }
+        return total;
+    }
+
+    // Continues from values[best] (an earlier index), so only a strictly smaller value wins
+    template <typename T>
+    static std::size_t argminScalar(const T* values, std::size_t first, std::size_t count, std::size_t best) {
+        for(std::size_t i = first; i < count; i++) {
+            if(values[i] < values[best]) {
+                best = i;
+            }
+        }
+        return best;
+    }
+
+    // Combines the per-lane minima of a vector loop: smallest value, then smallest index
+    template <typename T>
+    static std::size_t bestLane(const T* lanes, const long long* indices, int numLanes) {
+        int best = 0;
+        for(int i = 1; i < numLanes; i++) {
+            if(lanes[i] < lanes[best] || (lanes[i] == lanes[best] && indices[i] < indices[best])) {
+                best = i;
+            }
+        }
+        return static_cast<std::size_t>(indices[best]);
+    }
+
+#ifdef GRAPH_SIMD_X86
+
+    // ----- SSE2 (always available on x86-64)
+
+    static bool anyNegativeSse2(const int* values, std::size_t count) {
+        std::size_t i = 0;
+        while(i + 4 <= count) {
+            // OR blocks together and test the sign bits every 256 values
+            __m128i acc = _mm_setzero_si128();
+            std::size_t blockEnd = (count - i > 256) ? i + 256 : count - (count - i) % 4;
+            for(; i < blockEnd; i += 4) {
+                acc = _mm_or_si128(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)));
+            }
+            if(_mm_movemask_ps(_mm_castsi128_ps(acc)) != 0) {
+                return true;
+            }
+        }
+        return anyNegativeScalar(values + i, count - i);
+    }
+
+    static void minMaxSse2(const int* values, std::size_t count, int& minOut, int& maxOut) {
+        std::size_t i = 0;
+        if(count >= 4) {
+            __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values));
+            __m128i hi = lo;
+            for(i = 4; i + 4 <= count; i += 4) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+                // SSE2 has no pminsd/pmaxsd: select with a compare mask
+                __m128i less = _mm_cmplt_epi32(v, lo);
+                lo = _mm_or_si128(_mm_and_si128(less, v), _mm_andnot_si128(less, lo));
+                __m128i greater = _mm_cmpgt_epi32(v, hi);
+                hi = _mm_or_si128(_mm_and_si128(greater, v), _mm_andnot_si128(greater, hi));
+            }
+            int lanes[4];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), lo);
+            minMaxScalar(lanes, 4, minOut, maxOut);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), hi);
+            minMaxScalar(lanes, 4, minOut, maxOut);
+        }
+        minMaxScalar(values + i, count - i, minOut, maxOut);
+    }
+
+    static long long sumSse2(const int* values, std::size_t count) {
+        __m128i acc = _mm_setzero_si128(); // two 64-bit lanes
+        std::size_t i = 0;
+        for(; i + 4 <= count; i += 4) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+            __m128i sign = _mm_cmplt_epi32(v, _mm_setzero_si128());
+            acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(v, sign));
+            acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(v, sign));
+        }
+        long long lanes[2];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+        return lanes[0] + lanes[1] + sumScalar(values + i, count - i);
+    }
+
+    // Every lane keeps its smallest value and where it was seen (strictly smaller only,
+    // so each lane remembers its first minimum)
+    static std::size_t argminSse2(const double* values, std::size_t count) {
+        if(count < 4) {
+            return argminScalar(values, 1, count, 0);
+        }
+        __m128d lo = _mm_loadu_pd(values);
+        __m128i loIndex = _mm_set_epi64x(1, 0);
+        __m128i index = loIndex;
+        const __m128i step = _mm_set1_epi64x(2);
+        std::size_t i = 2;
+        for(; i + 2 <= count; i += 2) {
+            index = _mm_add_epi64(index, step);
+            __m128d v = _mm_loadu_pd(values + i);
+            __m128d less = _mm_cmplt_pd(v, lo);
+            __m128i lessBits = _mm_castpd_si128(less);
+            lo = _mm_or_pd(_mm_and_pd(less, v), _mm_andnot_pd(less, lo));
+            loIndex = _mm_or_si128(_mm_and_si128(lessBits, index), _mm_andnot_si128(lessBits, loIndex));
+        }
+        double lanes[2];
+        long long indices[2];
+        _mm_storeu_pd(lanes, lo);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(indices), loIndex);
+        return argminScalar(values, i, count, bestLane(lanes, indices, 2));
+    }
+
+    // ----- AVX2 (compiled for AVX2 regardless of -march, only called if the CPU supports it)
+
+    __attribute__((target("avx2")))
+    static bool anyNegativeAvx2(const int* values, std::size_t count) {
+        std::size_t i = 0;
+        while(i + 8 <= count) {
+            __m256i acc = _mm256_setzero_si256();
+            std::size_t blockEnd = (count - i > 512) ? i + 512 : count - (count - i) % 8;
+            for(; i < blockEnd; i += 8) {
+                acc = _mm256_or_si256(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i)));
+            }
+            if(_mm256_movemask_ps(_mm256_castsi256_ps(acc)) != 0) {
+                return true;
+            }
+        }
+        return anyNegativeScalar(values + i, count - i);
+    }
+
+    __attribute__((target("avx2")))
+    static void minMaxAvx2(const int* values, std::size_t count, int& minOut, int& maxOut) {
+        std::size_t i = 0;
+        if(count >= 8) {
+            __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values));
+            __m256i hi = lo;
+            for(i = 8; i + 8 <= count; i += 8) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+                lo = _mm256_min_epi32(lo, v);
+                hi = _mm256_max_epi32(hi, v);
+            }
+            int lanes[8];
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), lo);
+            minMaxScalar(lanes, 8, minOut, maxOut);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), hi);
+            minMaxScalar(lanes, 8, minOut, maxOut);
+        }
+        minMaxScalar(values + i, count - i, minOut, maxOut);
+    }
+
+    __attribute__((target("avx2")))
+    static long long sumAvx2(const int* values, std::size_t count) {
+        __m256i acc = _mm256_setzero_si256(); // four 64-bit lanes
+        std::size_t i = 0;
+        for(; i + 8 <= count; i += 8) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+            acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+            acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+        }
+        long long lanes[4];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+        return lanes[0] + lanes[1] + lanes[2] + lanes[3] + sumScalar(values + i, count - i);
+    }
+
+    __attribute__((target("avx2")))
+    static std::size_t argminAvx2(const long long* values, std::size_t count) {
+        if(count < 8) {
+            return argminScalar(values, 1, count, 0);
+        }
+        __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values));
+        __m256i loIndex = _mm256_set_epi64x(3, 2, 1, 0);
+        __m256i index = loIndex;
+        const __m256i step = _mm256_set1_epi64x(4);
+        std::size_t i = 4;
+        for(; i + 4 <= count; i += 4) {
+            index = _mm256_add_epi64(index, step);
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+            __m256i less = _mm256_cmpgt_epi64(lo, v);
+            lo = _mm256_blendv_epi8(lo, v, less);
+            loIndex = _mm256_blendv_epi8(loIndex, index, less);
+        }
+        long long lanes[4];
+        long long indices[4];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), lo);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(indices), loIndex);
+        return argminScalar(values, i, count, bestLane(lanes, indices, 4));
+    }
+
+    __attribute__((target("avx2")))
+    static std::size_t argminAvx2(const double* values, std::size_t count) {
+        if(count < 8) {
+            return argminScalar(values, 1, count, 0);
+        }
+        __m256d lo = _mm256_loadu_pd(values);
+        __m256i loIndex = _mm256_set_epi64x(3, 2, 1, 0);
+        __m256i index = loIndex;
+        const __m256i step = _mm256_set1_epi64x(4);
+        std::size_t i = 4;
+        for(; i + 4 <= count; i += 4) {
+            index = _mm256_add_epi64(index, step);
+            __m256d v = _mm256_loadu_pd(values + i);
+            __m256d less = _mm256_cmp_pd(v, lo, _CMP_LT_OQ);
+            lo = _mm256_blendv_pd(lo, v, less);
+            loIndex = _mm256_blendv_epi8(loIndex, index, _mm256_castpd_si256(less));
+        }
+        double lanes[4];
+        long long indices[4];
+        _mm256_storeu_pd(lanes, lo);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(indices), loIndex);
+        return argminScalar(values, i, count, bestLane(lanes, indices, 4));
+    }
+
+    // ----- AVX-512F (masked moves instead of blends, 8 lanes)
+
+    __attribute__((target("avx512f")))
+    static std::size_t argminAvx512(const long long* values, std::size_t count) {
+        if(count < 16) {
+            return argminAvx2(values, count);
+        }
+        __m512i lo = _mm512_loadu_si512(values);
+        __m512i loIndex = _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0);
+        __m512i index = loIndex;
+        const __m512i step = _mm512_set1_epi64(8);
+        std::size_t i = 8;
+        for(; i + 8 <= count; i += 8) {
+            index = _mm512_add_epi64(index, step);
+            __m512i v = _mm512_loadu_si512(values + i);
+            __mmask8 less = _mm512_cmplt_epi64_mask(v, lo);
+            lo = _mm512_mask_mov_epi64(lo, less, v);
+            loIndex = _mm512_mask_mov_epi64(loIndex, less, index);
+        }
+        long long lanes[8];
+        long long indices[8];
+        _mm512_storeu_si512(lanes, lo);
+        _mm512_storeu_si512(indices, loIndex);
+        return argminScalar(values, i, count, bestLane(lanes, indices, 8));
+    }
+
+    __attribute__((target("avx512f")))
+    static std::size_t argminAvx512(const double* values, std::size_t count) {
+        if(count < 16) {
+            return argminAvx2(values, count);
+        }
+        __m512d lo = _mm512_loadu_pd(values);
+        __m512i loIndex = _mm512_set_epi64(7, 6, 5, 4, 3, 2, 1, 0);
+        __m512i index = loIndex;
+        const __m512i step = _mm512_set1_epi64(8);
+        std::size_t i = 8;
+        for(; i + 8 <= count; i += 8) {
+            index = _mm512_add_epi64(index, step);
+            __m512d v = _mm512_loadu_pd(values + i);
+            __mmask8 less = _mm512_cmp_pd_mask(v, lo, _CMP_LT_OQ);
+            lo = _mm512_mask_mov_pd(lo, less, v);
+            loIndex = _mm512_mask_mov_epi64(loIndex, less, index);
+        }
+        double lanes[8];
+        long long indices[8];
+        _mm512_storeu_pd(lanes, lo);
+        _mm512_storeu_si512(indices, loIndex);
+        return argminScalar(values, i, count, bestLane(lanes, indices, 8));
+    }
+
+    static bool cpuHasAvx512() {
+        static const bool hasAvx512 = __builtin_cpu_supports("avx512f");
+        return hasAvx512;
+    }
+
+    static bool cpuHasAvx2() {
+        static const bool hasAvx2 = __builtin_cpu_supports("avx2");
+        return hasAvx2;
+    }
+
+    bool anyNegative(const int* values, std::size_t count) {
+        return cpuHasAvx2() ? anyNegativeAvx2(values, count) : anyNegativeSse2(values, count);
+    }
+
+    void minMax(const int* values, std::size_t count, int& minOut, int& maxOut) {
+        minOut = values[0];
+        maxOut = values[0];
+        if(cpuHasAvx2()) {
+            minMaxAvx2(values, count, minOut, maxOut);
+        } else {
+            minMaxSse2(values, count, minOut, maxOut);
+        }
+    }
+
+    long long sum(const int* values, std::size_t count) {
+        return cpuHasAvx2() ? sumAvx2(values, count) : sumSse2(values, count);
+    }
+
+    // SSE2 has no 64-bit integer compare: plain loop below AVX2
+    std::size_t argmin(const long long* values, std::size_t count) {
+        if(cpuHasAvx512()) {
+            return argminAvx512(values, count);
+        }
+        return cpuHasAvx2() ? argminAvx2(values, count) : argminScalar(values, 1, count, 0);
+    }
+
+    std::size_t argmin(const double* values, std::size_t count) {
+        if(cpuHasAvx512()) {
+            return argminAvx512(values, count);
+        }
+        return cpuHasAvx2() ? argminAvx2(values, count) : argminSse2(values, count);
+    }
+
+#else
+
+    bool anyNegative(const int* values, std::size_t count) {
+        return anyNegativeScalar(values, count);
+    }
+
+    void minMax(const int* values, std::size_t count, int& minOut, int& maxOut) {
+        minOut = values[0];
+        maxOut = values[0];
+        minMaxScalar(values, count, minOut, maxOut);
+    }
+
+    long long sum(const int* values, std::size_t count) {
+        return sumScalar(values, count);
+    }
+
+    std::size_t argmin(const long long* values, std::size_t count) {
+        return argminScalar(values, 1, count, 0);
+    }
+
+    std::size_t argmin(const double* values, std::size_t count) {
+        return argminScalar(values, 1, count, 0);
+    }
+
+#endif
+
+} // namespace simd
+} // namespace graph
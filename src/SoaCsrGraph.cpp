@@ -0,0 +1,168 @@
+// email: yaacovkrawiec@gmail.com
+
+#include "../include/SoaCsrGraph.hpp"
+#include "../include/SimdKernels.hpp"
+#include "../include/MemoryPolicy.hpp"
+
+namespace graph {
+
+    // The SIMD kernels handle int weights; other weight types use plain loops
+    inline bool anyNegativeWeight(const int* weights, std::size_t count) {
+        return simd::anyNegative(weights, count);
+    }
+    template <typename T>
+    static bool anyNegativeWeight(const T* weights, std::size_t count) {
+        for(std::size_t i = 0; i < count; i++) {
+            if(isNegativeWeight(weights[i])) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    inline void weightMinMax(const int* weights, std::size_t count, int& minOut, int& maxOut) {
+        simd::minMax(weights, count, minOut, maxOut);
+    }
+    template <typename T>
+    static void weightMinMax(const T* weights, std::size_t count, T& minOut, T& maxOut) {
+        minOut = weights[0];
+        maxOut = weights[0];
+        for(std::size_t i = 1; i < count; i++) {
+            if(weights[i] < minOut) minOut = weights[i];
+            if(weights[i] > maxOut) maxOut = weights[i];
+        }
+    }
+
+    // Shared by both constructors: G is Graph or CsrGraph
+    template <typename G>
+    void SoaCsrGraph::build(const G& g) {
+        numVertices = g.getNumVertices();
+        offsets = MemoryPolicy::allocateArray<std::size_t>(static_cast<std::size_t>(numVertices) + 1);
+        offsets[0] = 0;
+        for(VertexId v = 0; v < numVertices; v++) {
+            offsets[v + 1] = offsets[v] + g.getAdjSize(v);
+        }
+
+        destinations = MemoryPolicy::allocateArray<VertexId>(offsets[numVertices]);
+        weights = MemoryPolicy::allocateArray<Weight>(offsets[numVertices]);
+        for(VertexId v = 0; v < numVertices; v++) {
+            std::size_t pos = offsets[v];
+            for(typename G::NeighborIterator it = g.neighbors(v); !it.done(); it.next()) {
+                destinations[pos] = it.destination();
+                weights[pos] = it.weight();
+                pos++;
+            }
+        }
+    }
+
+    SoaCsrGraph::SoaCsrGraph(const Graph& g) {
+        build(g);
+    }
+
+    SoaCsrGraph::SoaCsrGraph(const CsrGraph& g) {
+        build(g);
+    }
+
+    void SoaCsrGraph::release() {
+        if(offsets != nullptr) {
+            MemoryPolicy::releaseArray(destinations, offsets[numVertices]);
+            MemoryPolicy::releaseArray(weights, offsets[numVertices]);
+            MemoryPolicy::releaseArray(offsets, static_cast<std::size_t>(numVertices) + 1);
+        }
+        offsets = nullptr;
+        destinations = nullptr;
+        weights = nullptr;
+    }
+
+    SoaCsrGraph::~SoaCsrGraph() {
+        release();
+    }
+
+    // Copy constructor (a moved-from snapshot has no arrays and copies as one)
+    SoaCsrGraph::SoaCsrGraph(const SoaCsrGraph& other)
+        : numVertices(other.numVertices), offsets(nullptr), destinations(nullptr), weights(nullptr)
+    {
+        if(other.offsets == nullptr) {
+            return;
+        }
+        offsets = MemoryPolicy::allocateArray<std::size_t>(static_cast<std::size_t>(numVertices) + 1);
+        for(std::size_t v = 0; v <= static_cast<std::size_t>(numVertices); v++) {
+            offsets[v] = other.offsets[v];
+        }
+        destinations = MemoryPolicy::allocateArray<VertexId>(offsets[numVertices]);
+        weights = MemoryPolicy::allocateArray<Weight>(offsets[numVertices]);
+        for(std::size_t i = 0; i < offsets[numVertices]; i++) {
+            destinations[i] = other.destinations[i];
+            weights[i] = other.weights[i];
+        }
+    }
+
+    // operator= (copy-and-swap)
+    SoaCsrGraph& SoaCsrGraph::operator=(const SoaCsrGraph& other) {
+        if(this != &other) {
+            SoaCsrGraph copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    // Move constructor
+    SoaCsrGraph::SoaCsrGraph(SoaCsrGraph&& other) noexcept
+        : numVertices(other.numVertices), offsets(other.offsets),
+          destinations(other.destinations), weights(other.weights)
+    {
+        other.numVertices = 0;
+        other.offsets = nullptr;
+        other.destinations = nullptr;
+        other.weights = nullptr;
+    }
+
+    // Move assignment
+    SoaCsrGraph& SoaCsrGraph::operator=(SoaCsrGraph&& other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    void SoaCsrGraph::swap(SoaCsrGraph& other) noexcept {
+        VertexId tmpVertices = numVertices;
+        numVertices = other.numVertices;
+        other.numVertices = tmpVertices;
+
+        std::size_t* tmpOffsets = offsets;
+        offsets = other.offsets;
+        other.offsets = tmpOffsets;
+
+        VertexId* tmpDest = destinations;
+        destinations = other.destinations;
+        other.destinations = tmpDest;
+
+        Weight* tmpWeights = weights;
+        weights = other.weights;
+        other.weights = tmpWeights;
+    }
+
+    bool SoaCsrGraph::hasNegativeWeight() const {
+        return anyNegativeWeight(weights, getNumAdjEntries());
+    }
+
+    bool SoaCsrGraph::weightRange(Weight& minWeight, Weight& maxWeight) const {
+        if(getNumAdjEntries() == 0) {
+            return false;
+        }
+        weightMinMax(weights, getNumAdjEntries(), minWeight, maxWeight);
+        return true;
+    }
+
+    void SoaCsrGraph::printGraph() const {
+        std::cout << "Graph adjacency list:\n";
+        for(VertexId v = 0; v < numVertices; v++) {
+            std::cout << "Vertex " << v << ": ";
+            for(std::size_t i = offsets[v]; i < offsets[v + 1]; i++) {
+                std::cout << "(" << destinations[i]
+                          << ", w=" << printableWeight(weights[i]) << ") ";
+            }
+            std::cout << "\n";
+        }
+    }
+
+} // namespace graph
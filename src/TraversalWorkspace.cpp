@@ -0,0 +1,153 @@
+// email: yaacovkrawiec@gmail.com
+
+#include "../include/TraversalWorkspace.hpp"
+#include "../include/MemoryPolicy.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace graph {
+
+    // Min-heap order for std::push_heap / pop_heap
+    static bool fartherEntry(const TraversalWorkspace::HeapEntry& a, const TraversalWorkspace::HeapEntry& b) {
+        return b.dist < a.dist;
+    }
+
+    TraversalWorkspace::TraversalWorkspace(VertexId numberOfVertices)
+        : capacity(0), stamps(nullptr), epoch(0), parent(nullptr), depth(nullptr), dist(nullptr),
+          parentWeight(nullptr), settled(nullptr), order(nullptr), numReached(0), source(NO_VERTEX),
+          heap(nullptr), heapCapacity(0), heapSize(0)
+    {
+        grow(numberOfVertices);
+    }
+
+    void TraversalWorkspace::release() {
+        MemoryPolicy::releaseArray(stamps, capacity);
+        MemoryPolicy::releaseArray(parent, capacity);
+        MemoryPolicy::releaseArray(depth, capacity);
+        MemoryPolicy::releaseArray(dist, capacity);
+        MemoryPolicy::releaseArray(parentWeight, capacity);
+        MemoryPolicy::releaseArray(settled, capacity);
+        MemoryPolicy::releaseArray(order, capacity);
+        delete[] heap;
+        stamps = nullptr;
+        parent = nullptr;
+        depth = nullptr;
+        dist = nullptr;
+        parentWeight = nullptr;
+        settled = nullptr;
+        order = nullptr;
+        heap = nullptr;
+        capacity = 0;
+        heapCapacity = 0;
+    }
+
+    TraversalWorkspace::~TraversalWorkspace() {
+        release();
+    }
+
+    // New arrays for 'numberOfVertices' (the old contents are dropped, every stamp is cleared)
+    void TraversalWorkspace::grow(VertexId numberOfVertices) {
+        release();
+        if(numberOfVertices == 0) {
+            return;
+        }
+        stamps = MemoryPolicy::allocateArray<std::uint32_t>(numberOfVertices);
+        parent = MemoryPolicy::allocateArray<VertexId>(numberOfVertices);
+        depth = MemoryPolicy::allocateArray<VertexId>(numberOfVertices);
+        dist = MemoryPolicy::allocateArray<Distance>(numberOfVertices);
+        parentWeight = MemoryPolicy::allocateArray<Weight>(numberOfVertices);
+        settled = MemoryPolicy::allocateArray<bool>(numberOfVertices);
+        order = MemoryPolicy::allocateArray<VertexId>(numberOfVertices);
+        capacity = numberOfVertices;
+        for(VertexId v = 0; v < capacity; v++) {
+            stamps[v] = 0;
+        }
+        epoch = 0;
+        numReached = 0;
+    }
+
+    void TraversalWorkspace::begin(VertexId numberOfVertices, VertexId sourceVertex) {
+        if(!isValidVertex(sourceVertex, numberOfVertices)) {
+            throw "Invalid start vertex.";
+        }
+        if(numberOfVertices > capacity) {
+            // Room for some growth, so a slowly growing graph does not reallocate every query
+            VertexId bigger = capacity + capacity / 2;
+            grow(bigger > numberOfVertices ? bigger : numberOfVertices);
+        }
+        if(++epoch == 0) {
+            for(VertexId v = 0; v < capacity; v++) {
+                stamps[v] = 0;
+            }
+            epoch = 1;
+        }
+        numReached = 0;
+        heapSize = 0;
+        source = sourceVertex;
+
+        stamp(sourceVertex);
+        parent[sourceVertex] = NO_VERTEX;
+        depth[sourceVertex] = 0;
+        dist[sourceVertex] = 0;
+        parentWeight[sourceVertex] = Weight();
+    }
+
+    void TraversalWorkspace::growHeap() {
+        std::size_t newCapacity = heapCapacity < 16 ? 16 : heapCapacity * 2;
+        HeapEntry* newHeap = new HeapEntry[newCapacity];
+        for(std::size_t i = 0; i < heapSize; i++) {
+            newHeap[i] = heap[i];
+        }
+        delete[] heap;
+        heap = newHeap;
+        heapCapacity = newCapacity;
+    }
+
+    void TraversalWorkspace::pushHeap(VertexId vertex, Distance distance) {
+        if(heapSize == heapCapacity) {
+            growHeap();
+        }
+        heap[heapSize].dist = distance;
+        heap[heapSize].vertex = vertex;
+        heapSize++;
+        std::push_heap(heap, heap + heapSize, fartherEntry);
+    }
+
+    TraversalWorkspace::HeapEntry TraversalWorkspace::popHeap() {
+        std::pop_heap(heap, heap + heapSize, fartherEntry);
+        return heap[--heapSize];
+    }
+
+    // Move constructor
+    TraversalWorkspace::TraversalWorkspace(TraversalWorkspace&& other) noexcept
+        : capacity(0), stamps(nullptr), epoch(0), parent(nullptr), depth(nullptr), dist(nullptr),
+          parentWeight(nullptr), settled(nullptr), order(nullptr), numReached(0), source(NO_VERTEX),
+          heap(nullptr), heapCapacity(0), heapSize(0)
+    {
+        swap(other);
+    }
+
+    // Move assignment
+    TraversalWorkspace& TraversalWorkspace::operator=(TraversalWorkspace&& other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    void TraversalWorkspace::swap(TraversalWorkspace& other) noexcept {
+        std::swap(capacity, other.capacity);
+        std::swap(stamps, other.stamps);
+        std::swap(epoch, other.epoch);
+        std::swap(parent, other.parent);
+        std::swap(depth, other.depth);
+        std::swap(dist, other.dist);
+        std::swap(parentWeight, other.parentWeight);
+        std::swap(settled, other.settled);
+        std::swap(order, other.order);
+        std::swap(numReached, other.numReached);
+        std::swap(source, other.source);
+        std::swap(heap, other.heap);
+        std::swap(heapCapacity, other.heapCapacity);
+        std::swap(heapSize, other.heapSize);
+    }
+
+} // namespace graph
@@ -4,28 +4,65 @@
 #include "doctest.hpp"
 #include "../include/Graph.hpp"
 #include "../include/Algorithms.hpp"
+#include "../include/GraphReader.hpp"
+#include "../include/Reorder.hpp"
+#include "../include/MemoryPolicy.hpp"
+#include "../include/CsrGraph.hpp"
+#include "../include/DeltaGraph.hpp"
+#include "../include/DenseGraph.hpp"
+#include "../include/ExternalGraph.hpp"
+#include "../include/SimdKernels.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <unistd.h> // truncate
 
 using namespace graph;
 
-// A helper function to check the adjacency of an undirected edge
-static bool hasEdge(const Graph& g, int u, int v, int weight = -1) {
-    // Returns true if g has an edge u->v. If weight != -1, also check the weight.
-    if(u < 0 || u >= g.getNumVertices() || v < 0 || v >= g.getNumVertices()) {
+// Helper functions to check the adjacency of an undirected edge
+static bool hasEdge(const Graph& g, VertexId u, VertexId v) {
+    return g.hasEdge(u, v);
+}
+
+// Returns true if g has an edge u->v with the given weight
+static bool hasEdge(const Graph& g, VertexId u, VertexId v, Weight weight) {
+    if(!g.hasEdge(u, v)) {
         return false;
     }
-    int sizeAdj = g.getAdjSize(u);
-    Edge* edges = g.getAdjList(u);
-    for(int i = 0; i < sizeAdj; i++) {
-        if(edges[i].destination == v) {
-            if(weight == -1 || edges[i].weight == weight) {
-                return true;
-            }
+    if(g.edgeWeight(u, v) == weight) {
+        return true;
+    }
+    // Repeated edges may carry other weights
+    for(Graph::NeighborIterator it = g.neighbors(u); !it.done(); it.next()) {
+        if(it.destination() == v && it.weight() == weight) {
+            return true;
         }
     }
     return false;
 }
 
+// Checks that every entry's twin index points back at it
+static bool twinsConsistent(const Graph& g) {
+    for(VertexId v = 0; v < g.getNumVertices(); v++) {
+        for(int i = 0; i < g.getAdjSize(v); i++) {
+            const Edge& e = g.getAdjList(v)[i];
+            int t = g.getTwinIndex(v, i);
+            if(t < 0 || t >= g.getAdjSize(e.destination)) {
+                return false;
+            }
+            const Edge& back = g.getAdjList(e.destination)[t];
+            if(back.destination != v || back.weight != e.weight || g.getTwinIndex(e.destination, t) != i) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
 // ================ TEST CASES ================
 TEST_CASE("Graph basic functionality") {
     Graph g(4);
@@ -143,9 +180,12 @@ TEST_CASE("Dijkstra on a small graph with positive edges") {
 }
 
 TEST_CASE("Dijkstra negative edges => throw exception") {
+    if(!std::numeric_limits<Weight>::is_signed) {
+        return; // no negative weights to reject
+    }
     Graph g(3);
     g.addEdge(0,1,5);
-    g.addEdge(1,2,-1); // negative
+    g.addEdge(1,2,static_cast<Weight>(-1)); // negative
 
     // We expect an exception
     CHECK_THROWS_AS(Algorithms::dijkstra(g,0), const char*);
@@ -209,6 +249,1738 @@ TEST_CASE("Kruskal MST basic") {
     CHECK(edgesCount == 6);
 }
 
+TEST_CASE("CSR snapshot matches the graph and runs every algorithm") {
+    Graph g(5);
+    g.addEdge(0,1,2);
+    g.addEdge(0,2,3);
+    g.addEdge(1,3,1);
+    g.addEdge(2,3,4);
+    g.addEdge(3,4,6);
+
+    CsrGraph csr = g.freeze();
+    CHECK(csr.getNumVertices() == 5);
+    CHECK(csr.getNumAdjEntries() == 10);
+    for(int v = 0; v < 5; v++) {
+        CHECK(csr.getAdjSize(v) == g.getAdjSize(v));
+        for(int i = 0; i < g.getAdjSize(v); i++) {
+            CHECK(csr.getAdjList(v)[i].destination == g.getAdjList(v)[i].destination);
+            CHECK(csr.getAdjList(v)[i].weight == g.getAdjList(v)[i].weight);
+        }
+    }
+
+    // Same trees as on the mutable graph
+    Graph dTree = Algorithms::dijkstra(csr, 0);
+    CHECK(hasEdge(dTree, 0,1,2));
+    CHECK(hasEdge(dTree, 0,2,3));
+    CHECK(hasEdge(dTree, 1,3,1));
+    CHECK(hasEdge(dTree, 3,4,6));
+
+    Graph prim = Algorithms::prim(csr);
+    Graph kruskal = Algorithms::kruskal(csr);
+    CHECK(hasEdge(prim, 2,3,4) == hasEdge(kruskal, 2,3,4));
+    CHECK(hasEdge(kruskal, 0,1,2));
+    CHECK(hasEdge(kruskal, 0,2,3));
+    CHECK(hasEdge(kruskal, 1,3,1));
+    CHECK(hasEdge(kruskal, 3,4,6));
+
+    Graph bfsTree = Algorithms::bfs(csr, 0);
+    Graph dfsTree = Algorithms::dfs(csr, 0);
+    CHECK(hasEdge(bfsTree, 0,1));
+    CHECK(hasEdge(bfsTree, 0,2));
+    CHECK(hasEdge(dfsTree, 0,1));
+    CHECK(hasEdge(dfsTree, 1,3));
+
+    // Mutations do not touch the snapshot until the graph is frozen again
+    g.removeEdge(3,4);
+    CHECK(csr.getAdjSize(4) == 1);
+    CsrGraph refrozen = g.freeze();
+    CHECK(refrozen.getAdjSize(4) == 0);
+    CHECK(refrozen.getNumAdjEntries() == 8);
+
+    // Kruskal sorts a large snapshot's edge list in O(m log m): a 250 x 250 grid
+    const VertexId side = 250;
+    Graph grid(side * side);
+    for(VertexId r = 0; r < side; r++) {
+        for(VertexId c = 0; c < side; c++) {
+            VertexId v = r * side + c;
+            if(c + 1 < side) grid.addEdge(v, v + 1, static_cast<Weight>(v * 7 % 50 + 1));
+            if(r + 1 < side) grid.addEdge(v, v + side, static_cast<Weight>(v * 13 % 47 + 1));
+        }
+    }
+    CsrGraph gridCsr = grid.freeze();
+    MstResult kruskalMst = Algorithms::kruskalResult(gridCsr);
+    CHECK(kruskalMst.getNumEdges() == static_cast<std::size_t>(side * side - 1));
+    CHECK(kruskalMst.isSpanningTree());
+    CHECK(kruskalMst.getTotalWeight() == Algorithms::primResult(gridCsr).getTotalWeight());
+}
+
+TEST_CASE("Slab allocator reuses freed blocks") {
+    SlabAllocator slab;
+    void* a = slab.allocate(4 * sizeof(Edge));
+    void* b = slab.allocate(4 * sizeof(Edge));
+    CHECK(a != b);
+    slab.deallocate(a, 4 * sizeof(Edge));
+    // same size class => the freed block comes back
+    CHECK(slab.allocate(4 * sizeof(Edge)) == a);
+    // a different size class does not take it
+    slab.deallocate(b, 4 * sizeof(Edge));
+    CHECK(slab.allocate(8 * sizeof(Edge)) != b);
+    // blocks larger than a chunk still work
+    void* big = slab.allocate(4 << 20);
+    CHECK(big != nullptr);
+    slab.deallocate(big, 4 << 20);
+    CHECK(slab.allocate(4 << 20) == big);
+}
+
+TEST_CASE("Graph with a custom allocator") {
+    Graph g(50, new HeapAllocator());
+    for(int i = 1; i < 50; i++) {
+        g.addEdge(0, i, i);
+    }
+    CHECK(g.getAdjSize(0) == 49);
+    CHECK(hasEdge(g, 0, 49, 49));
+
+    // The copy gets its own allocator of the same kind
+    Graph copy(g);
+    g.removeEdge(0, 49);
+    CHECK(hasEdge(copy, 0, 49, 49));
+    CHECK_FALSE(hasEdge(g, 0, 49));
+
+    Graph assigned(2);
+    assigned = copy;
+    CHECK(assigned.getAdjSize(0) == 49);
+}
+
+TEST_CASE("Graph move and swap do not copy the adjacency arrays") {
+    static_assert(std::is_nothrow_move_constructible<Graph>::value, "Graph must be nothrow movable");
+    static_assert(std::is_nothrow_move_assignable<Graph>::value, "Graph must be nothrow movable");
+    static_assert(std::is_nothrow_move_constructible<CsrGraph>::value, "CsrGraph must be nothrow movable");
+
+    Graph g(3);
+    g.addEdge(0,1,4);
+    const Edge* edges = g.getAdjList(0);
+
+    Graph moved(std::move(g));
+    CHECK(moved.getNumVertices() == 3);
+    CHECK(moved.getAdjList(0) == edges); // same array, not a copy
+    CHECK(g.getNumVertices() == 0);
+
+    Graph other(5);
+    other.addEdge(3,4,1);
+    swap(moved, other);
+    CHECK(other.getNumVertices() == 3);
+    CHECK(other.getAdjList(0) == edges);
+    CHECK(hasEdge(moved, 3,4,1));
+
+    moved = std::move(other);
+    CHECK(moved.getNumVertices() == 3);
+    CHECK(hasEdge(moved, 0,1,4));
+
+    // A moved-from graph can still be assigned to
+    g = moved;
+    CHECK(hasEdge(g, 1,0,4));
+
+    CsrGraph csr = moved.freeze();
+    CsrGraph csrMoved(std::move(csr));
+    CHECK(csrMoved.getNumAdjEntries() == 2);
+    CHECK(csr.getNumVertices() == 0);
+
+    // Moved-from snapshots stay usable: empty, copyable and assignable
+    CHECK(csr.getNumAdjEntries() == 0);
+    CHECK_FALSE(csr.hasNegativeWeight());
+    CsrGraph csrCopy(csr);
+    CHECK(csrCopy.getNumAdjEntries() == 0);
+    csrMoved = csr;
+    CHECK(csrMoved.getNumVertices() == 0);
+    csr = moved.freeze();
+    CHECK(csr.getNumAdjEntries() == 2);
+
+    SoaCsrGraph soa(moved);
+    SoaCsrGraph soaMoved(std::move(soa));
+    CHECK(soa.getNumAdjEntries() == 0);
+    Weight lo, hi;
+    CHECK_FALSE(soa.weightRange(lo, hi));
+    SoaCsrGraph soaCopy(soa);
+    CHECK(soaCopy.getNumVertices() == 0);
+    soaMoved = soa;
+    CHECK(soaMoved.getNumAdjEntries() == 0);
+}
+
+TEST_CASE("Bulk edge ingestion matches one-by-one addEdge") {
+    VertexId src[] = {0, 0, 1, 2, 3, 2, 1};
+    VertexId dst[] = {1, 2, 3, 3, 4, 2, 9}; // last two are a loop and a bad vertex => skipped
+    Weight w[] = {2, 3, 1, 4, 6, 5, 5};
+
+    Graph bulk(5, src, dst, w, 7);
+    Graph single(5);
+    for(int i = 0; i < 5; i++) {
+        single.addEdge(src[i], dst[i], w[i]);
+    }
+    for(int v = 0; v < 5; v++) {
+        REQUIRE(bulk.getAdjSize(v) == single.getAdjSize(v));
+        for(int i = 0; i < bulk.getAdjSize(v); i++) {
+            CHECK(bulk.getAdjList(v)[i].destination == single.getAdjList(v)[i].destination);
+            CHECK(bulk.getAdjList(v)[i].weight == single.getAdjList(v)[i].weight);
+        }
+    }
+
+    // Appending to existing lists, default weight 1
+    bulk.addEdges(src + 4, dst + 4, nullptr, 1);
+    CHECK(bulk.getAdjSize(4) == 2);
+    CHECK(hasEdge(bulk, 4, 3, 1));
+    CHECK(hasEdge(bulk, 4, 3, 6));
+}
+
+TEST_CASE("Bulk edge ingestion on a large graph (parallel fill)") {
+    const int n = 1000;
+    const std::size_t m = 200000;
+    VertexId* src = new VertexId[m];
+    VertexId* dst = new VertexId[m];
+    Weight* w = new Weight[m];
+    for(std::size_t e = 0; e < m; e++) {
+        src[e] = static_cast<VertexId>((e * 7919) % n);
+        dst[e] = static_cast<VertexId>((e * 104729 + 1) % n);
+        w[e] = static_cast<Weight>(e % 100);
+    }
+    Graph g(n, src, dst, w, m);
+
+    long long total = 0;
+    long long expected = 0;
+    for(int v = 0; v < n; v++) {
+        total += g.getAdjSize(v);
+    }
+    for(std::size_t e = 0; e < m; e++) {
+        if(src[e] != dst[e]) {
+            expected += 2;
+        }
+    }
+    CHECK(total == expected);
+    // Entries keep input order inside each list
+    CHECK(g.getAdjList(src[0])[0].destination == dst[0]);
+    CHECK(g.getAdjList(src[0])[0].weight == w[0]);
+
+    delete[] src;
+    delete[] dst;
+    delete[] w;
+}
+
+TEST_CASE("SIMD kernels agree with plain loops") {
+    int values[103];
+    for(int len = 0; len <= 103; len++) {
+        for(int i = 0; i < len; i++) {
+            values[i] = (i * 37) % 101 + 1;
+        }
+        long long expectedSum = 0;
+        for(int i = 0; i < len; i++) {
+            expectedSum += values[i];
+        }
+        CHECK(simd::sum(values, len) == expectedSum);
+        CHECK_FALSE(simd::anyNegative(values, len));
+        if(len > 0) {
+            values[len - 1] = -5; // a negative value in the scalar tail or the last vector
+            CHECK(simd::anyNegative(values, len));
+            int expectedMax = values[0];
+            for(int i = 1; i < len; i++) {
+                if(values[i] > expectedMax) expectedMax = values[i];
+            }
+            int lo = 0;
+            int hi = 0;
+            simd::minMax(values, len, lo, hi);
+            CHECK(lo == -5);
+            CHECK(hi == expectedMax);
+        }
+    }
+
+    int big[3] = {2000000000, 2000000000, 2000000000};
+    CHECK(simd::sum(big, 3) == 6000000000LL); // no 32-bit overflow
+}
+
+TEST_CASE("SoA snapshot runs every algorithm") {
+    Graph g(4);
+    g.addEdge(0,1,1);
+    g.addEdge(1,2,2);
+    g.addEdge(2,3,3);
+    g.addEdge(3,0,4);
+    g.addEdge(0,2,10);
+
+    SoaCsrGraph soa(g);
+    CHECK(soa.getNumAdjEntries() == g.getNumAdjEntries());
+    CHECK(soa.getDestinations(0)[0] == 1);
+    CHECK(soa.getWeights(0)[0] == 1);
+    CHECK_FALSE(soa.hasNegativeWeight());
+    Weight lo = 0;
+    Weight hi = 0;
+    CHECK(soa.weightRange(lo, hi));
+    CHECK(lo == 1);
+    CHECK(hi == 10);
+
+    Graph mst = Algorithms::kruskal(soa);
+    CHECK(hasEdge(mst, 0,1,1));
+    CHECK(hasEdge(mst, 1,2,2));
+    CHECK(hasEdge(mst, 2,3,3));
+    Graph primMst = Algorithms::prim(soa);
+    CHECK(primMst.getNumAdjEntries() == 6);
+    Graph dTree = Algorithms::dijkstra(soa, 0);
+    CHECK(hasEdge(dTree, 0,3,4));
+    CHECK(Algorithms::bfs(soa, 0).getNumAdjEntries() == 6);
+    CHECK(Algorithms::dfs(soa, 0).getNumAdjEntries() == 6);
+
+    // Same snapshot built from the CSR form
+    SoaCsrGraph fromCsr(g.freeze());
+    CHECK(fromCsr.getDestinations(2)[2] == 0);
+
+    if(std::numeric_limits<Weight>::is_signed) {
+        Graph neg(3);
+        neg.addEdge(0,1,5);
+        neg.addEdge(1,2,static_cast<Weight>(-1));
+        SoaCsrGraph negSoa(neg);
+        CHECK(negSoa.hasNegativeWeight());
+        CHECK_THROWS_AS(Algorithms::dijkstra(negSoa, 0), const char*);
+
+        // The CSR records are scanned with the same kernel: a negative weight anywhere, in a
+        // vector or in the scalar tail, is found
+        for(int bad = 0; bad < 39; bad++) {
+            Graph path(40);
+            for(int v = 0; v + 1 < 40; v++) {
+                path.addEdge(v, v + 1, v == bad ? static_cast<Weight>(-2) : Weight(3));
+            }
+            CHECK(path.freeze().hasNegativeWeight());
+        }
+        CHECK_FALSE(g.freeze().hasNegativeWeight());
+    }
+}
+
+TEST_CASE("Compressed graph decodes to the same sorted adjacency") {
+    // -3 where the weight type has negative values; 250 needs two bytes as a varint
+    const bool isSigned = std::numeric_limits<Weight>::is_signed;
+    const Weight small = isSigned ? static_cast<Weight>(-3) : Weight(3);
+    Graph g(6);
+    g.addEdge(0,5,7);
+    g.addEdge(0,1,small);
+    g.addEdge(0,3,200);
+    g.addEdge(1,2,1);
+    g.addEdge(2,4,250);
+    g.addEdge(4,5,2);
+
+    CompressedGraph cg(g);
+    CHECK(cg.getNumVertices() == 6);
+    CHECK(cg.getNumAdjEntries() == 12);
+    CHECK(cg.hasNegativeWeight() == isSigned);
+    CHECK(cg.getAdjSize(0) == 3);
+
+    // Neighbors of 0 come back sorted with their weights
+    int expectedDest[] = {1, 3, 5};
+    Weight expectedWeight[] = {small, 200, 7};
+    int i = 0;
+    for(CompressedGraph::NeighborIterator it = cg.neighbors(0); !it.done(); it.next()) {
+        CHECK(it.destination() == expectedDest[i]);
+        CHECK(it.weight() == expectedWeight[i]);
+        i++;
+    }
+    CHECK(i == 3);
+    CHECK(cg.neighbors(3).destination() == 0);
+    CHECK(cg.neighbors(3).weight() == 200);
+
+    if(isSigned) {
+        CHECK_THROWS_AS(Algorithms::dijkstra(cg, 0), const char*);
+    }
+    Graph bfsTree = Algorithms::bfs(cg, 0);
+    CHECK(hasEdge(bfsTree, 0,1,small));
+    CHECK(hasEdge(bfsTree, 0,5,7));
+    CHECK(hasEdge(bfsTree, 1,2));
+    CHECK(Algorithms::dfs(cg, 0).getNumAdjEntries() == 10);
+    CHECK(Algorithms::kruskal(cg).getNumAdjEntries() == 10);
+}
+
+TEST_CASE("Compressed graph is smaller than the CSR form") {
+    // A ring lattice: every vertex linked to its 8 nearest IDs
+    const int n = 2000;
+    Graph g(n);
+    for(int v = 0; v < n; v++) {
+        for(int k = 1; k <= 4; k++) {
+            g.addEdge(v, (v + k) % n, k);
+        }
+    }
+    CompressedGraph cg(g);
+    std::size_t csrBytes = (n + 1) * sizeof(std::size_t) + g.getNumAdjEntries() * sizeof(Edge);
+    // Floating point weights keep their raw bytes in both forms, so only the rest has to shrink
+    std::size_t rawWeightBytes = std::is_integral<Weight>::value ? 0 : g.getNumAdjEntries() * sizeof(Weight);
+    CHECK((cg.getMemoryBytes() - rawWeightBytes) * 3 < csrBytes - rawWeightBytes);
+
+    Graph fromCompressed = Algorithms::dijkstra(cg, 0);
+    Graph fromGraph = Algorithms::dijkstra(g, 0);
+    CHECK(fromCompressed.getNumAdjEntries() == fromGraph.getNumAdjEntries());
+}
+
+TEST_CASE("Twin indices survive growth, copies, bulk loads and removals") {
+    Graph g(6);
+    for(int i = 1; i < 6; i++) {
+        g.addEdge(0, i, i);      // vertex 0 grows through several reallocations
+    }
+    g.addEdge(2, 3, 9);
+    CHECK(twinsConsistent(g));
+
+    // Removing from the hub only searches the short list of vertex 4
+    g.removeEdge(0, 4);
+    CHECK_FALSE(hasEdge(g, 0, 4));
+    CHECK_FALSE(hasEdge(g, 4, 0));
+    CHECK(g.getAdjSize(0) == 4);
+    CHECK(twinsConsistent(g));
+
+    // O(1) removal by position
+    int idx = -1;
+    for(int i = 0; i < g.getAdjSize(2); i++) {
+        if(g.getAdjList(2)[i].destination == 3) idx = i;
+    }
+    REQUIRE(idx != -1);
+    g.removeEdgeAt(2, idx);
+    CHECK_FALSE(hasEdge(g, 3, 2));
+    CHECK(twinsConsistent(g));
+    CHECK_THROWS(g.removeEdgeAt(2, 5));
+
+    Graph copy(g);
+    CHECK(twinsConsistent(copy));
+
+    VertexId src[] = {1, 2, 3, 4, 5};
+    VertexId dst[] = {2, 3, 4, 5, 1};
+    copy.addEdges(src, dst, nullptr, 5);
+    CHECK(twinsConsistent(copy));
+
+    // Edge churn: remove everything in a scrambled order
+    const int n = 40;
+    Graph churn(n);
+    for(int u = 0; u < n; u++) {
+        for(int v = u + 1; v < n; v += 3) {
+            churn.addEdge(u, v, u + v);
+        }
+    }
+    for(int u = n - 1; u >= 0; u--) {
+        for(int v = u + 1; v < n; v += 3) {
+            if((u + v) % 2 == 0) churn.removeEdge(v, u);
+        }
+    }
+    CHECK(twinsConsistent(churn));
+    for(int u = 0; u < n; u++) {
+        for(int v = u + 1; v < n; v += 3) {
+            CHECK(hasEdge(churn, u, v) == ((u + v) % 2 != 0));
+        }
+    }
+
+    // Parallel edges can give a vertex more entries than there are vertices: the twin index of
+    // an entry past 65535 must not wrap, even when VertexId is 16 bits
+    Graph multi(3);
+    multi.addEdge(1, 2, 5);
+    for(int i = 0; i < 70000; i++) {
+        multi.addEdge(0, 1, 1);
+    }
+    multi.addEdge(0, 2, 7);
+    CHECK(multi.getTwinIndex(2, 1) == 70000);
+    multi.removeEdge(2, 0);
+    CHECK_FALSE(hasEdge(multi, 0, 2));
+    CHECK(hasEdge(multi, 1, 2, 5));
+    CHECK(multi.getAdjSize(1) == 70001);
+    CHECK(twinsConsistent(multi));
+}
+
+// prim / kruskal must not accept a DirectedGraph (checked at compile time)
+template <typename G>
+static auto primAccepts(int) -> decltype(Algorithms::prim(std::declval<const G&>()), true) { return true; }
+template <typename G>
+static bool primAccepts(...) { return false; }
+template <typename G>
+static auto kruskalAccepts(int) -> decltype(Algorithms::kruskal(std::declval<const G&>()), true) { return true; }
+template <typename G>
+static bool kruskalAccepts(...) { return false; }
+
+TEST_CASE("Directed graph stores one entry per edge") {
+    DirectedGraph g(4);
+    g.addEdge(0,1,2);
+    g.addEdge(1,2,3);
+    g.addEdge(2,0,1);
+    g.addEdge(0,3,10);
+    g.addEdge(2,3,1);
+    CHECK(g.getNumAdjEntries() == 5);
+    CHECK(g.getAdjSize(0) == 2);
+    CHECK(g.getAdjSize(3) == 0);
+
+    // Transpose index
+    CHECK(g.getInDegree(3) == 2);
+    CHECK(g.getInDegree(0) == 1);
+    CHECK(g.inNeighbors(0).destination() == 2);
+    g.removeEdge(2,0);
+    CHECK(g.getInDegree(0) == 0); // rebuilt after the mutation
+    CHECK_THROWS(g.removeEdge(2,0));
+    g.addEdge(2,0,1);
+
+    // BFS follows out-edges only: nothing reaches 0 from 3
+    DirectedGraph fromThree = Algorithms::bfs(g, 3);
+    CHECK(fromThree.getNumAdjEntries() == 0);
+
+    // Shortest path 0 -> 3 goes through 1 and 2 (2 + 3 + 1 = 6 < 10)
+    DirectedGraph tree = Algorithms::dijkstra(g, 0);
+    CHECK(tree.getNumAdjEntries() == 3);
+    CHECK(tree.getAdjSize(2) == 1);
+    CHECK(tree.getAdjList(2)[0].destination == 3);
+    CHECK(tree.getAdjSize(3) == 0); // the tree edge is directed
+
+    DirectedGraph dfsTree = Algorithms::dfs(g, 1);
+    CHECK(dfsTree.getNumAdjEntries() == 3);
+
+    CHECK(primAccepts<Graph>(0));
+    CHECK(kruskalAccepts<Graph>(0));
+    CHECK_FALSE(primAccepts<DirectedGraph>(0));
+    CHECK_FALSE(kruskalAccepts<DirectedGraph>(0));
+}
+
+TEST_CASE("Path lengths do not overflow the weight type") {
+    // 0-1-2 costs 2*max, which wraps around if distances are summed in Weight
+    // (or in a Distance of the same width, e.g. int64_t weights). A path as long as
+    // infiniteDistance() counts as unreachable, so the direct edge stays just below it.
+    Weight big = std::numeric_limits<Weight>::max();
+    if(static_cast<Distance>(big) == infiniteDistance()) {
+        big--;
+    }
+    Graph g(3);
+    g.addEdge(0,1,big);
+    g.addEdge(1,2,big);
+    g.addEdge(0,2,big);
+
+    Graph tree = Algorithms::dijkstra(g, 0);
+    CHECK(hasEdge(tree, 0, 2));
+    CHECK_FALSE(hasEdge(tree, 1, 2));
+    REQUIRE(tree.getAdjSize(2) == 1);
+    CHECK(tree.getAdjList(2)[0].weight == big);
+
+    // Large weights survive the compressed encoding
+    CompressedGraph cg(g);
+    CHECK(cg.neighbors(0).weight() == big);
+    Graph cgTree = Algorithms::dijkstra(cg, 0);
+    CHECK(hasEdge(cgTree, 0, 2));
+}
+
+TEST_CASE("Vertex ids at the edges of the valid range") {
+    Graph g(4);
+    g.addEdge(NO_VERTEX, 1, 1); // ignored whether VertexId is signed or not
+    g.addEdge(0, 4, 1);         // ignored
+    CHECK(g.getNumAdjEntries() == 0);
+    CHECK_FALSE(isValidVertex(NO_VERTEX, g.getNumVertices()));
+    CHECK_THROWS(g.removeEdge(NO_VERTEX, 1));
+
+    // The last vertex works like any other, and the root has no parent edge
+    g.addEdge(3, 2, 5);
+    g.addEdge(2, 0, 1);
+    Graph tree = Algorithms::dijkstra(g, 3);
+    CHECK(tree.getNumAdjEntries() == 4);
+    CHECK(hasEdge(tree, 3, 2, 5));
+    CHECK(hasEdge(tree, 2, 0, 1));
+
+    Graph mst = Algorithms::kruskal(g);
+    CHECK(mst.getNumAdjEntries() == 4);
+    CHECK(Algorithms::prim(g).getNumAdjEntries() == 4);
+}
+
+TEST_CASE("Memory-mapped graph file round trip") {
+    const char* path = "test_graph.bin";
+    Graph g(6);
+    g.addEdge(0,1,4);
+    g.addEdge(0,2,1);
+    g.addEdge(2,1,2);
+    g.addEdge(1,3,5);
+    g.addEdge(3,4,3);
+    // vertex 5 stays isolated
+    MappedGraph::write(g, path);
+
+    {
+        MappedGraph mg(path);
+        REQUIRE(mg.getNumVertices() == 6);
+        CHECK(mg.getNumAdjEntries() == g.getNumAdjEntries());
+        CHECK_FALSE(mg.hasNegativeWeight());
+        for(VertexId v = 0; v < 6; v++) {
+            REQUIRE(mg.getAdjSize(v) == g.getAdjSize(v));
+            for(int i = 0; i < g.getAdjSize(v); i++) {
+                CHECK(mg.getDestinations(v)[i] == g.getAdjList(v)[i].destination);
+                CHECK(mg.getWeights(v)[i] == g.getAdjList(v)[i].weight);
+            }
+        }
+
+        // The algorithms traverse the mapping directly
+        Graph tree = Algorithms::dijkstra(mg, 0);
+        CHECK(hasEdge(tree, 2, 1, 2));
+        CHECK_FALSE(hasEdge(tree, 0, 1));
+        CHECK(Algorithms::bfs(mg, 0).getNumAdjEntries() == 8);
+        CHECK(Algorithms::kruskal(mg).getNumAdjEntries() == Algorithms::prim(g).getNumAdjEntries());
+
+        MappedGraph moved(std::move(mg));
+        CHECK(moved.getNumVertices() == 6);
+        CHECK(mg.getNumVertices() == 0);
+    }
+
+    // The header records negative weights
+    if(std::numeric_limits<Weight>::is_signed) {
+        g.addEdge(4,5,static_cast<Weight>(-1));
+        MappedGraph::write(g.freeze(), path);
+        CHECK(MappedGraph(path).hasNegativeWeight());
+    }
+
+    // Truncated and missing files are rejected
+    std::FILE* f = std::fopen(path, "r+b");
+    REQUIRE(f != nullptr);
+    std::fseek(f, 0, SEEK_END);
+    long size = std::ftell(f);
+    std::fclose(f);
+    CHECK(truncate(path, size - 1) == 0);
+    CHECK_THROWS(MappedGraph(path));
+    std::remove(path);
+    CHECK_THROWS(MappedGraph(path));
+}
+
+static void writeTextFile(const char* path, const char* text) {
+    std::FILE* f = std::fopen(path, "wb");
+    REQUIRE(f != nullptr);
+    std::fputs(text, f);
+    std::fclose(f);
+}
+
+TEST_CASE("Text graph files: edge list, Matrix Market and DIMACS") {
+    // SNAP-style list: comments, both directions of 0-1 and a repeated 1-2 with a smaller weight
+    writeTextFile("test_graph.txt",
+                  "# comment\n0 1 5\n1 0 5\n1\t2 7\n\n2 3\r\n1 2 4\n% other comment\n3 4 -2.5e0\n4 5");
+    CHECK(GraphReader::formatOf("test_graph.txt") == GraphReader::EDGE_LIST);
+    Graph list = GraphReader::read("test_graph.txt");
+    CHECK(list.getNumVertices() == 6);
+    CHECK(list.getNumAdjEntries() == 10);
+    CHECK(hasEdge(list, 0, 1, 5));
+    CHECK(hasEdge(list, 2, 1, 4));
+    CHECK(hasEdge(list, 2, 3, 1));
+    CHECK(hasEdge(list, 4, 5, 1));
+    if(std::numeric_limits<Weight>::is_signed) {
+        CHECK(list.getAdjList(4)[0].weight == static_cast<Weight>(-2.5)); // -2 for integer weights
+    }
+    CHECK(twinsConsistent(list));
+
+    // Without merging, every line becomes an edge
+    Graph raw = GraphReader::read("test_graph.txt", GraphReader::EDGE_LIST, false);
+    CHECK(raw.getNumAdjEntries() == 14);
+
+    writeTextFile("test_graph.mtx",
+                  "%%MatrixMarket matrix coordinate integer symmetric\n% comment\n5 5 3\n2 1 3\n3 2 4\n5 1 9\n");
+    Graph mtx = GraphReader::read("test_graph.mtx");
+    CHECK(mtx.getNumVertices() == 5);
+    CHECK(mtx.getNumAdjEntries() == 6);
+    CHECK(hasEdge(mtx, 0, 1, 3));
+    CHECK(hasEdge(mtx, 4, 0, 9));
+
+    writeTextFile("test_graph.gr", "c road network\np sp 4 4\na 1 2 10\na 2 1 10\na 2 3 1\nc\na 4 3 2\n");
+    Graph gr = GraphReader::read("test_graph.gr");
+    CHECK(gr.getNumVertices() == 4);
+    CHECK(gr.getNumAdjEntries() == 6);
+    CHECK(hasEdge(gr, 3, 2, 2));
+
+    // Errors: bad line, id out of the declared range, missing file
+    writeTextFile("test_graph.txt", "0 1\n1 x\n");
+    CHECK_THROWS(GraphReader::read("test_graph.txt"));
+    writeTextFile("test_graph.gr", "p sp 2 1\na 1 3 1\n");
+    CHECK_THROWS(GraphReader::read("test_graph.gr"));
+    std::remove("test_graph.txt");
+    std::remove("test_graph.mtx");
+    std::remove("test_graph.gr");
+    CHECK_THROWS(GraphReader::read("test_graph.txt"));
+}
+
+TEST_CASE("Large edge list is parsed in parallel chunks") {
+    // ~2 MB so the file is split between threads; every edge appears once in each direction
+    const int n = 5000;
+    const int m = 100000;
+    std::FILE* f = std::fopen("test_graph_large.txt", "wb");
+    REQUIRE(f != nullptr);
+    Graph expected(n);
+    for(int e = 0; e < m; e++) {
+        int u = static_cast<int>((e * 7919LL) % n);
+        int v = static_cast<int>((e * 104729LL + 1) % n);
+        if(u == v || hasEdge(expected, u, v)) {
+            continue;
+        }
+        int w = e % 50 + 1;
+        expected.addEdge(u, v, w);
+        std::fprintf(f, "%d %d %d\n%d %d %d\n", u, v, w, v, u, w);
+    }
+    std::fclose(f);
+
+    Graph g = GraphReader::read("test_graph_large.txt");
+    std::remove("test_graph_large.txt");
+    REQUIRE(g.getNumVertices() == n);
+    CHECK(g.getNumAdjEntries() == expected.getNumAdjEntries());
+    bool same = true;
+    for(VertexId u = 0; u < n; u++) {
+        for(int i = 0; i < expected.getAdjSize(u); i++) {
+            const Edge& e = expected.getAdjList(u)[i];
+            same = same && hasEdge(g, u, e.destination, e.weight);
+        }
+    }
+    CHECK(same);
+    CHECK(twinsConsistent(g));
+}
+
+TEST_CASE("Vertices can be added to an existing graph") {
+    Graph g(3);
+    g.addEdge(0,1,2);
+    g.addEdge(1,2,3);
+    Edge* oldList = g.getAdjList(1);
+
+    // Growing the vertex arrays keeps the edge storage in place
+    for(int i = 0; i < 1000; i++) {
+        CHECK(g.addVertex() == static_cast<VertexId>(3 + i));
+    }
+    CHECK(g.getNumVertices() == 1003);
+    CHECK(g.getVertexCapacity() >= 1003);
+    CHECK(g.getAdjList(1) == oldList);
+    CHECK(hasEdge(g, 1, 2, 3));
+    CHECK(g.getAdjSize(1002) == 0);
+
+    g.addEdge(1002, 0, 7);
+    CHECK(hasEdge(g, 0, 1002, 7));
+    CHECK(twinsConsistent(g));
+    g.addEdge(1003, 0, 1); // still out of range
+    CHECK(g.getAdjSize(0) == 2);
+
+    // reserveVertices: no reallocation until the reserved count is reached
+    Graph empty;
+    CHECK(empty.getNumVertices() == 0);
+    empty.reserveVertices(100);
+    CHECK(empty.getVertexCapacity() == 100);
+    for(int i = 0; i < 100; i++) {
+        empty.addVertex();
+    }
+    CHECK(empty.getVertexCapacity() == 100);
+    empty.addEdge(0, 99);
+    CHECK(Algorithms::bfs(empty, 99).getNumAdjEntries() == 2);
+
+    // Copies and moves keep working after growth
+    Graph copy(g);
+    CHECK(copy.getNumVertices() == 1003);
+    CHECK(hasEdge(copy, 1002, 0, 7));
+    Graph moved(std::move(copy));
+    CHECK(moved.addVertex() == 1003);
+}
+
+TEST_CASE("Algorithms on an empty graph") {
+    Graph empty;
+    Graph sized(0);
+    CHECK(sized.getNumVertices() == 0);
+    CHECK(sized.getNumAdjEntries() == 0);
+    CHECK(sized.addVertex() == 0);
+
+    // There is no vertex to start a search from
+    CHECK_THROWS_AS(Algorithms::bfs(empty, 0), const char*);
+    CHECK_THROWS_AS(Algorithms::dijkstra(empty, 0), const char*);
+    CHECK_THROWS_AS(Algorithms::dijkstraResult(empty.freeze(), 0), const char*);
+
+    // Spanning trees of no vertices are empty
+    CHECK(Algorithms::prim(empty).getNumVertices() == 0);
+    CHECK(Algorithms::primResult(empty).getNumEdges() == 0);
+    CHECK(Algorithms::prim(DenseGraph(empty)).getNumVertices() == 0);
+    CHECK(Algorithms::kruskal(empty).getNumVertices() == 0);
+    CHECK(Algorithms::kruskalResult(empty.freeze()).getNumEdges() == 0);
+
+    DeltaGraph delta(empty);
+    CHECK(delta.getNumVertices() == 0);
+    CHECK(delta.toGraph().getNumVertices() == 0);
+    delta.compact();
+    CHECK(delta.toGraph().getNumAdjEntries() == 0);
+}
+
+TEST_CASE("Reordering relabels the graph and maps ids both ways") {
+    // Path 0-1-...-49 with scattered ids: vertex i of the path is (i * 17) % 50
+    const int n = 50;
+    Graph g(n);
+    for(int i = 0; i + 1 < n; i++) {
+        g.addEdge((i * 17) % n, ((i + 1) * 17) % n, i + 1);
+    }
+    g.addEdge(10, 25, 100); // one chord between two inner vertices, so the degrees differ
+
+    Reorder::Strategy strategies[] = { Reorder::DEGREE_DESC, Reorder::BFS_ORDER, Reorder::RCM, Reorder::GORDER };
+    for(int s = 0; s < 4; s++) {
+        Reordering r = Reorder::reorder(g, strategies[s]);
+        const Graph& h = r.getGraph();
+        CHECK(h.getNumVertices() == n);
+        CHECK(h.getNumAdjEntries() == g.getNumAdjEntries());
+        CHECK(twinsConsistent(h));
+        bool same = true;
+        for(VertexId v = 0; v < n; v++) {
+            same = same && r.getOldId(r.getNewId(v)) == v;
+            for(int i = 0; i < g.getAdjSize(v); i++) {
+                const Edge& e = g.getAdjList(v)[i];
+                same = same && hasEdge(h, r.getNewId(v), r.getNewId(e.destination), e.weight);
+            }
+        }
+        CHECK(same);
+
+        // Results on the relabeled graph map back to the original ids
+        Graph tree = r.toOriginalIds(Algorithms::bfs(h, r.getNewId(7)));
+        CHECK(tree.getNumAdjEntries() == 2 * (n - 1));
+        bool inGraph = true;
+        for(VertexId v = 0; v < n; v++) {
+            for(int i = 0; i < tree.getAdjSize(v); i++) {
+                inGraph = inGraph && hasEdge(g, v, tree.getAdjList(v)[i].destination, tree.getAdjList(v)[i].weight);
+            }
+        }
+        CHECK(inGraph);
+    }
+
+    // Degree order: the two degree-3 chord ends come first
+    Reordering byDegree = Reorder::reorder(g, Reorder::DEGREE_DESC);
+    CHECK(byDegree.getGraph().getAdjSize(0) == 3);
+    CHECK(byDegree.getGraph().getAdjSize(1) == 3);
+    CHECK(byDegree.getGraph().getAdjSize(2) == 2);
+
+    // RCM turns a path (without the chord) back into consecutive ids
+    Graph path(n);
+    for(int i = 0; i + 1 < n; i++) {
+        path.addEdge((i * 17) % n, ((i + 1) * 17) % n);
+    }
+    Reordering rcm = Reorder::reorder(path, Reorder::RCM);
+    bool bandwidthOne = true;
+    for(VertexId v = 0; v < n; v++) {
+        for(int i = 0; i < rcm.getGraph().getAdjSize(v); i++) {
+            VertexId w = rcm.getGraph().getAdjList(v)[i].destination;
+            bandwidthOne = bandwidthOne && (v > w ? v - w : w - v) == 1;
+        }
+    }
+    CHECK(bandwidthOne);
+
+    // Copy and move keep both arrays
+    Reordering copy(rcm);
+    Reordering moved(std::move(rcm));
+    CHECK(copy.getOldId(0) == moved.getOldId(0));
+    CHECK(rcm.getNumVertices() == 0);
+
+    VertexId notPermutation[n];
+    for(int i = 0; i < n; i++) {
+        notPermutation[i] = i / 2;
+    }
+    CHECK_THROWS(Reorder::relabel(g, notPermutation));
+}
+
+TEST_CASE("Gorder keeps interleaved clusters together") {
+    // Two 6-cliques, one on the even ids and one on the odd ids
+    Graph g(12);
+    for(int a = 0; a < 12; a++) {
+        for(int b = a + 2; b < 12; b += 2) {
+            g.addEdge(a, b);
+        }
+    }
+    Reordering r = Reorder::reorder(g, Reorder::GORDER);
+    for(int parity = 0; parity < 2; parity++) {
+        VertexId low = r.getNewId(parity);
+        VertexId high = r.getNewId(parity);
+        for(int v = parity; v < 12; v += 2) {
+            low = std::min(low, r.getNewId(v));
+            high = std::max(high, r.getNewId(v));
+        }
+        CHECK(high - low == 5);
+    }
+    // Adjacency lists of the relabeled graph are sorted by the new ids
+    for(VertexId v = 0; v < 12; v++) {
+        for(int i = 1; i < r.getGraph().getAdjSize(v); i++) {
+            CHECK(r.getGraph().getAdjList(v)[i - 1].destination < r.getGraph().getAdjList(v)[i].destination);
+        }
+    }
+}
+
+TEST_CASE("Memory policy: huge pages and NUMA placement") {
+    // Path over 300000 vertices: the CSR edge array (600000 entries) is above 2 MB (16-bit ids: 60000 vertices)
+    const VertexId n = static_cast<VertexId>(sizeof(VertexId) < 4 ? 60000 : 300000);
+    Graph g(n);
+    for(VertexId v = 0; v + 1 < n; v++) {
+        g.addEdge(v, v + 1, 1);
+    }
+    std::size_t expected = Algorithms::bfs(g, 0).getNumAdjEntries();
+
+    MemoryPolicy::Pages pages[] = { MemoryPolicy::DEFAULT_PAGES, MemoryPolicy::SMALL_PAGES,
+                                    MemoryPolicy::TRANSPARENT_HUGE_PAGES, MemoryPolicy::HUGETLB_PAGES };
+    MemoryPolicy::Placement placements[] = { MemoryPolicy::FIRST_TOUCH, MemoryPolicy::INTERLEAVED, MemoryPolicy::PARTITIONED };
+    for(int p = 0; p < 4; p++) {
+        for(int q = 0; q < 3; q++) {
+            MemoryPolicy::set(pages[p], placements[q]);
+            CHECK(MemoryPolicy::getPages() == pages[p]);
+            CHECK(MemoryPolicy::getPlacement() == placements[q]);
+
+            // Large arrays are whole, aligned huge pages; small ones come from operator new
+            std::size_t count = 3 * MemoryPolicy::HUGE_PAGE_BYTES / sizeof(int) + 5;
+            int* large = MemoryPolicy::allocateArray<int>(count);
+            CHECK(reinterpret_cast<std::uintptr_t>(large) % MemoryPolicy::HUGE_PAGE_BYTES == 0);
+            for(std::size_t i = 0; i < count; i++) {
+                large[i] = static_cast<int>(i);
+            }
+            CHECK(large[count - 1] == static_cast<int>(count - 1));
+            MemoryPolicy::releaseArray(large, count);
+            int* small = MemoryPolicy::allocateArray<int>(10);
+            small[9] = 1;
+            MemoryPolicy::releaseArray(small, 10);
+
+            // Snapshots, slab chunks and work arrays all come from the policy
+            CsrGraph csr = g.freeze();
+            CHECK(Algorithms::bfs(csr, 0).getNumAdjEntries() == expected);
+            Graph copy(g);
+            CHECK(Algorithms::dijkstra(copy, n - 1).getNumAdjEntries() == expected);
+        }
+    }
+    MemoryPolicy::set(MemoryPolicy::DEFAULT_PAGES, MemoryPolicy::FIRST_TOUCH);
+    CHECK(MemoryPolicy::getNumNodes() >= 1);
+}
+
+// Compares every neighbor list of 'd' with an n x n weight matrix (0 = no edge)
+static bool matchesMatrix(const DeltaGraph& d, const int* matrix, int n) {
+    std::size_t entries = 0;
+    for(int u = 0; u < n; u++) {
+        int degree = 0;
+        for(DeltaGraph::NeighborIterator it = d.neighbors(u); !it.done(); it.next()) {
+            if(matrix[u * n + it.destination()] != it.weight()) {
+                return false;
+            }
+            degree++;
+        }
+        int expected = 0;
+        for(int v = 0; v < n; v++) {
+            expected += matrix[u * n + v] != 0 ? 1 : 0;
+        }
+        if(degree != expected || d.getAdjSize(u) != expected) {
+            return false;
+        }
+        entries += degree;
+    }
+    return entries == d.getNumAdjEntries();
+}
+
+TEST_CASE("Delta graph layers inserts and tombstones over the base") {
+    Graph g(6);
+    g.addEdge(0,1,5);
+    g.addEdge(1,2,3);
+    g.addEdge(2,3,4);
+    g.addEdge(3,4,1);
+    DeltaGraph d(g, 1000);
+    CHECK(d.getNumAdjEntries() == 8);
+
+    d.removeEdge(1,2);                 // tombstone over the base
+    d.addEdge(4,5,2);                  // insert
+    d.addEdge(2,1,9);                  // re-added with another weight
+    d.addEdge(0,1,7);                  // replaces a base edge
+    d.addEdge(0,5,1);
+    d.removeEdge(5,0);                 // removes an insert
+    CHECK_THROWS(d.removeEdge(0,5));
+    CHECK_THROWS(d.removeEdge(0,4));
+    CHECK(!d.isCompacting());
+
+    int matrix[36] = {0};
+    int edges[][3] = { {0,1,7}, {1,2,9}, {2,3,4}, {3,4,1}, {4,5,2} };
+    for(int e = 0; e < 5; e++) {
+        matrix[edges[e][0] * 6 + edges[e][1]] = edges[e][2];
+        matrix[edges[e][1] * 6 + edges[e][0]] = edges[e][2];
+    }
+    CHECK(matchesMatrix(d, matrix, 6));
+    CHECK(d.hasEdge(2,1));
+    CHECK(!d.hasEdge(0,5));
+    CHECK(Algorithms::bfs(d, 0).getNumAdjEntries() == 10);
+    CHECK(Algorithms::dijkstra(d, 0).getNumAdjEntries() == 10);
+
+    // Folding the layers keeps the contents and leaves sorted base lists
+    d.compact();
+    CHECK(d.getDeltaSize() == 0);
+    CHECK(matchesMatrix(d, matrix, 6));
+    Graph plain = d.toGraph();
+    CHECK(hasEdge(plain, 1, 2, 9));
+    CHECK(hasEdge(plain, 0, 1, 7));
+    CHECK(plain.getNumAdjEntries() == 10);
+}
+
+TEST_CASE("Delta graph compacts in the background while it is being read and written") {
+    const int n = 60;
+    int* matrix = new int[n * n];
+    for(int i = 0; i < n * n; i++) {
+        matrix[i] = 0;
+    }
+    Graph g(n);
+    for(int u = 0; u + 1 < n; u++) {
+        g.addEdge(u, u + 1, 1);
+        matrix[u * n + u + 1] = matrix[(u + 1) * n + u] = 1;
+    }
+    DeltaGraph d(g, 32);
+
+    unsigned int seed = 12345;
+    bool consistent = true;
+    bool compactionSeen = false;
+    for(int step = 0; step < 4000; step++) {
+        seed = seed * 1103515245u + 12345u;
+        int u = static_cast<int>((seed >> 8) % n);
+        int v = static_cast<int>((seed >> 20) % n);
+        if(u == v) {
+            continue;
+        }
+        if(matrix[u * n + v] != 0 && (seed & 1) == 0) {
+            d.removeEdge(u, v);
+            matrix[u * n + v] = matrix[v * n + u] = 0;
+        } else {
+            int w = 1 + static_cast<int>((seed >> 4) % 50);
+            d.addEdge(u, v, w);
+            matrix[u * n + v] = matrix[v * n + u] = w;
+        }
+        compactionSeen = compactionSeen || d.isCompacting();
+        consistent = consistent && d.hasEdge(u, v) == (matrix[u * n + v] != 0);
+        if(step % 97 == 0) {
+            consistent = consistent && matchesMatrix(d, matrix, n);
+        }
+    }
+    CHECK(consistent);
+    CHECK(compactionSeen);
+    d.waitForCompaction();
+    CHECK(!d.isCompacting());
+    CHECK(matchesMatrix(d, matrix, n));
+    d.compact();
+    CHECK(d.getDeltaSize() == 0);
+    CHECK(matchesMatrix(d, matrix, n));
+
+    // Moving waits for the compactor; a pending result moves with the graph
+    d.addEdge(0, n - 1, 3);
+    matrix[n - 1] = matrix[(n - 1) * n] = 3;
+    DeltaGraph moved(std::move(d));
+    CHECK(d.getNumVertices() == 0);
+    CHECK(matchesMatrix(moved, matrix, n));
+    moved.waitForCompaction();
+    CHECK(!moved.isCompacting());
+    CHECK(matchesMatrix(moved, matrix, n));
+    delete[] matrix;
+}
+
+TEST_CASE("Sorted adjacency: binary-search lookups and neighbor intersection") {
+    // Random edges checked against an adjacency matrix, with sorted mode switched on halfway
+    const int n = 40;
+    static int matrix[n][n];
+    for(int i = 0; i < n; i++) {
+        for(int j = 0; j < n; j++) {
+            matrix[i][j] = 0;
+        }
+    }
+    Graph g(n);
+    unsigned state = 12345;
+    for(int step = 0; step < 3000; step++) {
+        if(step == 1000) {
+            g.setSortedAdjacency(true);
+            CHECK(g.hasSortedAdjacency());
+        }
+        state = state * 1103515245u + 12345u;
+        int u = static_cast<int>((state >> 8) % n);
+        int v = static_cast<int>((state >> 20) % n);
+        if(u == v) {
+            continue;
+        }
+        if(matrix[u][v] != 0) {
+            g.removeEdge(u, v);
+            matrix[u][v] = matrix[v][u] = 0;
+        } else {
+            int w = 1 + step % 9;
+            g.addEdge(u, v, w);
+            matrix[u][v] = matrix[v][u] = w;
+        }
+    }
+
+    for(int u = 0; u < n; u++) {
+        for(int i = 1; i < g.getAdjSize(u); i++) {
+            CHECK(g.getAdjList(u)[i - 1].destination < g.getAdjList(u)[i].destination);
+        }
+        for(int i = 0; i < g.getAdjSize(u); i++) {
+            // Twin indices survive the shifts
+            VertexId v = g.getAdjList(u)[i].destination;
+            CHECK(g.getAdjList(v)[ g.getTwinIndex(u, i) ].destination == static_cast<VertexId>(u));
+        }
+        for(int v = 0; v < n; v++) {
+            CHECK(g.hasEdge(u, v) == (matrix[u][v] != 0));
+            if(matrix[u][v] != 0) {
+                CHECK(g.edgeWeight(u, v) == matrix[u][v]);
+            }
+            int common = 0;
+            for(int x = 0; x < n; x++) {
+                common += (matrix[u][x] != 0 && matrix[v][x] != 0) ? 1 : 0;
+            }
+            CHECK(g.countCommonNeighbors(u, v) == static_cast<std::size_t>(common));
+        }
+    }
+    CHECK_THROWS(g.edgeWeight(0, 0));
+    CHECK_FALSE(g.hasEdge(0, n));
+
+    // Bulk insertion and copies keep the lists sorted; unsorted graphs refuse the intersection
+    Graph copy = g;
+    const VertexId src[] = { 5, 5, 5 };
+    const VertexId dst[] = { 39, 1, 20 };
+    copy.addEdges(src, dst, nullptr, 3);
+    for(int i = 1; i < copy.getAdjSize(5); i++) {
+        CHECK(copy.getAdjList(5)[i - 1].destination <= copy.getAdjList(5)[i].destination);
+    }
+    Graph plain(3);
+    plain.addEdge(0, 1);
+    CHECK_THROWS(plain.countCommonNeighbors(0, 1));
+}
+
+TEST_CASE("Common neighbors of a hub are found by galloping") {
+    // Vertex 0 is adjacent to everyone, vertex 1 to a few: the ratio triggers galloping
+    const VertexId n = 2000;
+    Graph g(n);
+    for(VertexId v = 1; v < n; v++) {
+        g.addEdge(0, v);
+    }
+    const VertexId picks[] = { 2, 3, 500, 1998, 1999 };
+    for(int i = 0; i < 5; i++) {
+        g.addEdge(1, picks[i]);
+    }
+    g.setSortedAdjacency(true);
+    CHECK(g.countCommonNeighbors(0, 1) == 5);
+    CHECK(g.countCommonNeighbors(1, 0) == 5);
+    CHECK(g.countCommonNeighbors(2, 3) == 2);
+    CHECK(g.hasEdge(0, 1999));
+    CHECK(g.hasEdge(1999, 1));
+    CHECK_FALSE(g.hasEdge(1, 1997));
+
+    // Relabeled graphs come out sorted
+    VertexId* ids = new VertexId[n];
+    for(VertexId v = 0; v < n; v++) {
+        ids[v] = n - 1 - v;
+    }
+    Graph relabeled = Reorder::relabel(g, ids);
+    delete[] ids;
+    CHECK(relabeled.hasSortedAdjacency());
+    CHECK(relabeled.countCommonNeighbors(n - 1, n - 2) == 5);
+}
+
+// Distance from 'root' to every vertex along the edges of a tree (-1 if not in the tree);
+// with countHops every edge counts 1
+static void treeDistances(const Graph& tree, VertexId root, long long* dist, bool countHops = false) {
+    for(VertexId v = 0; v < tree.getNumVertices(); v++) {
+        dist[v] = -1;
+    }
+    VertexId* stack = new VertexId[tree.getNumVertices()];
+    int top = 0;
+    dist[root] = 0;
+    stack[top++] = root;
+    while(top > 0) {
+        VertexId u = stack[--top];
+        for(Graph::NeighborIterator it = tree.neighbors(u); !it.done(); it.next()) {
+            if(dist[it.destination()] < 0) {
+                dist[it.destination()] = dist[u] + (countHops ? 1 : static_cast<long long>(it.weight()));
+                stack[top++] = it.destination();
+            }
+        }
+    }
+    delete[] stack;
+}
+
+static long long totalWeight(const Graph& g) {
+    long long total = 0;
+    for(VertexId v = 0; v < g.getNumVertices(); v++) {
+        for(Graph::NeighborIterator it = g.neighbors(v); !it.done(); it.next()) {
+            total += static_cast<long long>(it.weight());
+        }
+    }
+    return total / 2;
+}
+
+TEST_CASE("Dense graph: bit-matrix adjacency and O(V^2) Dijkstra / Prim") {
+    // About half of all pairs, weights 1..50; vertex 89 is isolated
+    const VertexId n = 90;
+    Graph g(n);
+    unsigned state = 777;
+    for(VertexId u = 0; u + 1 < n - 1; u++) {
+        for(VertexId v = u + 1; v < n - 1; v++) {
+            state = state * 1103515245u + 12345u;
+            if((state >> 16) % 2 == 0) {
+                g.addEdge(u, v, static_cast<Weight>(1 + (state >> 8) % 50));
+            }
+        }
+    }
+    REQUIRE(DenseGraph::isDenseEnough(n, g.getNumAdjEntries()));
+    CHECK_FALSE(DenseGraph::isDenseEnough(10, 90));
+    CHECK(DenseGraph::shouldConvert(n, g.getNumAdjEntries()));
+
+    // No per-call matrix of 1.6 GB: a large dense graph has to be converted by the caller
+    const VertexId big = 20000;
+    std::size_t bigEntries = static_cast<std::size_t>(big) * (big - 1);
+    CHECK(DenseGraph::isDenseEnough(big, bigEntries));
+    CHECK(DenseGraph::matrixBytes(big) >= static_cast<std::size_t>(big) * big * sizeof(Weight));
+    CHECK_FALSE(DenseGraph::shouldConvert(big, bigEntries));
+
+    DenseGraph d(g);
+    CHECK(d.getNumVertices() == n);
+    CHECK(d.getNumAdjEntries() == g.getNumAdjEntries());
+    for(VertexId u = 0; u < n; u++) {
+        CHECK(d.getAdjSize(u) == g.getAdjSize(u));
+        VertexId previous = 0;
+        int count = 0;
+        for(DenseGraph::NeighborIterator it = d.neighbors(u); !it.done(); it.next()) {
+            CHECK((count == 0 || previous < it.destination()));
+            CHECK(g.edgeWeight(u, it.destination()) == it.weight());
+            previous = it.destination();
+            count++;
+        }
+        CHECK(count == g.getAdjSize(u));
+        for(VertexId v = 0; v < n; v++) {
+            CHECK(d.hasEdge(u, v) == g.hasEdge(u, v));
+        }
+    }
+    CHECK_THROWS(d.edgeWeight(0, n - 1));
+    CHECK_FALSE(d.hasEdge(0, n));
+
+    // Same distances as the heap-based version (the trees may differ on ties)
+    SoaCsrGraph sparse(g);
+    long long denseDist[n];
+    long long sparseDist[n];
+    treeDistances(Algorithms::dijkstra(g, 0), 0, denseDist);
+    treeDistances(Algorithms::dijkstra(sparse, 0), 0, sparseDist);
+    for(VertexId v = 0; v < n - 1; v++) {
+        CHECK(denseDist[v] == sparseDist[v]);
+    }
+    CHECK(Algorithms::dijkstra(d, 0).getAdjSize(n - 1) == 0);
+
+    long long mstWeight = totalWeight(Algorithms::kruskal(g));
+    CHECK(totalWeight(Algorithms::prim(d)) == mstWeight);
+    CHECK(totalWeight(Algorithms::prim(g.freeze())) == mstWeight);
+    CHECK(totalWeight(Algorithms::prim(sparse)) == mstWeight);
+    CHECK(Algorithms::prim(g).getNumAdjEntries() == 2 * (n - 2));
+
+    // The generic algorithms run on the matrix too
+    CHECK(Algorithms::bfs(d, 0).getNumAdjEntries() == 2 * (n - 2));
+
+    DenseGraph copy = d;
+    DenseGraph moved(std::move(copy));
+    CHECK(moved.getNumAdjEntries() == d.getNumAdjEntries());
+    CHECK(moved.hasEdge(3, 7) == g.hasEdge(3, 7));
+    CHECK(copy.getNumVertices() == 0);
+
+    if(std::numeric_limits<Weight>::is_signed) {
+        g.addEdge(0, 1, static_cast<Weight>(-3));
+        CHECK_THROWS(Algorithms::dijkstra(g, 0));
+    }
+}
+
+TEST_CASE("SIMD argmin returns the first smallest entry") {
+    long long ints[100];
+    double doubles[100];
+    for(int count = 1; count <= 100; count++) {
+        unsigned state = 99u + count;
+        for(int i = 0; i < count; i++) {
+            state = state * 1103515245u + 12345u;
+            ints[i] = static_cast<long long>((state >> 16) % 20) - 5;
+            doubles[i] = (i % 7 == 3) ? std::numeric_limits<double>::infinity() : static_cast<double>(ints[i]) / 4;
+        }
+        int intBest = 0;
+        int doubleBest = 0;
+        for(int i = 1; i < count; i++) {
+            intBest = ints[i] < ints[intBest] ? i : intBest;
+            doubleBest = doubles[i] < doubles[doubleBest] ? i : doubleBest;
+        }
+        CHECK(simd::argmin(ints, count) == static_cast<std::size_t>(intBest));
+        CHECK(simd::argmin(doubles, count) == static_cast<std::size_t>(doubleBest));
+    }
+    const long long big[] = { std::numeric_limits<long long>::max(), std::numeric_limits<long long>::min(), 0 };
+    CHECK(simd::argmin(big, 3) == 1);
+}
+
+TEST_CASE("External graph streams BFS, components and Kruskal from disk") {
+    // Random edges among vertices 0..239, a separate triangle 240..242, the rest isolated
+    const VertexId n = 250;
+    const std::size_t m = 700;
+    VertexId src[m + 3];
+    VertexId dst[m + 3];
+    Weight w[m + 3];
+    unsigned state = 4242;
+    for(std::size_t e = 0; e < m; e++) {
+        state = state * 1103515245u + 12345u;
+        src[e] = static_cast<VertexId>((state >> 8) % 240);
+        state = state * 1103515245u + 12345u;
+        dst[e] = static_cast<VertexId>((state >> 8) % 240);
+        w[e] = static_cast<Weight>(1 + (state >> 20) % 100);
+    }
+    src[m] = 240; dst[m] = 241; w[m] = 5;
+    src[m + 1] = 241; dst[m + 1] = 242; w[m + 1] = 6;
+    src[m + 2] = 240; dst[m + 2] = 242; w[m + 2] = 7;
+    Graph g(n, src, dst, w, m + 3);
+    const char* path = "test_graph_external.bin";
+    MappedGraph::write(g, path);
+
+    VertexId expected[n];
+    VertexId expectedCount = Algorithms::connectedComponents(g, expected);
+    long long expectedDepth[n];
+    treeDistances(Algorithms::bfs(g, 0), 0, expectedDepth, true);
+    long long mstWeight = totalWeight(Algorithms::kruskal(g));
+
+    // 64-byte buffers and a 256-byte sort budget: many refills, and so many Kruskal runs that they
+    // are merged two at a time over several passes; the defaults: one block and one run
+    const std::size_t bufferSizes[] = { 64, ExternalGraph::DEFAULT_BUFFER_BYTES };
+    const std::size_t sortSizes[] = { 256, ExternalGraph::DEFAULT_SORT_BYTES };
+    for(int b = 0; b < 2; b++) {
+        ExternalGraph eg(path, bufferSizes[b], sortSizes[b]);
+        CHECK(eg.getNumVertices() == n);
+        CHECK(eg.getNumAdjEntries() == g.getNumAdjEntries());
+        CHECK(eg.getAdjSize(240) == 2);
+
+        VertexId component[n];
+        CHECK(Algorithms::connectedComponents(eg, component) == expectedCount);
+        for(VertexId v = 0; v < n; v++) {
+            CHECK(component[v] == expected[v]);
+        }
+
+        long long depth[n];
+        treeDistances(Algorithms::bfs(eg, 0), 0, depth, true);
+        for(VertexId v = 0; v < n; v++) {
+            CHECK(depth[v] == expectedDepth[v]);
+        }
+
+        Graph mst = Algorithms::kruskal(eg);
+        CHECK(totalWeight(mst) == mstWeight);
+        CHECK(mst.getNumAdjEntries() == 2 * static_cast<std::size_t>(n - expectedCount));
+    }
+
+    // The reader walks every list in order, across block boundaries
+    ExternalGraph eg(path, 64);
+    ExternalScanner scanner(eg);
+    for(VertexId v = 0; v < n; v++) {
+        int i = 0;
+        for(scanner.open(v); !scanner.done(); scanner.next(), i++) {
+            CHECK(scanner.destination() == g.getAdjList(v)[i].destination);
+            CHECK(scanner.weight() == g.getAdjList(v)[i].weight);
+        }
+        CHECK(i == g.getAdjSize(v));
+    }
+    ExternalGraph moved(std::move(eg));
+    CHECK(moved.getNumVertices() == n);
+    CHECK(eg.getNumVertices() == 0);
+
+    std::remove(path);
+    CHECK_THROWS(ExternalGraph(path));
+}
+
+TEST_CASE("Result types: parent / depth / distance arrays and MST edge lists") {
+    // 0-1 (4), 0-2 (1), 2-1 (2), 1-3 (5), 2-3 (8), 3-4 (3); vertex 5 is isolated
+    Graph g(6);
+    g.addEdge(0, 1, 4);
+    g.addEdge(0, 2, 1);
+    g.addEdge(2, 1, 2);
+    g.addEdge(1, 3, 5);
+    g.addEdge(2, 3, 8);
+    g.addEdge(3, 4, 3);
+
+    BfsResult bfs = Algorithms::bfsResult(g, 0);
+    CHECK(bfs.getSource() == 0);
+    CHECK(bfs.getNumReached() == 5);
+    CHECK(bfs.getDepth(0) == 0);
+    CHECK(bfs.getParent(0) == NO_VERTEX);
+    CHECK(bfs.getDepth(2) == 1);
+    CHECK(bfs.getParent(3) == 1);
+    CHECK(bfs.getParentWeight(3) == 5);
+    CHECK(bfs.getDepth(4) == 3);
+    CHECK_FALSE(bfs.isReached(5));
+    CHECK(bfs.getDepth(5) == NO_VERTEX);
+    Graph bfsTree = bfs.toGraph();
+    CHECK(bfsTree.getNumAdjEntries() == 8);
+    CHECK(hasEdge(bfsTree, 1, 3, 5));
+    CHECK(hasEdge(bfsTree, 3, 4, 3));
+
+    DfsResult dfs = Algorithms::dfsResult(g.freeze(), 0);
+    CHECK(dfs.getParent(2) == 1);
+    CHECK(dfs.getParent(3) == 2);
+    CHECK(dfs.getDepth(4) == 4);
+
+    SsspResult sp = Algorithms::dijkstraResult(g, 0);
+    CHECK(sp.getDistance(0) == 0);
+    CHECK(sp.getDistance(1) == 3);
+    CHECK(sp.getDistance(3) == 8);
+    CHECK(sp.getDistance(4) == 11);
+    CHECK(sp.getParent(1) == 2);
+    CHECK(sp.getParent(3) == 1);
+    CHECK_FALSE(sp.isReached(5));
+    CHECK(sp.getDistance(5) == infiniteDistance());
+    long long dist[6];
+    treeDistances(sp.toGraph(), 0, dist);
+    for(VertexId v = 0; v < 5; v++) {
+        CHECK(dist[v] == static_cast<long long>(sp.getDistance(v)));
+    }
+
+    // Kruskal lists the edges by weight, Prim in the order they join the tree
+    MstResult kruskal = Algorithms::kruskalResult(g);
+    CHECK(kruskal.getNumEdges() == 4);
+    CHECK(kruskal.getTotalWeight() == 11);
+    CHECK_FALSE(kruskal.isSpanningTree());
+    CHECK(kruskal.getEdge(0).w == 1);
+    CHECK(kruskal.getEdge(3).w == 5);
+    MstResult prim = Algorithms::primResult(g);
+    CHECK(prim.getTotalWeight() == 11);
+    CHECK(prim.getEdge(0).u == 0);
+    CHECK(prim.getEdge(0).v == 2);
+    CHECK(totalWeight(prim.toGraph()) == 11);
+
+    // Directed input gives a directed tree
+    DirectedGraph dg(4);
+    dg.addEdge(0, 1);
+    dg.addEdge(1, 2);
+    dg.addEdge(3, 0);
+    BfsResult directed = Algorithms::bfsResult(dg, 0);
+    CHECK_FALSE(directed.isReached(3));
+    CHECK(directed.toDirectedGraph().getNumAdjEntries() == 2);
+
+    // A start vertex outside the graph throws like the workspace forms do
+    CHECK_THROWS_AS(Algorithms::bfsResult(g, 6), const char*);
+    CHECK_THROWS_AS(Algorithms::bfsResult(g, NO_VERTEX), const char*);
+    CHECK_THROWS_AS(Algorithms::dfsResult(g.freeze(), 6), const char*);
+    CHECK_THROWS_AS(Algorithms::dijkstraResult(g, 6), const char*);
+    CHECK_THROWS_AS(Algorithms::dijkstraResult(DenseGraph(g), 6), const char*);
+    CHECK_THROWS_AS(Algorithms::directionOptimizingBfs(g, 6), const char*);
+    CHECK_THROWS_AS(Algorithms::dfs(dg, 4), const char*);
+
+    // Copy / move
+    BfsResult copy = bfs;
+    CHECK(copy.getParent(3) == 1);
+    BfsResult moved(std::move(bfs));
+    CHECK(moved.getNumReached() == 5);
+    CHECK(bfs.getNumVertices() == 0);
+    copy = moved;
+    MstResult mstCopy(kruskal);
+    CHECK(mstCopy.getEdge(2).w == 3);
+}
+
+TEST_CASE("Traversal workspace answers repeated queries without clearing") {
+    // Random edges among 0..149, a path 150..199 hanging off vertex 0, vertex 200 isolated
+    const VertexId n = 201;
+    Graph g(n);
+    unsigned state = 99;
+    for(int e = 0; e < 500; e++) {
+        state = state * 1103515245u + 12345u;
+        VertexId u = static_cast<VertexId>((state >> 8) % 150);
+        state = state * 1103515245u + 12345u;
+        VertexId v = static_cast<VertexId>((state >> 8) % 150);
+        if(u != v) {
+            g.addEdge(u, v, static_cast<Weight>(1 + (state >> 20) % 50));
+        }
+    }
+    g.addEdge(0, 150, 2);
+    for(VertexId v = 150; v < 199; v++) {
+        g.addEdge(v, v + 1, 1);
+    }
+    CsrGraph csr = g.freeze();
+
+    // One workspace for every query; it starts empty and grows on the first one
+    TraversalWorkspace ws;
+    CHECK(ws.getCapacity() == 0);
+    const VertexId sources[] = { 0, 199, 200, 37, 0 };
+    for(int q = 0; q < 5; q++) {
+        VertexId s = sources[q];
+        BfsResult bfs = Algorithms::bfsResult(g, s);
+        CHECK(Algorithms::bfs(csr, s, ws) == bfs.getNumReached());
+        CHECK(ws.getSource() == s);
+        CHECK(ws.getReached()[0] == s);
+        for(VertexId v = 0; v < n; v++) {
+            CHECK(ws.isReached(v) == bfs.isReached(v));
+            CHECK(ws.getDepth(v) == bfs.getDepth(v));
+        }
+
+        SsspResult sp = Algorithms::dijkstraResult(g, s);
+        Algorithms::dijkstra(g, s, ws);
+        for(VertexId v = 0; v < n; v++) {
+            CHECK(ws.getDistance(v) == sp.getDistance(v));
+        }
+
+        CHECK(Algorithms::dfs(g, s, ws) == bfs.getNumReached());
+        for(VertexId v = 0; v < n; v++) {
+            if(v != s && ws.isReached(v)) {
+                CHECK(ws.getDepth(v) == ws.getDepth(ws.getParent(v)) + 1);
+            }
+        }
+    }
+    CHECK(ws.getCapacity() == n);
+
+    // A target stops the search early: along the path only its first vertices are touched
+    CHECK(Algorithms::bfs(g, 199, ws, 196) == 4);
+    CHECK(ws.getDepth(196) == 3);
+    CHECK_FALSE(ws.isReached(150));
+    CHECK(Algorithms::dfs(g, 199, ws, 197) == 3);
+    Algorithms::dijkstra(g, 199, ws, 150);
+    CHECK(ws.getDistance(150) == 49);
+    CHECK(ws.getParent(150) == 151);
+    CHECK_FALSE(ws.isReached(0)); // the search stopped before relaxing the edges of 150
+    CHECK(Algorithms::bfs(g, 200, ws, 0) == 1);
+    CHECK(ws.getParent(199) == NO_VERTEX);
+    CHECK_THROWS(Algorithms::bfs(g, n, ws));
+
+    // A larger graph grows the arrays; a directed graph works too
+    DirectedGraph dg(300);
+    dg.addEdge(0, 299, 5);
+    dg.addEdge(299, 1, 5);
+    CHECK(Algorithms::dijkstra(dg, 0, ws) == 3);
+    CHECK(ws.getDistance(1) == 10);
+    CHECK(ws.getCapacity() >= 300);
+
+    // Only the negative edges the search meets make it throw
+    if(std::numeric_limits<Weight>::is_signed) {
+        Graph neg(4);
+        neg.addEdge(0, 1, 1);
+        neg.addEdge(2, 3, static_cast<Weight>(-1));
+        CHECK(Algorithms::dijkstra(neg, 0, ws) == 2);
+        CHECK_THROWS(Algorithms::dijkstra(neg, 2, ws));
+    }
+
+    TraversalWorkspace moved(std::move(ws));
+    CHECK(moved.getCapacity() >= 300);
+    CHECK(ws.getCapacity() == 0);
+}
+
+// Same depths as the top-down search, and every parent is a real edge one level up
+template <typename G>
+static void checkSameLevels(const G& g, const BfsResult& expected, const BfsResult& result) {
+    CHECK(result.getNumReached() == expected.getNumReached());
+    for(VertexId v = 0; v < g.getNumVertices(); v++) {
+        CHECK(result.getDepth(v) == expected.getDepth(v));
+        VertexId p = result.getParent(v);
+        if(p == NO_VERTEX) {
+            continue;
+        }
+        CHECK(result.getDepth(p) + 1 == result.getDepth(v));
+        bool found = false;
+        for(typename G::NeighborIterator it = g.neighbors(p); !it.done(); it.next()) {
+            found = found || (it.destination() == v && it.weight() == result.getParentWeight(v));
+        }
+        CHECK(found);
+    }
+}
+
+TEST_CASE("Direction-optimizing BFS matches the top-down levels") {
+    // A dense random core (the middle levels go bottom-up) with a long path hanging off it
+    // (the tail goes back to top-down) and a few unreachable vertices
+    const VertexId n = 2110;
+    Graph g(n);
+    DirectedGraph dg(n);
+    unsigned state = 2024;
+    for(int e = 0; e < 20000; e++) {
+        state = state * 1103515245u + 12345u;
+        VertexId u = static_cast<VertexId>((state >> 8) % 2000);
+        state = state * 1103515245u + 12345u;
+        VertexId v = static_cast<VertexId>((state >> 8) % 2000);
+        if(u != v) {
+            Weight w = static_cast<Weight>(1 + (state >> 20) % 9);
+            g.addEdge(u, v, w);
+            dg.addEdge(u, v, w);
+        }
+    }
+    g.addEdge(5, 2000);
+    dg.addEdge(5, 2000);
+    for(VertexId v = 2000; v < 2099; v++) {
+        g.addEdge(v, v + 1);
+        dg.addEdge(v, v + 1);
+    }
+
+    const VertexId sources[] = { 0, 2099, 2105 };
+    for(int i = 0; i < 3; i++) {
+        BfsResult expected = Algorithms::bfsResult(g, sources[i]);
+        checkSameLevels(g, expected, Algorithms::directionOptimizingBfs(g, sources[i]));
+        checkSameLevels(g, expected, Algorithms::directionOptimizingBfs(g.freeze(), sources[i]));
+        checkSameLevels(dg, Algorithms::bfsResult(dg, sources[i]), Algorithms::directionOptimizingBfs(dg, sources[i]));
+    }
+    CHECK(Algorithms::directionOptimizingBfs(g, 0).getDepth(2099) == Algorithms::bfsResult(g, 0).getDepth(5) + 100);
+
+    // Dense enough to stay bottom-up to the end
+    Graph k(100);
+    for(VertexId u = 0; u < 100; u++) {
+        for(VertexId v = u + 1; v < 100; v++) {
+            k.addEdge(u, v);
+        }
+    }
+    checkSameLevels(k, Algorithms::bfsResult(k, 7), Algorithms::directionOptimizingBfs(DenseGraph(k), 7));
+}
+
+TEST_CASE("Parallel BFS matches the sequential levels") {
+    // A hub whose list spans many chunks, and enough random edges for several threaded levels
+    const VertexId n = 30010;
+    Graph g(n);
+    DirectedGraph dg(n);
+    for(VertexId v = 1; v < 30000; v += 2) {
+        g.addEdge(0, v, 3);
+        dg.addEdge(0, v, 3);
+    }
+    unsigned state = 77;
+    for(int e = 0; e < 90000; e++) {
+        state = state * 1103515245u + 12345u;
+        VertexId u = static_cast<VertexId>((state >> 8) % 30000);
+        state = state * 1103515245u + 12345u;
+        VertexId v = static_cast<VertexId>((state >> 8) % 30000);
+        if(u != v) {
+            Weight w = static_cast<Weight>(1 + (state >> 20) % 9);
+            g.addEdge(u, v, w);
+            dg.addEdge(u, v, w);
+        }
+    }
+
+    const VertexId sources[] = { 0, 12345, 30005 };
+    for(int i = 0; i < 3; i++) {
+        BfsResult expected = Algorithms::bfsResult(g, sources[i]);
+        checkSameLevels(g, expected, Algorithms::parallelBfs(g, sources[i], false, 4));
+        checkSameLevels(g, expected, Algorithms::parallelBfs(g, sources[i], true, 3));
+        checkSameLevels(g, expected, Algorithms::parallelBfs(SoaCsrGraph(g), sources[i], false, 4));
+        checkSameLevels(g, expected, Algorithms::parallelBfs(CompressedGraph(g), sources[i], true, 4));
+        checkSameLevels(dg, Algorithms::bfsResult(dg, sources[i]), Algorithms::parallelBfs(dg, sources[i], true, 4));
+    }
+    CHECK_THROWS(Algorithms::parallelBfs(g, n));
+
+    // Deterministic: the parent is the smallest neighbor one level up, on every run
+    CsrGraph csr = g.freeze();
+    BfsResult first = Algorithms::parallelBfs(csr, 12345, true, 4);
+    BfsResult second = Algorithms::parallelBfs(csr, 12345, true, 2);
+    for(VertexId v = 0; v < n; v++) {
+        CHECK(first.getParent(v) == second.getParent(v));
+        CHECK(first.getParentWeight(v) == second.getParentWeight(v));
+        if(first.getParent(v) == NO_VERTEX) {
+            continue;
+        }
+        VertexId smallest = n;
+        for(CsrGraph::NeighborIterator it = csr.neighbors(v); !it.done(); it.next()) {
+            if(first.getDepth(it.destination()) + 1 == first.getDepth(v) && it.destination() < smallest) {
+                smallest = it.destination();
+            }
+        }
+        CHECK(first.getParent(v) == smallest);
+    }
+}
+
+TEST_CASE("Multi-source BFS gives every source's hop distances") {
+    // 300 sources: four full batches and a partial one, with repeated sources
+    const VertexId n = 1510;
+    Graph g(n);
+    DirectedGraph dg(n);
+    unsigned state = 31337;
+    for(int e = 0; e < 3000; e++) {
+        state = state * 1103515245u + 12345u;
+        VertexId u = static_cast<VertexId>((state >> 8) % 1500);
+        state = state * 1103515245u + 12345u;
+        VertexId v = static_cast<VertexId>((state >> 8) % 1500);
+        if(u != v) {
+            g.addEdge(u, v, 2);
+            dg.addEdge(u, v, 2);
+        }
+    }
+    VertexId sources[300];
+    for(int i = 0; i < 300; i++) {
+        sources[i] = static_cast<VertexId>((i * 37) % n);
+    }
+    sources[299] = sources[3];
+
+    MultiSourceBfsResult all = Algorithms::multiSourceBfs(g, sources, 300);
+    MultiSourceBfsResult compressed = Algorithms::multiSourceBfs(CompressedGraph(g), sources, 300);
+    MultiSourceBfsResult directed = Algorithms::multiSourceBfs(dg, sources, 300);
+    CHECK(all.getNumSources() == 300);
+    for(std::size_t i = 0; i < 300; i++) {
+        BfsResult single = Algorithms::bfsResult(g, sources[i]);
+        BfsResult directedSingle = Algorithms::bfsResult(dg, sources[i]);
+        Distance sum = 0;
+        for(VertexId v = 0; v < n; v++) {
+            CHECK(all.getDepth(i, v) == single.getDepth(v));
+            CHECK(compressed.getDepth(i, v) == single.getDepth(v));
+            CHECK(directed.getDepth(i, v) == directedSingle.getDepth(v));
+            sum += single.isReached(v) ? single.getDepth(v) : 0;
+        }
+        CHECK(all.getSource(i) == sources[i]);
+        CHECK(all.getNumReached(i) == single.getNumReached());
+        CHECK(all.getDepthSum(i) == sum);
+    }
+
+    MultiSourceBfsResult copy = all;
+    MultiSourceBfsResult moved(std::move(all));
+    CHECK(moved.getDepths(299)[sources[3]] == 0);
+    CHECK(copy.getDepth(5, 1505) == NO_VERTEX);
+    CHECK(all.getNumSources() == 0);
+    CHECK(Algorithms::multiSourceBfs(g, sources, 0).getNumSources() == 0);
+    VertexId bad[] = { 0, n };
+    CHECK_THROWS(Algorithms::multiSourceBfs(g, bad, 2));
+}
+
+// A shortest path found by bidirectionalBfs: the right ends and length, over real edges
+template <typename G>
+static void checkHopPath(const G& g, const HopPathResult& path, VertexId source, VertexId target) {
+    REQUIRE(path.hasPath());
+    CHECK(path.getPathLength() == static_cast<std::size_t>(path.getDistance()) + 1);
+    CHECK(path.getPathVertex(0) == source);
+    CHECK(path.getPathVertex(path.getPathLength() - 1) == target);
+    for(std::size_t i = 0; i + 1 < path.getPathLength(); i++) {
+        bool found = false;
+        for(typename G::NeighborIterator it = g.neighbors(path.getPathVertex(i)); !it.done(); it.next()) {
+            found = found || it.destination() == path.getPathVertex(i + 1);
+        }
+        CHECK(found);
+    }
+}
+
+TEST_CASE("Bidirectional BFS answers point-to-point hop queries") {
+    const VertexId n = 3010;
+    Graph g(n);
+    DirectedGraph dg(n);
+    unsigned state = 4242;
+    for(int e = 0; e < 4500; e++) {
+        state = state * 1103515245u + 12345u;
+        VertexId u = static_cast<VertexId>((state >> 8) % 3000);
+        state = state * 1103515245u + 12345u;
+        VertexId v = static_cast<VertexId>((state >> 8) % 3000);
+        if(u != v) {
+            g.addEdge(u, v);
+            dg.addEdge(u, v);
+        }
+    }
+
+    TraversalWorkspace forward;
+    TraversalWorkspace backward;
+    CsrGraph csr = g.freeze();
+    for(VertexId s = 0; s < 3010; s += 301) {
+        BfsResult expected = Algorithms::bfsResult(g, s);
+        BfsResult expectedDirected = Algorithms::bfsResult(dg, s);
+        for(VertexId t = 0; t < n; t += 7) {
+            HopPathResult path = Algorithms::bidirectionalBfs(csr, s, t, forward, backward, true);
+            CHECK(path.getDistance() == expected.getDepth(t));
+            CHECK(path.isConnected() == expected.isReached(t));
+            if(path.isConnected()) {
+                checkHopPath(csr, path, s, t);
+            }
+            HopPathResult directed = Algorithms::bidirectionalBfs(dg, s, t, forward, backward, true);
+            CHECK(directed.getDistance() == expectedDirected.getDepth(t));
+            if(directed.isConnected()) {
+                checkHopPath(dg, directed, s, t);
+            }
+        }
+    }
+
+    // Distance only, and the plain form with its own workspaces
+    HopPathResult hops = Algorithms::bidirectionalBfs(g, 0, 1234);
+    CHECK(hops.getDistance() == Algorithms::bfsResult(g, 0).getDepth(1234));
+    CHECK_FALSE(hops.hasPath());
+    HopPathResult same = Algorithms::bidirectionalBfs(g, 9, 9, true);
+    CHECK(same.getDistance() == 0);
+    CHECK(same.getPathLength() == 1);
+    HopPathResult none = Algorithms::bidirectionalBfs(g, 0, 3005, true);
+    CHECK_FALSE(none.isConnected());
+    CHECK_FALSE(none.hasPath());
+
+    // A long path: meeting in the middle, each side explores about half of it
+    Graph line(1000);
+    for(VertexId v = 0; v + 1 < 1000; v++) {
+        line.addEdge(v, v + 1);
+    }
+    HopPathResult middle = Algorithms::bidirectionalBfs(line, 0, 999, forward, backward, true);
+    CHECK(middle.getDistance() == 999);
+    checkHopPath(line, middle, 0, 999);
+    CHECK(forward.getNumReached() + backward.getNumReached() <= 1001);
+    CHECK(forward.getNumReached() >= 499);
+
+    HopPathResult copy = middle;
+    HopPathResult moved(std::move(middle));
+    CHECK(copy.getPathVertex(500) == 500);
+    CHECK(moved.getPath()[999] == 999);
+    CHECK_FALSE(middle.isConnected());
+
+    CHECK_THROWS(Algorithms::bidirectionalBfs(g, 0, n));
+    CHECK_THROWS(Algorithms::bidirectionalBfs(g, 0, 5, forward, forward));
+}
+
 int main(int argc, char** argv) {
     doctest::Context context;
     context.applyCommandLine(argc, argv);